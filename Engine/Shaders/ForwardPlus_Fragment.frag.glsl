@@ -2,8 +2,10 @@
 
 #version 460 core
 
+// Runtime-sized texture array; the index is uniform per draw, so no nonuniformEXT is needed yet
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
     vec3 viewPos;
@@ -17,7 +19,14 @@ layout(binding = 0) uniform UniformBufferObject {
     float padding3;
 } ubo;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Bindless texture table (set 2): one sampler and every loaded texture
+layout(set = 2, binding = 0) uniform sampler textureSampler;
+layout(set = 2, binding = 1) uniform texture2D textures[];
+
+// Per-draw material, placed after the vertex stage's VertexQuantization block
+layout(push_constant) uniform MaterialConstants {
+    layout(offset = 48) uint baseColorTexture;
+} material;
 
 struct ForwardPlusLight {
     vec3 position;
@@ -72,7 +81,7 @@ vec3 calculateLight(ForwardPlusLight light, vec3 worldPos, vec3 normal, vec3 bas
 
 void main()
 {
-    vec4 texColor = texture(texSampler, fragTexCoord);
+    vec4 texColor = texture(sampler2D(textures[material.baseColorTexture], textureSampler), fragTexCoord);
     vec3 baseColor = fragColor * texColor.rgb;
     vec3 normal = normalize(fragNormal);
     
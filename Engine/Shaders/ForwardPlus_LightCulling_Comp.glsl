@@ -14,7 +14,6 @@ struct ForwardPlusLight {
 };
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
     vec3 viewPos;
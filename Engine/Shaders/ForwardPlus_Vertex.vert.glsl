@@ -1,7 +1,6 @@
 #version 460 core
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
     vec3 viewPos;
@@ -12,8 +11,23 @@ layout(binding = 0) uniform UniformBufferObject {
     float exposure;
 } ubo;
 
+// Per-object data, bound with a dynamic offset for every object
+layout(set = 1, binding = 0) uniform ObjectUniforms {
+    mat4 model;
+} object;
+
+// Per-mesh dequantization of the packed vertex layout (identity for full-precision layouts)
+layout(push_constant) uniform VertexQuantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 texCoordOffsetScale;
+} quantization;
+
+// Set when the vertex layout stores octahedral-encoded normals in the normal's xy
+layout(constant_id = 0) const bool OCTAHEDRAL_NORMALS = false;
+
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 fragColor;
@@ -21,15 +35,28 @@ layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out vec3 fragWorldPos;
 layout(location = 3) out vec3 fragNormal;
 
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
 void main()
 {
-    vec4 worldPos = ubo.model * vec4(inPosition, 1.0);
+    vec3 position = quantization.positionOffset.xyz + quantization.positionScale.xyz * inPosition;
+    vec2 texCoord = quantization.texCoordOffsetScale.xy + quantization.texCoordOffsetScale.zw * inTexCoord;
+    vec3 normal = OCTAHEDRAL_NORMALS ? decodeOctahedral(inNormal.xy) : inNormal;
+
+    vec4 worldPos = object.model * vec4(position, 1.0);
     gl_Position = ubo.proj * ubo.view * worldPos;
     
-    fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    // Vertex layouts carry no color; keep the varying so the fragment stage stays layout-agnostic
+    fragColor = vec3(1.0);
+    fragTexCoord = texCoord;
     fragWorldPos = worldPos.xyz;
     
-    // Use a fixed normal pointing towards camera for basic lighting
-    fragNormal = normalize(vec3(0.0, 0.0, 1.0));
+    // The model matrix only rotates and translates, so it transforms normals as-is
+    fragNormal = normalize(mat3(object.model) * normal);
 }
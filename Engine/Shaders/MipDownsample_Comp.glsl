@@ -0,0 +1,62 @@
+// Mip chain downsample for image formats that cannot be blitted with a linear filter.
+// One invocation per destination texel averages the source texels its footprint covers: 2 per axis when the
+// source side is even, 3 with box-filter weights when it is odd, so the edge row/column of an odd side is not
+// dropped. A source side of 1 is carried over.
+
+#version 460 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D sourceMip;
+layout(binding = 1) writeonly uniform image2D destinationMip;
+
+// Weights of source texels 2x, 2x+1 and 2x+2 along one axis of destinationSize texels
+vec3 footprintWeights(int x, int sourceSize, int destinationSize)
+{
+    if (sourceSize == 2 * destinationSize)
+    {
+        return vec3(0.5, 0.5, 0.0);
+    }
+    if (sourceSize == 2 * destinationSize + 1)
+    {
+        // Destination texel x spans source texels [x * (2n+1)/n, (x+1) * (2n+1)/n)
+        float n = float(destinationSize);
+        return vec3(n - float(x), n, float(x) + 1.0) / (2.0 * n + 1.0);
+    }
+    return vec3(1.0, 0.0, 0.0);
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 destinationSize = imageSize(destinationMip);
+    if (any(greaterThanEqual(texel, destinationSize)))
+    {
+        return;
+    }
+
+    ivec2 sourceSize = textureSize(sourceMip, 0);
+    ivec2 lastSourceTexel = sourceSize - 1;
+    ivec2 source = texel * 2;
+    vec3 weightsX = footprintWeights(texel.x, sourceSize.x, destinationSize.x);
+    vec3 weightsY = footprintWeights(texel.y, sourceSize.y, destinationSize.y);
+
+    vec4 sum = vec4(0.0);
+    for (int y = 0; y < 3; y++)
+    {
+        if (weightsY[y] == 0.0)
+        {
+            continue;
+        }
+        for (int x = 0; x < 3; x++)
+        {
+            if (weightsX[x] == 0.0)
+            {
+                continue;
+            }
+            sum += texelFetch(sourceMip, min(source + ivec2(x, y), lastSourceTexel), 0) * (weightsX[x] * weightsY[y]);
+        }
+    }
+
+    imageStore(destinationMip, texel, sum);
+}
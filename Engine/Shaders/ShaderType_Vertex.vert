@@ -1,20 +1,30 @@
 #version 450
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+// Per-object data, bound with a dynamic offset for every object
+layout(set = 1, binding = 0) uniform ObjectUniforms {
+    mat4 model;
+} object;
+
+layout(push_constant) uniform VertexQuantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 texCoordOffsetScale;
+} quantization;
+
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    vec3 position = quantization.positionOffset.xyz + quantization.positionScale.xyz * inPosition;
+    gl_Position = ubo.proj * ubo.view * object.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = quantization.texCoordOffsetScale.xy + quantization.texCoordOffsetScale.zw * inTexCoord;
 }
\ No newline at end of file
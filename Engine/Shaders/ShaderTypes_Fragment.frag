@@ -1,6 +1,13 @@
 #version 450
 
-layout(binding = 1) uniform sampler2D texSampler;
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 2, binding = 0) uniform sampler textureSampler;
+layout(set = 2, binding = 1) uniform texture2D textures[];
+
+layout(push_constant) uniform MaterialConstants {
+    layout(offset = 48) uint baseColorTexture;
+} material;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
@@ -8,5 +15,5 @@ layout(location = 1) in vec2 fragTexCoord;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(sampler2D(textures[material.baseColorTexture], textureSampler), fragTexCoord);
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "Runtime/EngineCore/JobSystem.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace
+{
+	thread_local uint32_t currentThreadIndex = 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+	}
+
+	workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+uint32_t JobSystem::getThreadIndex()
+{
+	return currentThreadIndex;
+}
+
+void JobSystem::enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	wakeCondition.notify_one();
+}
+
+void JobSystem::workerLoop(uint32_t threadIndex)
+{
+	currentThreadIndex = threadIndex;
+
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mutex);
+			wakeCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping && jobs.empty())
+			{
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (count == 1 || workers.empty())
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			fn(i);
+		}
+		return;
+	}
+
+	// Shared state lives on this stack frame; we do not return before every helper has finished with it
+	std::atomic<size_t> nextIndex{ 0 };
+	std::atomic<size_t> activeHelpers{ 0 };
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+
+	auto drain = [&]()
+	{
+		for (size_t i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1))
+		{
+			try
+			{
+				fn(i);
+			}
+			catch (...)
+			{
+				std::lock_guard lock(errorMutex);
+				if (!firstError)
+				{
+					firstError = std::current_exception();
+				}
+				// Stop handing out further indices
+				nextIndex.store(count);
+			}
+		}
+	};
+
+	size_t helperCount = std::min(count - 1, workers.size());
+	activeHelpers.store(helperCount);
+	for (size_t i = 0; i < helperCount; i++)
+	{
+		enqueue([&]()
+		{
+			drain();
+			std::lock_guard lock(doneMutex);
+			if (activeHelpers.fetch_sub(1) == 1)
+			{
+				doneCondition.notify_one();
+			}
+		});
+	}
+
+	drain();
+
+	{
+		std::unique_lock lock(doneMutex);
+		doneCondition.wait(lock, [&]() { return activeHelpers.load() == 0; });
+	}
+
+	if (firstError)
+	{
+		std::rethrow_exception(firstError);
+	}
+}
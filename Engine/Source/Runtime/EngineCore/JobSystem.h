@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// Fixed-size worker pool for CPU-side engine work (asset decoding, transcoding, command recording).
+class JobSystem
+{
+public:
+	/// workerCount == 0 picks one worker per hardware thread, minus the calling thread.
+	explicit JobSystem(uint32_t workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+	/// Index of the calling thread: 0 for any non-worker thread, 1..getWorkerCount() for workers.
+	/// Stable for the lifetime of the pool, so it can index per-thread resources.
+	static uint32_t getThreadIndex();
+
+	/// Queues fn on a worker and returns a future for its result.
+	template <typename F>
+	auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+	{
+		using Result = std::invoke_result_t<std::decay_t<F>>;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+		std::future<Result> future = task->get_future();
+		enqueue([task]() { (*task)(); });
+		return future;
+	}
+
+	/// Runs fn(i) for every i in [0, count) across the workers and the calling thread, and blocks until
+	/// all calls returned. The first exception thrown by fn is rethrown on the calling thread.
+	/// Must not be called from inside a job: the caller waits on helpers queued behind it.
+	void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+	void enqueue(std::function<void()> job);
+	void workerLoop(uint32_t threadIndex);
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	bool stopping = false;
+};
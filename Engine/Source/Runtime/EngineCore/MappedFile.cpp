@@ -0,0 +1,145 @@
+#include "Runtime/EngineCore/MappedFile.h"
+
+#include <utility>
+
+#ifdef CAE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+#ifdef CAE_PLATFORM_WINDOWS
+		fileHandle = std::exchange(other.fileHandle, nullptr);
+		mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+	}
+	return *this;
+}
+
+#ifdef CAE_PLATFORM_WINDOWS
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle)
+	{
+		CloseHandle(fileHandle);
+	}
+	data = nullptr;
+	size = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	::close(fd);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data)
+	{
+		munmap(const_cast<std::byte*>(data), size);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#endif // CAE_PLATFORM_WINDOWS
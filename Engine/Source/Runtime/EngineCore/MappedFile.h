@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Read-only memory mapping of a whole file. Pages are faulted in by the OS on first access,
+/// so opening a large file costs about as much as a stat.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/// Maps the file at path. Returns false if it does not exist or cannot be mapped.
+	bool open(const std::string& path);
+	void close();
+
+	bool isOpen() const { return data != nullptr; }
+	const std::byte* getData() const { return data; }
+	size_t getSize() const { return size; }
+
+private:
+	const std::byte* data = nullptr;
+	size_t size = 0;
+
+#ifdef CAE_PLATFORM_WINDOWS
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
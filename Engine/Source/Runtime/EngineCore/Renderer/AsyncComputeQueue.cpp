@@ -0,0 +1,221 @@
+#include "AsyncComputeQueue.h"
+
+#include <algorithm>
+
+uint32_t AsyncComputeQueue::findComputeQueueFamily(const std::vector<vk::QueueFamilyProperties>& families, uint32_t graphicsFamily)
+{
+	// Compute-only families map to the asynchronous compute engines
+	for (uint32_t index = 0; index < families.size(); index++)
+	{
+		vk::QueueFlags flags = families[index].queueFlags;
+		if (index != graphicsFamily && (flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics))
+		{
+			return index;
+		}
+	}
+
+	// A second graphics-capable family still gets its own hardware queue on some devices
+	for (uint32_t index = 0; index < families.size(); index++)
+	{
+		if (index != graphicsFamily && (families[index].queueFlags & vk::QueueFlagBits::eCompute))
+		{
+			return index;
+		}
+	}
+
+	return graphicsFamily;
+}
+
+void AsyncComputeQueue::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& physicalDevice, uint32_t inGraphicsFamily,
+	uint32_t inComputeFamily, uint32_t queueIndex, uint32_t frameSlots)
+{
+	device = &inDevice;
+	graphicsFamily = inGraphicsFamily;
+	computeFamily = inComputeFamily;
+	timelineValue = 0;
+	frameSlot = 0;
+	previousGraphicsBegin = 0;
+	previousGraphicsEnd = 0;
+	statistics = {};
+	slots = std::vector<SlotState>(frameSlots);
+	if (!isAsync())
+	{
+		return;
+	}
+
+	queue = vk::raii::Queue(*device, computeFamily, queueIndex);
+
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+	poolInfo.queueFamilyIndex = computeFamily;
+	commandPool = vk::raii::CommandPool(*device, poolInfo);
+
+	vk::CommandBufferAllocateInfo allocInfo;
+	allocInfo.commandPool = *commandPool;
+	allocInfo.level = vk::CommandBufferLevel::ePrimary;
+	allocInfo.commandBufferCount = frameSlots;
+	vk::raii::CommandBuffers allocated(*device, allocInfo);
+	commandBuffers.clear();
+	for (vk::raii::CommandBuffer& commandBuffer : allocated)
+	{
+		commandBuffers.push_back(std::move(commandBuffer));
+	}
+
+	vk::SemaphoreTypeCreateInfo timelineInfo;
+	timelineInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	timelineInfo.initialValue = 0;
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.pNext = &timelineInfo;
+	timeline = vk::raii::Semaphore(*device, semaphoreInfo);
+
+	// Durations and the overlap estimate need timestamps on both queues
+	std::vector<vk::QueueFamilyProperties> families = physicalDevice.getQueueFamilyProperties();
+	statistics.timestampsSupported = families[graphicsFamily].timestampValidBits > 0 && families[computeFamily].timestampValidBits > 0;
+	if (statistics.timestampsSupported)
+	{
+		timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+
+		vk::QueryPoolCreateInfo queryPoolInfo;
+		queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+		queryPoolInfo.queryCount = frameSlots * QUERIES_PER_SLOT;
+		queryPool = vk::raii::QueryPool(*device, queryPoolInfo);
+	}
+}
+
+void AsyncComputeQueue::destroy()
+{
+	queryPool = nullptr;
+	timeline = nullptr;
+	commandBuffers.clear();
+	commandPool = nullptr;
+	queue = nullptr;
+	slots.clear();
+	device = nullptr;
+}
+
+void AsyncComputeQueue::beginFrame(uint32_t inFrameSlot)
+{
+	frameSlot = inFrameSlot;
+	readTimestamps(frameSlot);
+	slots[frameSlot] = {};
+}
+
+const vk::raii::CommandBuffer& AsyncComputeQueue::begin()
+{
+	vk::raii::CommandBuffer& commandBuffer = commandBuffers[frameSlot];
+	commandBuffer.reset();
+	commandBuffer.begin({});
+	if (statistics.timestampsSupported)
+	{
+		writeTimestamp(commandBuffer, frameSlot * QUERIES_PER_SLOT, vk::PipelineStageFlagBits2::eTopOfPipe);
+	}
+	slots[frameSlot].computeWritten = true;
+	return commandBuffer;
+}
+
+uint64_t AsyncComputeQueue::submit()
+{
+	vk::raii::CommandBuffer& commandBuffer = commandBuffers[frameSlot];
+	if (statistics.timestampsSupported)
+	{
+		writeTimestamp(commandBuffer, frameSlot * QUERIES_PER_SLOT + 1, vk::PipelineStageFlagBits2::eBottomOfPipe);
+	}
+	commandBuffer.end();
+
+	vk::CommandBufferSubmitInfo commandBufferInfo;
+	commandBufferInfo.commandBuffer = *commandBuffer;
+
+	vk::SemaphoreSubmitInfo signalInfo;
+	signalInfo.semaphore = *timeline;
+	signalInfo.value = ++timelineValue;
+	signalInfo.stageMask = vk::PipelineStageFlagBits2::eComputeShader;
+
+	vk::SubmitInfo2 submitInfo;
+	submitInfo.commandBufferInfoCount = 1;
+	submitInfo.pCommandBufferInfos = &commandBufferInfo;
+	submitInfo.signalSemaphoreInfoCount = 1;
+	submitInfo.pSignalSemaphoreInfos = &signalInfo;
+	queue.submit2(submitInfo);
+
+	statistics.submissions++;
+	return timelineValue;
+}
+
+vk::SemaphoreSubmitInfo AsyncComputeQueue::getWaitInfo(uint64_t value, vk::PipelineStageFlags2 stageMask) const
+{
+	vk::SemaphoreSubmitInfo waitInfo;
+	waitInfo.semaphore = *timeline;
+	waitInfo.value = value;
+	waitInfo.stageMask = stageMask;
+	return waitInfo;
+}
+
+void AsyncComputeQueue::writeGraphicsBegin(const vk::raii::CommandBuffer& commandBuffer)
+{
+	if (statistics.timestampsSupported)
+	{
+		writeTimestamp(commandBuffer, frameSlot * QUERIES_PER_SLOT + 2, vk::PipelineStageFlagBits2::eTopOfPipe);
+	}
+}
+
+void AsyncComputeQueue::writeGraphicsEnd(const vk::raii::CommandBuffer& commandBuffer)
+{
+	if (statistics.timestampsSupported)
+	{
+		writeTimestamp(commandBuffer, frameSlot * QUERIES_PER_SLOT + 3, vk::PipelineStageFlagBits2::eBottomOfPipe);
+		slots[frameSlot].graphicsWritten = true;
+	}
+}
+
+void AsyncComputeQueue::writeTimestamp(const vk::raii::CommandBuffer& commandBuffer, uint32_t query, vk::PipelineStageFlags2 stage)
+{
+	// Each query is reset by the queue that writes it, right before the write
+	commandBuffer.resetQueryPool(*queryPool, query, 1);
+	commandBuffer.writeTimestamp2(stage, *queryPool, query);
+}
+
+void AsyncComputeQueue::readTimestamps(uint32_t slot)
+{
+	const SlotState& state = slots[slot];
+	if (!statistics.timestampsSupported || !state.graphicsWritten)
+	{
+		return;
+	}
+
+	auto [result, timestamps] = queryPool.getResults<uint64_t>(slot * QUERIES_PER_SLOT, QUERIES_PER_SLOT,
+		QUERIES_PER_SLOT * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+	if (result != vk::Result::eSuccess)
+	{
+		return;
+	}
+
+	uint64_t graphicsBegin = timestamps[2];
+	uint64_t graphicsEnd = timestamps[3];
+	statistics.lastGraphicsMilliseconds = (graphicsEnd > graphicsBegin ? graphicsEnd - graphicsBegin : 0) * timestampPeriod * 1e-6;
+	if (state.computeWritten)
+	{
+		uint64_t computeBegin = timestamps[0];
+		uint64_t computeEnd = timestamps[1];
+		uint64_t computeTicks = computeEnd > computeBegin ? computeEnd - computeBegin : 0;
+		statistics.lastComputeMilliseconds = computeTicks * timestampPeriod * 1e-6;
+		auto overlap = [&](uint64_t begin, uint64_t end)
+		{
+			uint64_t overlapBegin = std::max(begin, computeBegin);
+			uint64_t overlapEnd = std::min(end, computeEnd);
+			return overlapEnd > overlapBegin ? overlapEnd - overlapBegin : 0;
+		};
+
+		// The compute work starts while the previous frame's graphics work may still run and ends before this
+		// frame's consumers; the two intervals barely touch, so their overlaps simply add up. Only an estimate:
+		// nothing guarantees the two queues' timestamps share a base.
+		uint64_t overlapTicks = std::min(overlap(previousGraphicsBegin, previousGraphicsEnd) + overlap(graphicsBegin, graphicsEnd), computeTicks);
+		statistics.lastOverlapMilliseconds = overlapTicks * timestampPeriod * 1e-6;
+		if (computeTicks > 0)
+		{
+			double overlapFraction = static_cast<double>(overlapTicks) / static_cast<double>(computeTicks);
+			statistics.averageOverlap += (overlapFraction - statistics.averageOverlap) * 0.05;
+		}
+	}
+	previousGraphicsBegin = graphicsBegin;
+	previousGraphicsEnd = graphicsEnd;
+}
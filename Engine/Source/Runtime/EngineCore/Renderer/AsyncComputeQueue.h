@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// Compute work submitted on a queue family of its own, so it runs next to graphics instead of in line with it.
+/// Each submission signals the next value of a timeline semaphore, and the graphics submission of the same frame
+/// waits on that value at the stage that consumes the results. Without a separate compute family isAsync() is
+/// false and callers record the same work into their graphics command buffer instead.
+/// Timestamps around every compute submission and every graphics frame measure both queues' durations; they are
+/// read back once the frame slot comes around again. Vulkan only guarantees that timestamps of one queue are
+/// comparable, so the compute time spent alongside graphics work, found by intersecting the two queues'
+/// intervals, is an estimate that assumes both queues count from the same base.
+class AsyncComputeQueue
+{
+public:
+	struct Statistics
+	{
+		uint64_t submissions = 0;
+		bool timestampsSupported = false;
+		double lastComputeMilliseconds = 0.0;
+		double lastGraphicsMilliseconds = 0.0;
+		double lastOverlapMilliseconds = 0.0; // estimated compute time spent while the previous or same frame's graphics work ran
+		double averageOverlap = 0.0; // estimated fraction of compute time that overlapped, smoothed over frames
+	};
+
+	AsyncComputeQueue() = default;
+	~AsyncComputeQueue() = default;
+
+	AsyncComputeQueue(const AsyncComputeQueue&) = delete;
+	AsyncComputeQueue& operator=(const AsyncComputeQueue&) = delete;
+
+	/// A compute-capable family other than graphicsFamily, preferring one without graphics; graphicsFamily if none
+	static uint32_t findComputeQueueFamily(const std::vector<vk::QueueFamilyProperties>& families, uint32_t graphicsFamily);
+
+	/// computeFamily == graphicsFamily disables the async path. queueIndex selects the queue within computeFamily.
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, uint32_t graphicsFamily, uint32_t computeFamily,
+		uint32_t queueIndex, uint32_t frameSlots);
+	void destroy();
+
+	bool isAsync() const { return computeFamily != graphicsFamily; }
+	uint32_t getQueueFamily() const { return computeFamily; }
+
+	/// Render thread, before recording frameSlot's frame: the frame that last used the slot has completed.
+	/// Reads back the timestamps it wrote.
+	void beginFrame(uint32_t frameSlot);
+	/// The slot's compute command buffer, reset and begun. Only valid when isAsync().
+	const vk::raii::CommandBuffer& begin();
+	/// Ends and submits the buffer from begin(); returns the timeline value graphics waits on
+	uint64_t submit();
+	vk::SemaphoreSubmitInfo getWaitInfo(uint64_t value, vk::PipelineStageFlags2 stageMask) const;
+
+	/// Brackets the graphics work of the frame that the compute work is measured against
+	void writeGraphicsBegin(const vk::raii::CommandBuffer& commandBuffer);
+	void writeGraphicsEnd(const vk::raii::CommandBuffer& commandBuffer);
+
+	const Statistics& getStatistics() const { return statistics; }
+
+private:
+	// Timestamps of one frame slot: compute begin/end, then graphics begin/end
+	static constexpr uint32_t QUERIES_PER_SLOT = 4;
+
+	struct SlotState
+	{
+		bool computeWritten = false;
+		bool graphicsWritten = false;
+	};
+
+	void readTimestamps(uint32_t slot);
+	void writeTimestamp(const vk::raii::CommandBuffer& commandBuffer, uint32_t query, vk::PipelineStageFlags2 stage);
+
+	vk::raii::Device* device = nullptr;
+	uint32_t graphicsFamily = 0;
+	uint32_t computeFamily = 0;
+	vk::raii::Queue queue{ nullptr };
+	vk::raii::CommandPool commandPool{ nullptr };
+	std::vector<vk::raii::CommandBuffer> commandBuffers;
+	vk::raii::Semaphore timeline{ nullptr };
+	uint64_t timelineValue = 0;
+
+	vk::raii::QueryPool queryPool{ nullptr };
+	double timestampPeriod = 0.0; // nanoseconds per tick
+	std::vector<SlotState> slots;
+	uint32_t frameSlot = 0;
+	// Graphics interval of the last frame read back, in ticks; compute work overlaps it as well as its own frame's
+	uint64_t previousGraphicsBegin = 0;
+	uint64_t previousGraphicsEnd = 0;
+
+	Statistics statistics;
+};
@@ -0,0 +1,149 @@
+#include "BindlessTextureTable.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+bool BindlessTextureTable::isSupported(const vk::PhysicalDeviceVulkan12Features& features)
+{
+	return features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound &&
+		features.descriptorBindingSampledImageUpdateAfterBind && features.descriptorBindingUpdateUnusedWhilePending;
+}
+
+void BindlessTextureTable::enableFeatures(vk::PhysicalDeviceVulkan12Features& features)
+{
+	features.runtimeDescriptorArray = true;
+	features.descriptorBindingPartiallyBound = true;
+	features.descriptorBindingSampledImageUpdateAfterBind = true;
+	// New slots are written while earlier frames that bound the set are still executing
+	features.descriptorBindingUpdateUnusedWhilePending = true;
+	// Every draw indexes the table uniformly, so shaderSampledImageArrayNonUniformIndexing is not needed until a
+	// shader picks textures per instance with nonuniformEXT
+}
+
+void BindlessTextureTable::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& physicalDevice, uint32_t inFramesInFlight, uint32_t maxTextures)
+{
+	device = &inDevice;
+	framesInFlight = inFramesInFlight;
+
+	auto properties = physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+	const vk::PhysicalDeviceVulkan12Properties& limits = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+	capacity = std::min({ maxTextures, limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages });
+	if (capacity == 0)
+	{
+		throw std::runtime_error("device cannot hold any update-after-bind sampled images!");
+	}
+
+	std::array bindings = {
+		vk::DescriptorSetLayoutBinding(SAMPLER_BINDING, vk::DescriptorType::eSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr),
+		vk::DescriptorSetLayoutBinding(TEXTURE_BINDING, vk::DescriptorType::eSampledImage, capacity, vk::ShaderStageFlagBits::eFragment, nullptr)
+	};
+	std::array<vk::DescriptorBindingFlags, 2> bindingFlags = {
+		vk::DescriptorBindingFlags{},
+		vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending
+	};
+
+	vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo;
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+	vk::DescriptorSetLayoutCreateInfo layoutInfo;
+	layoutInfo.pNext = &bindingFlagsInfo;
+	layoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	layout = vk::raii::DescriptorSetLayout(*device, layoutInfo);
+
+	std::array poolSizes = {
+		vk::DescriptorPoolSize(vk::DescriptorType::eSampler, 1),
+		vk::DescriptorPoolSize(vk::DescriptorType::eSampledImage, capacity)
+	};
+	vk::DescriptorPoolCreateInfo poolInfo;
+	poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	pool = vk::raii::DescriptorPool(*device, poolInfo);
+
+	vk::DescriptorSetAllocateInfo allocInfo;
+	allocInfo.descriptorPool = *pool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &*layout;
+	descriptorSet = std::move(device->allocateDescriptorSets(allocInfo).front());
+
+	frameNumber = 0;
+	nextUnused = 0;
+	freeSlots.clear();
+	released.clear();
+	statistics = {};
+	statistics.capacity = capacity;
+}
+
+void BindlessTextureTable::destroy()
+{
+	released.clear();
+	freeSlots.clear();
+	descriptorSet = nullptr;
+	pool = nullptr;
+	layout = nullptr;
+	device = nullptr;
+}
+
+void BindlessTextureTable::setSampler(vk::Sampler sampler)
+{
+	vk::DescriptorImageInfo samplerInfo;
+	samplerInfo.sampler = sampler;
+	device->updateDescriptorSets(vk::WriteDescriptorSet{ *descriptorSet, SAMPLER_BINDING, 0, 1, vk::DescriptorType::eSampler, &samplerInfo, nullptr, nullptr }, {});
+	statistics.descriptorWrites++;
+}
+
+void BindlessTextureTable::beginFrame()
+{
+	frameNumber++;
+	while (!released.empty() && released.front().releaseFrame <= frameNumber)
+	{
+		freeSlots.push_back(released.front().index);
+		released.pop_front();
+	}
+}
+
+BindlessTextureTable::Index BindlessTextureTable::add(vk::ImageView view)
+{
+	Index index;
+	if (!freeSlots.empty())
+	{
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else if (nextUnused < capacity)
+	{
+		index = nextUnused++;
+	}
+	else
+	{
+		throw std::runtime_error("bindless texture table is full!");
+	}
+
+	vk::DescriptorImageInfo imageInfo;
+	imageInfo.imageView = view;
+	imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	device->updateDescriptorSets(vk::WriteDescriptorSet{ *descriptorSet, TEXTURE_BINDING, index, 1, vk::DescriptorType::eSampledImage, &imageInfo, nullptr, nullptr }, {});
+
+	statistics.descriptorWrites++;
+	statistics.liveSlots++;
+	statistics.peakLiveSlots = std::max(statistics.peakLiveSlots, statistics.liveSlots);
+	return index;
+}
+
+void BindlessTextureTable::release(Index index)
+{
+	released.push_back({ frameNumber + framesInFlight, index });
+	statistics.liveSlots--;
+}
+
+BindlessTextureTable::Statistics BindlessTextureTable::getStatistics() const
+{
+	Statistics result = statistics;
+	result.pendingSlots = static_cast<uint32_t>(released.size());
+	return result;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/// One descriptor set holding every loaded texture, bound once per pass instead of once per material.
+/// Binding 0 is the shared sampler, binding 1 a partially bound, update-after-bind array of sampled images
+/// that shaders index with a per-draw texture index. A slot is written once when a texture view is added and
+/// never rewritten while frames may still read it: a texture whose view changes takes a new slot, and the old
+/// one is recycled framesInFlight frames after release(). Slots outside the live set are never read, so the
+/// array does not need to be filled.
+class BindlessTextureTable
+{
+public:
+	using Index = uint32_t;
+
+	static constexpr uint32_t SAMPLER_BINDING = 0;
+	static constexpr uint32_t TEXTURE_BINDING = 1;
+
+	struct Statistics
+	{
+		uint32_t capacity = 0;
+		uint32_t liveSlots = 0;
+		uint32_t peakLiveSlots = 0;
+		uint32_t pendingSlots = 0; // released, waiting for the frames that may read them
+		uint64_t descriptorWrites = 0;
+	};
+
+	BindlessTextureTable() = default;
+	~BindlessTextureTable() = default;
+
+	BindlessTextureTable(const BindlessTextureTable&) = delete;
+	BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+	/// True when the device has the descriptor indexing features the table is created with
+	static bool isSupported(const vk::PhysicalDeviceVulkan12Features& features);
+	/// Turns on the features isSupported checks
+	static void enableFeatures(vk::PhysicalDeviceVulkan12Features& features);
+
+	/// maxTextures is clamped to the device's update-after-bind sampled image limits
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, uint32_t framesInFlight, uint32_t maxTextures);
+	void destroy();
+
+	/// Written once, before the first pass that binds the table
+	void setSampler(vk::Sampler sampler);
+
+	/// Render thread, once per frame after the frame slot's previous frame completed: recycles released slots
+	void beginFrame();
+	/// Writes view into a free slot and returns its index; throws when the table is full
+	Index add(vk::ImageView view);
+	/// The slot is reused once the frames recorded until now have retired
+	void release(Index index);
+
+	const vk::raii::DescriptorSetLayout& getLayout() const { return layout; }
+	vk::DescriptorSet getDescriptorSet() const { return *descriptorSet; }
+	Statistics getStatistics() const;
+
+private:
+	struct ReleasedSlot
+	{
+		uint64_t releaseFrame = 0;
+		Index index = 0;
+	};
+
+	vk::raii::Device* device = nullptr;
+	vk::raii::DescriptorPool pool{ nullptr };
+	vk::raii::DescriptorSetLayout layout{ nullptr };
+	vk::raii::DescriptorSet descriptorSet{ nullptr };
+
+	uint32_t capacity = 0;
+	uint32_t framesInFlight = 0;
+	uint64_t frameNumber = 0;
+	Index nextUnused = 0;
+	std::vector<Index> freeSlots;
+	std::deque<ReleasedSlot> released;
+	Statistics statistics;
+};
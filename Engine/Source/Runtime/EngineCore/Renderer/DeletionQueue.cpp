@@ -0,0 +1,55 @@
+#include "DeletionQueue.h"
+
+#include <algorithm>
+
+void DeletionQueue::call(uint64_t frame, std::function<void()> callback)
+{
+	entries.push_back({ frame, nullptr, std::move(callback) });
+	statistics.pushed++;
+}
+
+void DeletionQueue::collect(uint64_t completedFrame)
+{
+	// Swapchain entries wait longer than the ones pushed after them, so the whole queue is scanned. It only holds
+	// anything for a few frames after a resize.
+	auto retired = [completedFrame](const Entry& entry) { return entry.frame <= completedFrame; };
+	for (Entry& entry : entries)
+	{
+		if (retired(entry))
+		{
+			retire(entry);
+		}
+	}
+	std::erase_if(entries, retired);
+}
+
+void DeletionQueue::flush()
+{
+	for (Entry& entry : entries)
+	{
+		retire(entry);
+	}
+	entries.clear();
+}
+
+DeletionQueue::Statistics DeletionQueue::getStatistics() const
+{
+	Statistics result = statistics;
+	result.pending = static_cast<uint32_t>(entries.size());
+	for (const Entry& entry : entries)
+	{
+		result.latestPendingFrame = std::max(result.latestPendingFrame, entry.frame);
+	}
+	return result;
+}
+
+void DeletionQueue::retire(Entry& entry)
+{
+	entry.resource.reset();
+	if (entry.callback)
+	{
+		entry.callback();
+		entry.callback = nullptr;
+	}
+	statistics.retired++;
+}
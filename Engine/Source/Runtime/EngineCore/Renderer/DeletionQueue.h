@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Resources replaced while earlier frames may still use them. Each entry is keyed by the last frame (timeline
+/// value) that can reference it and is destroyed by collect() once that frame completed, so replacing a
+/// resource never waits for the GPU. Entries that retire together do so in the order they were pushed; push a
+/// view before the image and the image before its memory. Render thread only.
+class DeletionQueue
+{
+public:
+	struct Statistics
+	{
+		uint32_t pending = 0;
+		uint64_t pushed = 0;
+		uint64_t retired = 0;
+		uint64_t latestPendingFrame = 0; // frame the last pending entry waits for; 0 when nothing is pending
+	};
+
+	DeletionQueue() = default;
+	~DeletionQueue() = default;
+
+	DeletionQueue(const DeletionQueue&) = delete;
+	DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+	/// Takes ownership of resource and destroys it once frame completed
+	template <typename T>
+	void push(uint64_t frame, T&& resource)
+	{
+		static_assert(!std::is_lvalue_reference_v<T>, "resources are moved into the deletion queue");
+		entries.push_back({ frame, std::make_shared<std::decay_t<T>>(std::move(resource)), nullptr });
+		statistics.pushed++;
+	}
+	/// Runs callback once frame completed, e.g. to hand a descriptor set back to its owner. The callback must not
+	/// push to the queue.
+	void call(uint64_t frame, std::function<void()> callback);
+
+	/// Destroys every entry whose frame is at most completedFrame
+	void collect(uint64_t completedFrame);
+	/// Destroys everything; the GPU must be idle
+	void flush();
+
+	bool empty() const { return entries.empty(); }
+	Statistics getStatistics() const;
+
+private:
+	struct Entry
+	{
+		uint64_t frame = 0;
+		std::shared_ptr<void> resource; // type-erased: the shared_ptr's deleter knows the real type
+		std::function<void()> callback;
+	};
+
+	void retire(Entry& entry);
+
+	std::vector<Entry> entries;
+	Statistics statistics;
+};
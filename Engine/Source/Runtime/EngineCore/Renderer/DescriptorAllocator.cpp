@@ -0,0 +1,126 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void DescriptorAllocator::init(vk::raii::Device& inDevice, uint32_t initialSets, std::span<const PoolRatio> inRatios)
+{
+	device = &inDevice;
+	ratios.assign(inRatios.begin(), inRatios.end());
+	setsPerPool = std::clamp<uint32_t>(initialSets, 1, MAX_SETS_PER_POOL);
+
+	readyPools.clear();
+	fullPools.clear();
+	layoutIndices.clear();
+	layoutUsage.clear();
+	sets = 0;
+	poolsCreated = 0;
+	resets = 0;
+
+	readyPools.push_back(createPool(setsPerPool));
+}
+
+void DescriptorAllocator::destroy()
+{
+	// Sets are released with their pools
+	readyPools.clear();
+	fullPools.clear();
+	device = nullptr;
+}
+
+vk::raii::DescriptorPool DescriptorAllocator::createPool(uint32_t setCount)
+{
+	std::vector<vk::DescriptorPoolSize> poolSizes;
+	poolSizes.reserve(ratios.size());
+	for (const PoolRatio& ratio : ratios)
+	{
+		poolSizes.emplace_back(ratio.type, std::max(1u, static_cast<uint32_t>(ratio.descriptorsPerSet * setCount)));
+	}
+
+	// No eFreeDescriptorSet: sets only go back through reset()
+	vk::DescriptorPoolCreateInfo poolInfo;
+	poolInfo.maxSets = setCount;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolsCreated++;
+	return vk::raii::DescriptorPool(*device, poolInfo);
+}
+
+vk::DescriptorSet DescriptorAllocator::allocate(vk::DescriptorSetLayout layout, const char* name)
+{
+	vk::DescriptorSetAllocateInfo allocInfo;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+
+	// Called through the dispatcher so an exhausted pool is a result to act on rather than an exception
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		allocInfo.descriptorPool = *readyPools.back();
+		VkResult result = device->getDispatcher()->vkAllocateDescriptorSets(static_cast<VkDevice>(**device),
+			reinterpret_cast<const VkDescriptorSetAllocateInfo*>(&allocInfo), &set);
+		if (result == VK_SUCCESS)
+		{
+			break;
+		}
+		if ((result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) || attempt == 1)
+		{
+			throw std::runtime_error("failed to allocate descriptor set!");
+		}
+
+		// Park the exhausted pool and continue in a larger one
+		fullPools.push_back(std::move(readyPools.back()));
+		readyPools.pop_back();
+		if (readyPools.empty())
+		{
+			setsPerPool = std::min(setsPerPool + setsPerPool / 2 + 1, MAX_SETS_PER_POOL);
+			readyPools.push_back(createPool(setsPerPool));
+		}
+	}
+
+	auto [iterator, inserted] = layoutIndices.try_emplace(static_cast<VkDescriptorSetLayout>(layout), layoutUsage.size());
+	if (inserted)
+	{
+		layoutUsage.push_back({ name });
+	}
+	LayoutUsage& usage = layoutUsage[iterator->second];
+	usage.sets++;
+	usage.peakSets = std::max(usage.peakSets, usage.sets);
+	usage.totalSets++;
+	sets++;
+	return set;
+}
+
+void DescriptorAllocator::reset()
+{
+	for (vk::raii::DescriptorPool& pool : fullPools)
+	{
+		pool.reset();
+		readyPools.push_back(std::move(pool));
+	}
+	fullPools.clear();
+	for (vk::raii::DescriptorPool& pool : readyPools)
+	{
+		pool.reset();
+	}
+
+	for (LayoutUsage& usage : layoutUsage)
+	{
+		usage.sets = 0;
+	}
+	sets = 0;
+	resets++;
+}
+
+DescriptorAllocator::Statistics DescriptorAllocator::getStatistics() const
+{
+	Statistics statistics;
+	statistics.poolCount = static_cast<uint32_t>(readyPools.size() + fullPools.size());
+	statistics.fullPoolCount = static_cast<uint32_t>(fullPools.size());
+	statistics.setsPerNextPool = std::min(setsPerPool + setsPerPool / 2 + 1, MAX_SETS_PER_POOL);
+	statistics.sets = sets;
+	statistics.poolsCreated = poolsCreated;
+	statistics.resets = resets;
+	statistics.layouts = layoutUsage;
+	return statistics;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Hands out descriptor sets from a chain of pools that grows on demand instead of one pool sized up front.
+/// When the current pool runs out, it is parked as full and a larger one is created, so allocation only fails
+/// on device memory exhaustion. Sets are never freed one by one: reset() returns every pool at once, which is
+/// how per-frame allocators recycle their sets after the frame that used them completed. Long-lived sets come
+/// from an allocator that is never reset.
+class DescriptorAllocator
+{
+public:
+	/// Descriptors of a type each pool reserves per set it can hold
+	struct PoolRatio
+	{
+		vk::DescriptorType type;
+		float descriptorsPerSet = 1.0f;
+	};
+
+	struct LayoutUsage
+	{
+		std::string name;
+		uint32_t sets = 0; // allocated since the last reset
+		uint32_t peakSets = 0;
+		uint64_t totalSets = 0;
+	};
+
+	struct Statistics
+	{
+		uint32_t poolCount = 0;
+		uint32_t fullPoolCount = 0;
+		uint32_t setsPerNextPool = 0;
+		uint32_t sets = 0; // allocated since the last reset
+		uint64_t poolsCreated = 0;
+		uint64_t resets = 0;
+		std::vector<LayoutUsage> layouts; // in order of first allocation
+	};
+
+	DescriptorAllocator() = default;
+	~DescriptorAllocator() = default;
+
+	DescriptorAllocator(const DescriptorAllocator&) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+	DescriptorAllocator(DescriptorAllocator&&) = default;
+	DescriptorAllocator& operator=(DescriptorAllocator&&) = default;
+
+	/// The first pool holds initialSets; each new pool is half again as large, up to MAX_SETS_PER_POOL
+	void init(vk::raii::Device& device, uint32_t initialSets, std::span<const PoolRatio> ratios);
+	void destroy();
+
+	/// A set of layout, valid until the next reset(). name labels the layout in the statistics.
+	vk::DescriptorSet allocate(vk::DescriptorSetLayout layout, const char* name);
+	/// Returns every set at once; the GPU must be done with all of them
+	void reset();
+
+	Statistics getStatistics() const;
+
+	static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+private:
+	vk::raii::DescriptorPool createPool(uint32_t setCount);
+
+	vk::raii::Device* device = nullptr;
+	std::vector<PoolRatio> ratios;
+	std::vector<vk::raii::DescriptorPool> readyPools; // the back one is allocated from
+	std::vector<vk::raii::DescriptorPool> fullPools;
+	uint32_t setsPerPool = 0;
+
+	std::unordered_map<VkDescriptorSetLayout, size_t> layoutIndices;
+	std::vector<LayoutUsage> layoutUsage;
+	uint32_t sets = 0;
+	uint64_t poolsCreated = 0;
+	uint64_t resets = 0;
+};
@@ -0,0 +1,134 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& physicalDevice, uint32_t queueFamily,
+	uint32_t frameSlots, const Settings& inSettings)
+{
+	device = &inDevice;
+	frameSlot = 0;
+	statistics = {};
+	slotWritten = std::vector<bool>(frameSlots, false);
+	setSettings(inSettings);
+	targetScale = settings.maxScale;
+	scale = settings.maxScale;
+	statistics.scale = scale;
+
+	uint32_t validBits = physicalDevice.getQueueFamilyProperties()[queueFamily].timestampValidBits;
+	statistics.timestampsSupported = validBits > 0;
+	if (!statistics.timestampsSupported)
+	{
+		return;
+	}
+
+	timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+	timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	vk::QueryPoolCreateInfo queryPoolInfo;
+	queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+	queryPoolInfo.queryCount = frameSlots * QUERIES_PER_SLOT;
+	queryPool = vk::raii::QueryPool(*device, queryPoolInfo);
+}
+
+void DynamicResolution::destroy()
+{
+	queryPool = nullptr;
+	slotWritten.clear();
+	device = nullptr;
+}
+
+void DynamicResolution::setSettings(const Settings& inSettings)
+{
+	settings = inSettings;
+	settings.maxScale = std::clamp(settings.maxScale, SCALE_STEP, 1.0f);
+	settings.minScale = std::clamp(settings.minScale, SCALE_STEP, settings.maxScale);
+	settings.targetMilliseconds = std::max(settings.targetMilliseconds, 0.1f);
+	targetScale = std::clamp(targetScale, settings.minScale, settings.maxScale);
+}
+
+void DynamicResolution::beginFrame(uint32_t inFrameSlot)
+{
+	frameSlot = inFrameSlot;
+	readTimestamps(frameSlot);
+	slotWritten[frameSlot] = false;
+	updateScale();
+}
+
+void DynamicResolution::writeSceneBegin(const vk::raii::CommandBuffer& commandBuffer)
+{
+	if (statistics.timestampsSupported)
+	{
+		uint32_t query = frameSlot * QUERIES_PER_SLOT;
+		commandBuffer.resetQueryPool(*queryPool, query, QUERIES_PER_SLOT);
+		commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, *queryPool, query);
+	}
+}
+
+void DynamicResolution::writeSceneEnd(const vk::raii::CommandBuffer& commandBuffer)
+{
+	if (statistics.timestampsSupported)
+	{
+		commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, *queryPool, frameSlot * QUERIES_PER_SLOT + 1);
+		slotWritten[frameSlot] = true;
+	}
+}
+
+vk::Extent2D DynamicResolution::getRenderExtent(vk::Extent2D maxExtent) const
+{
+	auto scaled = [this](uint32_t size)
+	{
+		return std::clamp(static_cast<uint32_t>(std::lround(static_cast<double>(size) * scale)), 1u, std::max(size, 1u));
+	};
+	return vk::Extent2D{ scaled(maxExtent.width), scaled(maxExtent.height) };
+}
+
+void DynamicResolution::readTimestamps(uint32_t slot)
+{
+	if (!statistics.timestampsSupported || !slotWritten[slot])
+	{
+		return;
+	}
+
+	auto [result, timestamps] = queryPool.getResults<uint64_t>(slot * QUERIES_PER_SLOT, QUERIES_PER_SLOT,
+		QUERIES_PER_SLOT * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+	if (result != vk::Result::eSuccess)
+	{
+		return;
+	}
+
+	uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+	statistics.lastSceneMilliseconds = ticks * timestampPeriod * 1e-6;
+	if (statistics.averageSceneMilliseconds == 0.0)
+	{
+		statistics.averageSceneMilliseconds = statistics.lastSceneMilliseconds;
+	}
+	// Light smoothing: one slow frame should not halve the resolution, a sustained rise should react within a few
+	statistics.averageSceneMilliseconds += (statistics.lastSceneMilliseconds - statistics.averageSceneMilliseconds) * 0.25;
+}
+
+void DynamicResolution::updateScale()
+{
+	float previousScale = scale;
+	if (!settings.enabled || !statistics.timestampsSupported)
+	{
+		targetScale = settings.maxScale;
+	}
+	else if (statistics.averageSceneMilliseconds > 0.0)
+	{
+		double ratio = settings.targetMilliseconds / statistics.averageSceneMilliseconds;
+		if (std::abs(ratio - 1.0) > DEAD_BAND)
+		{
+			float estimate = targetScale * static_cast<float>(std::sqrt(ratio));
+			float rate = estimate < targetScale ? settings.decreaseRate : settings.increaseRate;
+			targetScale = std::clamp(targetScale + (estimate - targetScale) * rate, settings.minScale, settings.maxScale);
+		}
+	}
+
+	scale = std::clamp(std::round(targetScale / SCALE_STEP) * SCALE_STEP, settings.minScale, settings.maxScale);
+	statistics.scale = scale;
+	if (scale != previousScale)
+	{
+		statistics.scaleChanges++;
+	}
+}
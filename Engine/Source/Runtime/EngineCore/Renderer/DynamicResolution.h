@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// Picks the scene's internal resolution from measured GPU time. Timestamps bracket the scene pass, the work the
+/// resolution actually scales, and are read back once the frame slot comes around again; a controller then moves
+/// the resolution scale so the pass time approaches the target. Waits for the swapchain and unscaled passes such as
+/// ImGui stay out of the measurement, so presentation pacing (FIFO) cannot drive the scale down.
+/// GPU time grows with the pixel count, the square of the scale, so the
+/// controller steps toward scale * sqrt(target / measured): quickly when over budget, slowly when under it.
+/// Render targets stay allocated at full size and the scene renders into the top-left getRenderExtent() of them,
+/// so a scale change never reallocates; whoever composites the target scales that region up.
+/// Without timestamp support the scale stays at Settings::maxScale.
+class DynamicResolution
+{
+public:
+	struct Settings
+	{
+		bool enabled = true;
+		// GPU time of the scene pass. The rest of the frame (UI, presentation) needs room in the frame interval too,
+		// so this leaves a 60 Hz frame a few milliseconds for it.
+		float targetMilliseconds = 12.0f;
+		float minScale = 0.5f;
+		float maxScale = 1.0f; // also the fixed scale while disabled
+		float decreaseRate = 0.5f; // fraction of the way to the estimated scale taken per frame when over budget
+		float increaseRate = 0.05f; // the same when under budget, kept low so the scale does not oscillate
+	};
+
+	struct Statistics
+	{
+		bool timestampsSupported = false;
+		double lastSceneMilliseconds = 0.0;
+		double averageSceneMilliseconds = 0.0; // smoothed over frames; what the controller acts on
+		float scale = 1.0f;
+		uint64_t scaleChanges = 0; // frames whose scale differed from the previous one
+	};
+
+	DynamicResolution() = default;
+	~DynamicResolution() = default;
+
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+	/// queueFamily is the family the scene pass is submitted to
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, uint32_t queueFamily, uint32_t frameSlots,
+		const Settings& settings);
+	void destroy();
+
+	/// Render thread, before anything of frameSlot's frame depends on the scale: the frame that last used the
+	/// slot has completed. Reads back its scene pass time and updates the scale.
+	void beginFrame(uint32_t frameSlot);
+
+	/// Bracket the scene pass of the frame being recorded, after the barriers in front of it
+	void writeSceneBegin(const vk::raii::CommandBuffer& commandBuffer);
+	void writeSceneEnd(const vk::raii::CommandBuffer& commandBuffer);
+
+	/// Region of a maxExtent target the scene renders into this frame; at least one pixel each way
+	vk::Extent2D getRenderExtent(vk::Extent2D maxExtent) const;
+	float getScale() const { return scale; }
+
+	const Settings& getSettings() const { return settings; }
+	void setSettings(const Settings& settings);
+	const Statistics& getStatistics() const { return statistics; }
+
+private:
+	// Scale steps the render extent follows; smaller changes would resize every frame for no measurable gain
+	static constexpr float SCALE_STEP = 1.0f / 32.0f;
+	// Pass time changes within this fraction of the target are noise and leave the scale alone
+	static constexpr double DEAD_BAND = 0.05;
+	static constexpr uint32_t QUERIES_PER_SLOT = 2;
+
+	void readTimestamps(uint32_t slot);
+	void updateScale();
+
+	vk::raii::Device* device = nullptr;
+	vk::raii::QueryPool queryPool{ nullptr };
+	double timestampPeriod = 0.0; // nanoseconds per tick
+	uint64_t timestampMask = ~0ull;
+	std::vector<bool> slotWritten;
+	uint32_t frameSlot = 0;
+
+	Settings settings;
+	float targetScale = 1.0f; // continuous controller output
+	float scale = 1.0f; // targetScale rounded to SCALE_STEP
+	Statistics statistics;
+};
@@ -0,0 +1,98 @@
+#include "FrameTimeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+void FrameTimeline::init(vk::raii::Device& inDevice)
+{
+	device = &inDevice;
+
+	vk::SemaphoreTypeCreateInfo timelineInfo;
+	timelineInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	timelineInfo.initialValue = 0;
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.pNext = &timelineInfo;
+	semaphore = vk::raii::Semaphore(*device, semaphoreInfo);
+
+	submittedFrame = 0;
+	cpuWaits = 0;
+	lastWaitMilliseconds = 0.0;
+	completedFrame = 0;
+}
+
+void FrameTimeline::destroy()
+{
+	semaphore = nullptr;
+	device = nullptr;
+}
+
+uint64_t FrameTimeline::waitForFrame(uint32_t framesInFlight)
+{
+	uint64_t frame = getRecordingFrame();
+	uint32_t inFlight = std::clamp<uint32_t>(framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
+	if (frame > inFlight && !isComplete(frame - inFlight))
+	{
+		auto start = std::chrono::steady_clock::now();
+		wait(frame - inFlight);
+		lastWaitMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		cpuWaits++;
+	}
+	else
+	{
+		lastWaitMilliseconds = 0.0;
+	}
+	return frame;
+}
+
+vk::SemaphoreSubmitInfo FrameTimeline::signalSubmit(vk::PipelineStageFlags2 stageMask)
+{
+	submittedFrame++;
+
+	vk::SemaphoreSubmitInfo signalInfo;
+	signalInfo.semaphore = *semaphore;
+	signalInfo.value = submittedFrame;
+	signalInfo.stageMask = stageMask;
+	return signalInfo;
+}
+
+bool FrameTimeline::isComplete(uint64_t frame) const
+{
+	return frame <= completedFrame || frame <= getCompletedFrame();
+}
+
+void FrameTimeline::wait(uint64_t frame) const
+{
+	if (frame <= completedFrame)
+	{
+		return;
+	}
+
+	vk::SemaphoreWaitInfo waitInfo;
+	vk::Semaphore timeline = *semaphore;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &timeline;
+	waitInfo.pValues = &frame;
+	(void)device->waitSemaphores(waitInfo, UINT64_MAX);
+	getCompletedFrame();
+}
+
+uint64_t FrameTimeline::getCompletedFrame() const
+{
+	uint64_t value = semaphore.getCounterValue();
+	// Several threads may refresh the cache at once; it only ever moves forward
+	uint64_t cached = completedFrame;
+	while (cached < value && !completedFrame.compare_exchange_weak(cached, value))
+	{
+	}
+	return std::max(cached, value);
+}
+
+FrameTimeline::Statistics FrameTimeline::getStatistics() const
+{
+	Statistics statistics;
+	statistics.submittedFrame = submittedFrame;
+	statistics.completedFrame = getCompletedFrame();
+	statistics.cpuWaits = cpuWaits;
+	statistics.lastWaitMilliseconds = lastWaitMilliseconds;
+	return statistics;
+}
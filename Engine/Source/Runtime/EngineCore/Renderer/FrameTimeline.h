@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+/// Frame pacing on one timeline semaphore. Frames are numbered from 1 and the graphics submission of frame N
+/// signals value N, so "frame N completed" is a counter comparison any subsystem can make without fences.
+/// Before recording, the render thread waits until at most framesInFlight - 1 earlier frames are still on the
+/// GPU; framesInFlight can change between frames. Per-frame resources are indexed by getFrameSlot(), which cycles
+/// through MAX_FRAMES_IN_FLIGHT slots whatever the current setting, so a slot is never reused before the frame
+/// that last used it completed.
+class FrameTimeline
+{
+public:
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+	struct Statistics
+	{
+		uint64_t submittedFrame = 0;
+		uint64_t completedFrame = 0;
+		uint64_t cpuWaits = 0; // frames whose recording had to wait for the GPU
+		double lastWaitMilliseconds = 0.0;
+	};
+
+	FrameTimeline() = default;
+	~FrameTimeline() = default;
+
+	FrameTimeline(const FrameTimeline&) = delete;
+	FrameTimeline& operator=(const FrameTimeline&) = delete;
+
+	void init(vk::raii::Device& device);
+	void destroy();
+
+	/// Render thread, before recording: blocks until the frame framesInFlight before the next one completed and
+	/// returns the number of the frame about to be recorded. Nothing is consumed until signalSubmit().
+	uint64_t waitForFrame(uint32_t framesInFlight);
+	/// Render thread: signal info for the submission of the frame being recorded, which then counts as submitted
+	vk::SemaphoreSubmitInfo signalSubmit(vk::PipelineStageFlags2 stageMask);
+
+	/// Number of the frame being recorded (or the next one, between frames)
+	uint64_t getRecordingFrame() const { return submittedFrame + 1; }
+	uint64_t getSubmittedFrame() const { return submittedFrame; }
+	/// Per-frame resource slot of the frame being recorded
+	uint32_t getFrameSlot() const { return static_cast<uint32_t>(getRecordingFrame() % MAX_FRAMES_IN_FLIGHT); }
+
+	/// Any thread. Only queries the semaphore when the cached value is not recent enough.
+	bool isComplete(uint64_t frame) const;
+	/// Any thread; blocks until the frame completed
+	void wait(uint64_t frame) const;
+	uint64_t getCompletedFrame() const;
+
+	vk::Semaphore getSemaphore() const { return *semaphore; }
+	Statistics getStatistics() const;
+
+private:
+	vk::raii::Device* device = nullptr;
+	vk::raii::Semaphore semaphore{ nullptr };
+
+	// Render thread only
+	uint64_t submittedFrame = 0;
+	uint64_t cpuWaits = 0;
+	double lastWaitMilliseconds = 0.0;
+
+	// Highest value seen on the semaphore
+	mutable std::atomic<uint64_t> completedFrame = 0;
+};
@@ -0,0 +1,519 @@
+#define VMA_IMPLEMENTATION
+#include "GpuAllocator.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	// A heap reported over its threshold only counts as back under a little below it, so usage hovering
+	// around the threshold does not fire the callbacks every frame
+	constexpr double BUDGET_HYSTERESIS = 0.05;
+
+	// A host-visible device-local heap at least this large is a resizable BAR rather than the classic 256 MB window
+	constexpr vk::DeviceSize RESIZABLE_BAR_MIN_HEAP = 1024ull * 1024 * 1024;
+	// One-off writes through the BAR are worth it up to this size; larger uploads keep the CPU free by going through
+	// the copy engine
+	constexpr vk::DeviceSize RESIZABLE_BAR_MAX_DIRECT_WRITE = 64ull * 1024 * 1024;
+	// Per-frame data may take at most this fraction of a small BAR window, which the driver shares with everything else
+	constexpr vk::DeviceSize SMALL_BAR_DIRECT_WRITE_DIVISOR = 16;
+}
+
+GpuAllocator::Buffer::Buffer(Buffer&& other) noexcept
+	: owner(std::exchange(other.owner, nullptr))
+	, buffer(std::exchange(other.buffer, nullptr))
+	, allocation(std::exchange(other.allocation, nullptr))
+	, mapped(std::exchange(other.mapped, nullptr))
+	, size(std::exchange(other.size, 0))
+	, category(other.category)
+	, dedicated(other.dedicated)
+{
+}
+
+GpuAllocator::Buffer& GpuAllocator::Buffer::operator=(Buffer&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		owner = std::exchange(other.owner, nullptr);
+		buffer = std::exchange(other.buffer, nullptr);
+		allocation = std::exchange(other.allocation, nullptr);
+		mapped = std::exchange(other.mapped, nullptr);
+		size = std::exchange(other.size, 0);
+		category = other.category;
+		dedicated = other.dedicated;
+	}
+	return *this;
+}
+
+void GpuAllocator::Buffer::reset()
+{
+	if (owner)
+	{
+		owner->free(buffer, allocation, category, size, dedicated);
+	}
+	owner = nullptr;
+	buffer = nullptr;
+	allocation = nullptr;
+	mapped = nullptr;
+	size = 0;
+}
+
+GpuAllocator::Image::Image(Image&& other) noexcept
+	: owner(std::exchange(other.owner, nullptr))
+	, image(std::exchange(other.image, nullptr))
+	, allocation(std::exchange(other.allocation, nullptr))
+	, size(std::exchange(other.size, 0))
+	, category(other.category)
+	, dedicated(other.dedicated)
+{
+}
+
+GpuAllocator::Image& GpuAllocator::Image::operator=(Image&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		owner = std::exchange(other.owner, nullptr);
+		image = std::exchange(other.image, nullptr);
+		allocation = std::exchange(other.allocation, nullptr);
+		size = std::exchange(other.size, 0);
+		category = other.category;
+		dedicated = other.dedicated;
+	}
+	return *this;
+}
+
+void GpuAllocator::Image::reset()
+{
+	if (owner)
+	{
+		owner->free(image, allocation, category, size, dedicated);
+	}
+	owner = nullptr;
+	image = nullptr;
+	allocation = nullptr;
+	size = 0;
+}
+
+GpuAllocator::Memory::Memory(Memory&& other) noexcept
+	: owner(std::exchange(other.owner, nullptr))
+	, allocation(std::exchange(other.allocation, nullptr))
+	, size(std::exchange(other.size, 0))
+	, category(other.category)
+	, dedicated(other.dedicated)
+{
+}
+
+GpuAllocator::Memory& GpuAllocator::Memory::operator=(Memory&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		owner = std::exchange(other.owner, nullptr);
+		allocation = std::exchange(other.allocation, nullptr);
+		size = std::exchange(other.size, 0);
+		category = other.category;
+		dedicated = other.dedicated;
+	}
+	return *this;
+}
+
+void GpuAllocator::Memory::reset()
+{
+	if (owner)
+	{
+		owner->free(allocation, category, size, dedicated);
+	}
+	owner = nullptr;
+	allocation = nullptr;
+	size = 0;
+}
+
+const char* GpuAllocator::getCategoryName(Category category)
+{
+	switch (category)
+	{
+	case Category::Buffer:
+		return "Buffers";
+	case Category::Geometry:
+		return "Geometry";
+	case Category::Uniforms:
+		return "Uniforms";
+	case Category::Texture:
+		return "Textures";
+	case Category::RenderTarget:
+		return "Render targets";
+	case Category::ForwardPlus:
+		return "Forward+ buffers";
+	case Category::ImGui:
+		return "ImGui";
+	case Category::Staging:
+		return "Staging";
+	default:
+		return "Unknown";
+	}
+}
+
+void GpuAllocator::init(const vk::raii::Instance& instance, const vk::raii::PhysicalDevice& physicalDevice, const vk::raii::Device& device, uint32_t apiVersion,
+	bool memoryBudget)
+{
+	memoryBudgetExtension = memoryBudget;
+
+	VmaAllocatorCreateInfo createInfo{};
+	if (memoryBudgetExtension)
+	{
+		createInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+	}
+	createInfo.vulkanApiVersion = apiVersion;
+	createInfo.instance = static_cast<VkInstance>(*instance);
+	createInfo.physicalDevice = static_cast<VkPhysicalDevice>(*physicalDevice);
+	createInfo.device = static_cast<VkDevice>(*device);
+
+	if (vmaCreateAllocator(&createInfo, &allocator) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create gpu memory allocator!");
+	}
+
+	const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+	vmaGetMemoryProperties(allocator, &memoryProperties);
+	lazilyAllocatedTypeBits = 0;
+	for (uint32_t type = 0; type < memoryProperties->memoryTypeCount; type++)
+	{
+		if (memoryProperties->memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+		{
+			lazilyAllocatedTypeBits |= 1u << type;
+		}
+	}
+
+	// Device-local memory the CPU can map, and how much of VRAM that covers
+	hostAccess = HostAccess::None;
+	vk::DeviceSize directWriteHeapSize = 0;
+	bool everyDeviceLocalTypeHostVisible = true;
+	constexpr VkMemoryPropertyFlags directWriteFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	for (uint32_t type = 0; type < memoryProperties->memoryTypeCount; type++)
+	{
+		const VkMemoryType& memoryType = memoryProperties->memoryTypes[type];
+		if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && !(memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+		{
+			everyDeviceLocalTypeHostVisible = false;
+		}
+		vk::DeviceSize heapSize = memoryProperties->memoryHeaps[memoryType.heapIndex].size;
+		if ((memoryType.propertyFlags & directWriteFlags) == directWriteFlags && heapSize > directWriteHeapSize)
+		{
+			directWriteHeap = memoryType.heapIndex;
+			directWriteHeapSize = heapSize;
+		}
+	}
+	// Integrated GPUs also list a device-local type the CPU cannot map next to the mappable ones, so the device
+	// type decides; the memory types alone only identify unified memory where every device-local type is mappable
+	vk::PhysicalDeviceType deviceType = physicalDevice.getProperties().deviceType;
+	bool unifiedMemory = deviceType == vk::PhysicalDeviceType::eIntegratedGpu || deviceType == vk::PhysicalDeviceType::eCpu ||
+		everyDeviceLocalTypeHostVisible;
+	if (directWriteHeapSize > 0)
+	{
+		hostAccess = unifiedMemory ? HostAccess::Unified
+			: directWriteHeapSize >= RESIZABLE_BAR_MIN_HEAP ? HostAccess::ResizableBar
+			: HostAccess::SmallBar;
+	}
+
+	heapBudgets.assign(memoryProperties->memoryHeapCount, HeapBudget{});
+	heapsOverThreshold.assign(memoryProperties->memoryHeapCount, false);
+	for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; heap++)
+	{
+		heapBudgets[heap].size = memoryProperties->memoryHeaps[heap].size;
+		heapBudgets[heap].deviceLocal = (memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
+}
+
+void GpuAllocator::destroy()
+{
+	if (allocator)
+	{
+		vmaDestroyAllocator(allocator);
+		allocator = nullptr;
+	}
+}
+
+GpuAllocator::Buffer GpuAllocator::createBuffer(const vk::BufferCreateInfo& bufferInfo, vk::MemoryPropertyFlags requiredProperties, Category category)
+{
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+	allocInfo.requiredFlags = static_cast<VkMemoryPropertyFlags>(requiredProperties);
+	if (requiredProperties & vk::MemoryPropertyFlagBits::eHostVisible)
+	{
+		// Written by the CPU front to back and mapped for the buffer's whole lifetime
+		allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		// VMA would otherwise pick the BAR for any buffer the GPU reads; device-local placement is decided by the
+		// caller through prefersDirectWrite and asked for with eDeviceLocal
+		if (!(requiredProperties & vk::MemoryPropertyFlagBits::eDeviceLocal))
+		{
+			allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+		}
+	}
+
+	const VkBufferCreateInfo& createInfo = bufferInfo;
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VmaAllocation allocation = nullptr;
+	VmaAllocationInfo allocationInfo{};
+	if (vmaCreateBuffer(allocator, &createInfo, &allocInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate buffer memory!");
+	}
+
+	Buffer result;
+	result.owner = this;
+	result.buffer = buffer;
+	result.allocation = allocation;
+	result.mapped = allocationInfo.pMappedData;
+	result.size = allocationInfo.size;
+	result.category = category;
+	result.dedicated = isDedicated(allocation);
+	track(category, result.size, result.dedicated, 1);
+	trackDirectWrite(allocation, result.size, 1);
+	return result;
+}
+
+GpuAllocator::Image GpuAllocator::createImage(const vk::ImageCreateInfo& imageInfo, vk::MemoryPropertyFlags requiredProperties, Category category)
+{
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+	allocInfo.requiredFlags = static_cast<VkMemoryPropertyFlags>(requiredProperties);
+	if (category == Category::RenderTarget)
+	{
+		// Large and recreated on resize; a block of their own is returned to the driver as a whole
+		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+	}
+
+	const VkImageCreateInfo& createInfo = imageInfo;
+	VkImage image = VK_NULL_HANDLE;
+	VmaAllocation allocation = nullptr;
+	VmaAllocationInfo allocationInfo{};
+	if (vmaCreateImage(allocator, &createInfo, &allocInfo, &image, &allocation, &allocationInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate image memory!");
+	}
+
+	Image result;
+	result.owner = this;
+	result.image = image;
+	result.allocation = allocation;
+	result.size = allocationInfo.size;
+	result.category = category;
+	result.dedicated = isDedicated(allocation);
+	track(category, result.size, result.dedicated, 1);
+	return result;
+}
+
+GpuAllocator::Memory GpuAllocator::allocateMemory(const vk::MemoryRequirements& requirements, bool lazilyAllocated, Category category)
+{
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = lazilyAllocated ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_UNKNOWN;
+	allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	// Sized for whatever is bound to it, so it goes back to the driver as a whole
+	allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+	const VkMemoryRequirements& memoryRequirements = requirements;
+	VmaAllocation allocation = nullptr;
+	VmaAllocationInfo allocationInfo{};
+	if (vmaAllocateMemory(allocator, &memoryRequirements, &allocInfo, &allocation, &allocationInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate attachment memory!");
+	}
+
+	Memory result;
+	result.owner = this;
+	result.allocation = allocation;
+	result.size = allocationInfo.size;
+	result.category = category;
+	result.dedicated = true;
+	track(category, result.size, result.dedicated, 1);
+	return result;
+}
+
+void GpuAllocator::bindImageMemory(const Memory& memory, vk::DeviceSize offset, vk::Image image)
+{
+	if (vmaBindImageMemory2(allocator, memory.allocation, offset, static_cast<VkImage>(image), nullptr) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to bind image memory!");
+	}
+}
+
+bool GpuAllocator::isDedicated(VmaAllocation allocation) const
+{
+	// VMA also goes dedicated on its own when the driver prefers it for a resource
+	VmaAllocationInfo2 allocationInfo{};
+	vmaGetAllocationInfo2(allocator, allocation, &allocationInfo);
+	return allocationInfo.dedicatedMemory == VK_TRUE;
+}
+
+void GpuAllocator::trackDirectWrite(VmaAllocation allocation, vk::DeviceSize size, int32_t direction)
+{
+	VkMemoryPropertyFlags properties = 0;
+	vmaGetAllocationMemoryProperties(allocator, allocation, &properties);
+	constexpr VkMemoryPropertyFlags directWriteFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	if ((properties & directWriteFlags) != directWriteFlags)
+	{
+		return;
+	}
+	if (direction > 0)
+	{
+		directWriteBuffers++;
+		directWriteBytes += size;
+	}
+	else
+	{
+		directWriteBuffers--;
+		directWriteBytes -= size;
+	}
+}
+
+void GpuAllocator::track(Category category, vk::DeviceSize size, bool dedicated, int32_t direction)
+{
+	CategoryCounters& counter = counters[static_cast<size_t>(category)];
+	if (direction > 0)
+	{
+		counter.allocationCount++;
+		counter.bytes += size;
+		if (dedicated)
+		{
+			counter.dedicatedCount++;
+		}
+	}
+	else
+	{
+		counter.allocationCount--;
+		counter.bytes -= size;
+		if (dedicated)
+		{
+			counter.dedicatedCount--;
+		}
+	}
+}
+
+void GpuAllocator::free(vk::Buffer buffer, VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated)
+{
+	trackDirectWrite(allocation, size, -1);
+	vmaDestroyBuffer(allocator, static_cast<VkBuffer>(buffer), allocation);
+	track(category, size, dedicated, -1);
+}
+
+void GpuAllocator::free(vk::Image image, VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated)
+{
+	vmaDestroyImage(allocator, static_cast<VkImage>(image), allocation);
+	track(category, size, dedicated, -1);
+}
+
+void GpuAllocator::free(VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated)
+{
+	vmaFreeMemory(allocator, allocation);
+	track(category, size, dedicated, -1);
+}
+
+GpuAllocator::Statistics GpuAllocator::getStatistics() const
+{
+	Statistics statistics;
+	for (size_t category = 0; category < counters.size(); category++)
+	{
+		statistics.categories[category].allocationCount = counters[category].allocationCount;
+		statistics.categories[category].dedicatedCount = counters[category].dedicatedCount;
+		statistics.categories[category].bytes = counters[category].bytes;
+	}
+
+	// Budget queries are cheap enough for a per-frame stats panel, unlike vmaCalculateStatistics
+	const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+	vmaGetMemoryProperties(allocator, &memoryProperties);
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+	vmaGetHeapBudgets(allocator, budgets.data());
+	for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; heap++)
+	{
+		statistics.blockCount += budgets[heap].statistics.blockCount;
+		statistics.blockBytes += budgets[heap].statistics.blockBytes;
+		statistics.allocationBytes += budgets[heap].statistics.allocationBytes;
+	}
+	statistics.directWriteBuffers = directWriteBuffers;
+	statistics.directWriteBytes = directWriteBytes;
+	return statistics;
+}
+
+const char* GpuAllocator::getHostAccessName(HostAccess access)
+{
+	switch (access)
+	{
+	case HostAccess::None:
+		return "none (staging only)";
+	case HostAccess::SmallBar:
+		return "small BAR";
+	case HostAccess::ResizableBar:
+		return "resizable BAR";
+	case HostAccess::Unified:
+		return "unified memory";
+	default:
+		return "Unknown";
+	}
+}
+
+bool GpuAllocator::prefersDirectWrite(vk::DeviceSize size, WritePattern pattern) const
+{
+	switch (hostAccess)
+	{
+	case HostAccess::Unified:
+		// A staging copy would only move the data within the same memory
+		return true;
+	case HostAccess::ResizableBar:
+		if (pattern == WritePattern::Once && size > RESIZABLE_BAR_MAX_DIRECT_WRITE)
+		{
+			return false;
+		}
+		break;
+	case HostAccess::SmallBar:
+		// The window is kept for data rewritten every frame, which would otherwise be read over PCIe by every draw
+		if (pattern == WritePattern::Once || size > heapBudgets[directWriteHeap].size / SMALL_BAR_DIRECT_WRITE_DIVISOR)
+		{
+			return false;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	// Leave the heap's headroom to allocations that have no other place to go
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+	vmaGetHeapBudgets(allocator, budgets.data());
+	const VmaBudget& heapBudget = budgets[directWriteHeap];
+	return static_cast<double>(heapBudget.usage + size) <= static_cast<double>(heapBudget.budget) * budgetThreshold;
+}
+
+void GpuAllocator::updateBudget(uint32_t frameNumber)
+{
+	// VMA refetches VK_EXT_memory_budget when the frame index changes and estimates in between
+	vmaSetCurrentFrameIndex(allocator, frameNumber);
+
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+	vmaGetHeapBudgets(allocator, budgets.data());
+	for (uint32_t heap = 0; heap < heapBudgets.size(); heap++)
+	{
+		HeapBudget& heapBudget = heapBudgets[heap];
+		heapBudget.usage = budgets[heap].usage;
+		heapBudget.budget = budgets[heap].budget;
+
+		// Host heaps only hold staging and readback memory, which the streaming systems cannot trade away
+		if (!heapBudget.deviceLocal || heapBudget.budget == 0)
+		{
+			continue;
+		}
+
+		double fraction = static_cast<double>(heapBudget.usage) / static_cast<double>(heapBudget.budget);
+		bool overThreshold = heapsOverThreshold[heap] ? fraction > budgetThreshold - BUDGET_HYSTERESIS : fraction > budgetThreshold;
+		if (overThreshold != heapsOverThreshold[heap])
+		{
+			heapsOverThreshold[heap] = overThreshold;
+			BudgetEvent event{ heap, heapBudget.usage, heapBudget.budget, overThreshold };
+			for (const BudgetCallback& callback : budgetCallbacks)
+			{
+				callback(event);
+			}
+		}
+	}
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+#include <vk_mem_alloc.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+/// Engine-wide device memory allocator on top of VMA. Buffers and images are sub-allocated from large
+/// pooled blocks instead of one vkAllocateMemory each, which keeps far below maxMemoryAllocationCount and
+/// shares alignment slack. Render targets get dedicated allocations so resizing them returns whole blocks.
+/// Host-visible buffers stay persistently mapped. Every allocation is tagged with a category for statistics.
+/// Heap usage is compared against the driver's budget (VK_EXT_memory_budget) once per frame, and listeners are
+/// told when a device-local heap crosses a configurable fraction of it, so streaming can shed load before paging.
+/// Devices whose device-local memory the CPU can map (integrated GPUs, resizable BAR, software rasterizers) are
+/// detected at init; prefersDirectWrite() tells callers when writing a buffer in place beats a staging copy.
+class GpuAllocator
+{
+public:
+	enum class Category : uint32_t
+	{
+		Buffer,
+		Geometry,
+		Uniforms,
+		Texture,
+		RenderTarget,
+		ForwardPlus,
+		ImGui,
+		Staging,
+		Count,
+	};
+
+	struct CategoryStatistics
+	{
+		uint32_t allocationCount = 0;
+		uint32_t dedicatedCount = 0;
+		vk::DeviceSize bytes = 0;
+	};
+
+	struct Statistics
+	{
+		std::array<CategoryStatistics, static_cast<size_t>(Category::Count)> categories{};
+		uint32_t blockCount = 0; // vkDeviceMemory objects owned by VMA, pooled blocks and dedicated allocations
+		vk::DeviceSize blockBytes = 0;
+		vk::DeviceSize allocationBytes = 0; // bytes handed out of those blocks
+		uint32_t directWriteBuffers = 0; // live buffers in device-local, host-visible memory
+		vk::DeviceSize directWriteBytes = 0;
+	};
+
+	struct HeapBudget
+	{
+		vk::DeviceSize usage = 0; // by the whole process, including memory VMA did not allocate
+		vk::DeviceSize budget = 0; // what the process can use before the driver starts paging
+		vk::DeviceSize size = 0;
+		bool deviceLocal = false;
+	};
+
+	/// A device-local heap's usage went above the threshold fraction of its budget, or back below it
+	struct BudgetEvent
+	{
+		uint32_t heap = 0;
+		vk::DeviceSize usage = 0;
+		vk::DeviceSize budget = 0;
+		bool overThreshold = false;
+	};
+	using BudgetCallback = std::function<void(const BudgetEvent&)>;
+
+	static constexpr float DEFAULT_BUDGET_THRESHOLD = 0.9f;
+
+	/// How the CPU reaches device-local memory
+	enum class HostAccess : uint32_t
+	{
+		None, // only through copies
+		SmallBar, // a small window of VRAM, typically 256 MB
+		ResizableBar, // all or most of VRAM
+		Unified, // device-local memory is system memory (integrated GPUs, software rasterizers)
+	};
+
+	/// How a buffer's contents are written by the CPU
+	enum class WritePattern : uint32_t
+	{
+		Once, // filled at creation and then only read by the GPU (meshes)
+		PerFrame, // rewritten every frame (uniforms, light lists)
+	};
+
+	/// A buffer and its memory, released together. Converts to vk::Buffer like a vk::raii::Buffer dereference.
+	class Buffer
+	{
+	public:
+		Buffer() = default;
+		Buffer(std::nullptr_t) {}
+		~Buffer() { reset(); }
+
+		Buffer(const Buffer&) = delete;
+		Buffer& operator=(const Buffer&) = delete;
+		Buffer(Buffer&& other) noexcept;
+		Buffer& operator=(Buffer&& other) noexcept;
+
+		void reset();
+
+		vk::Buffer operator*() const { return buffer; }
+		operator vk::Buffer() const { return buffer; }
+		explicit operator bool() const { return static_cast<bool>(buffer); }
+
+		/// Start of the persistent mapping; null unless the buffer was created host visible
+		void* getMappedData() const { return mapped; }
+		vk::DeviceSize getSize() const { return size; }
+
+	private:
+		friend class GpuAllocator;
+
+		GpuAllocator* owner = nullptr;
+		vk::Buffer buffer;
+		VmaAllocation allocation = nullptr;
+		void* mapped = nullptr;
+		vk::DeviceSize size = 0;
+		Category category = Category::Buffer;
+		bool dedicated = false;
+	};
+
+	/// An image and its memory, released together. Converts to vk::Image like a vk::raii::Image dereference.
+	class Image
+	{
+	public:
+		Image() = default;
+		Image(std::nullptr_t) {}
+		~Image() { reset(); }
+
+		Image(const Image&) = delete;
+		Image& operator=(const Image&) = delete;
+		Image(Image&& other) noexcept;
+		Image& operator=(Image&& other) noexcept;
+
+		void reset();
+
+		vk::Image operator*() const { return image; }
+		operator vk::Image() const { return image; }
+		explicit operator bool() const { return static_cast<bool>(image); }
+
+		vk::DeviceSize getSize() const { return size; }
+
+	private:
+		friend class GpuAllocator;
+
+		GpuAllocator* owner = nullptr;
+		vk::Image image;
+		VmaAllocation allocation = nullptr;
+		vk::DeviceSize size = 0;
+		Category category = Category::Texture;
+		bool dedicated = false;
+	};
+
+	/// Memory not bound to a resource yet; images bound at overlapping ranges alias it
+	class Memory
+	{
+	public:
+		Memory() = default;
+		Memory(std::nullptr_t) {}
+		~Memory() { reset(); }
+
+		Memory(const Memory&) = delete;
+		Memory& operator=(const Memory&) = delete;
+		Memory(Memory&& other) noexcept;
+		Memory& operator=(Memory&& other) noexcept;
+
+		void reset();
+
+		explicit operator bool() const { return allocation != nullptr; }
+		vk::DeviceSize getSize() const { return size; }
+
+	private:
+		friend class GpuAllocator;
+
+		GpuAllocator* owner = nullptr;
+		VmaAllocation allocation = nullptr;
+		vk::DeviceSize size = 0;
+		Category category = Category::RenderTarget;
+		bool dedicated = false;
+	};
+
+	GpuAllocator() = default;
+	~GpuAllocator() { destroy(); }
+
+	GpuAllocator(const GpuAllocator&) = delete;
+	GpuAllocator& operator=(const GpuAllocator&) = delete;
+
+	static const char* getCategoryName(Category category);
+
+	/// apiVersion must match the instance's; the device has to outlive the allocator and everything it created.
+	/// memoryBudget tells whether the device was created with VK_EXT_memory_budget; without it budgets are estimated.
+	void init(const vk::raii::Instance& instance, const vk::raii::PhysicalDevice& physicalDevice, const vk::raii::Device& device, uint32_t apiVersion,
+		bool memoryBudget);
+	void destroy();
+
+	/// The memory type has at least requiredProperties; host-visible buffers come back mapped
+	Buffer createBuffer(const vk::BufferCreateInfo& bufferInfo, vk::MemoryPropertyFlags requiredProperties, Category category);
+	/// Render targets and images VMA reports as preferring it get a dedicated allocation
+	Image createImage(const vk::ImageCreateInfo& imageInfo, vk::MemoryPropertyFlags requiredProperties, Category category);
+	/// Dedicated memory for resources bound with bindImageMemory. lazilyAllocated picks a lazily allocated type,
+	/// which needs getLazilyAllocatedMemoryTypeBits() to intersect requirements.memoryTypeBits.
+	Memory allocateMemory(const vk::MemoryRequirements& requirements, bool lazilyAllocated, Category category);
+	void bindImageMemory(const Memory& memory, vk::DeviceSize offset, vk::Image image);
+	/// Memory types backed only on demand (tile memory); 0 on most desktop GPUs
+	uint32_t getLazilyAllocatedMemoryTypeBits() const { return lazilyAllocatedTypeBits; }
+
+	Statistics getStatistics() const;
+
+	HostAccess getHostAccess() const { return hostAccess; }
+	static const char* getHostAccessName(HostAccess access);
+	/// Properties of device-local memory the CPU writes through a persistent mapping
+	static vk::MemoryPropertyFlags getDirectWriteProperties()
+	{
+		return vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	}
+	/// Whether a buffer of size bytes written with pattern should live in getDirectWriteProperties() memory and be
+	/// written in place rather than staged. Writes must be sequential and the CPU must never read it back.
+	/// Any thread.
+	bool prefersDirectWrite(vk::DeviceSize size, WritePattern pattern) const;
+	/// Memory for a buffer the CPU writes through its mapping either way: device local when prefersDirectWrite
+	/// agrees, host memory the GPU reads over the bus otherwise
+	vk::MemoryPropertyFlags getHostWriteProperties(vk::DeviceSize size, WritePattern pattern) const
+	{
+		return prefersDirectWrite(size, pattern) ? getDirectWriteProperties()
+			: vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	}
+
+	/// Render thread, once per frame: refreshes the heap budgets and calls the budget callbacks on threshold crossings
+	void updateBudget(uint32_t frameNumber);
+	/// Heap budgets as of the last updateBudget
+	std::span<const HeapBudget> getHeapBudgets() const { return heapBudgets; }
+	bool hasMemoryBudgetExtension() const { return memoryBudgetExtension; }
+	/// Fraction of a heap's budget above which the callbacks report it as over; takes effect at the next update
+	void setBudgetThreshold(float fraction) { budgetThreshold = fraction; }
+	float getBudgetThreshold() const { return budgetThreshold; }
+	void addBudgetCallback(BudgetCallback callback) { budgetCallbacks.push_back(std::move(callback)); }
+
+private:
+	bool isDedicated(VmaAllocation allocation) const;
+	/// Counts buffers placed in memory that is both device local and host visible
+	void trackDirectWrite(VmaAllocation allocation, vk::DeviceSize size, int32_t direction);
+	void track(Category category, vk::DeviceSize size, bool dedicated, int32_t direction);
+	void free(vk::Buffer buffer, VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated);
+	void free(vk::Image image, VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated);
+	void free(VmaAllocation allocation, Category category, vk::DeviceSize size, bool dedicated);
+
+	VmaAllocator allocator = nullptr;
+	bool memoryBudgetExtension = false;
+	uint32_t lazilyAllocatedTypeBits = 0;
+	HostAccess hostAccess = HostAccess::None;
+	// Largest heap holding a device-local, host-visible, host-coherent type; only valid when hostAccess != None
+	uint32_t directWriteHeap = 0;
+
+	// Render thread only
+	std::vector<HeapBudget> heapBudgets;
+	std::vector<bool> heapsOverThreshold;
+	std::atomic<float> budgetThreshold = DEFAULT_BUDGET_THRESHOLD;
+	std::vector<BudgetCallback> budgetCallbacks;
+
+	struct CategoryCounters
+	{
+		std::atomic<uint32_t> allocationCount = 0;
+		std::atomic<uint32_t> dedicatedCount = 0;
+		std::atomic<uint64_t> bytes = 0;
+	};
+	// Resources are created and released from loader threads as well as the render thread
+	std::array<CategoryCounters, static_cast<size_t>(Category::Count)> counters;
+	std::atomic<uint32_t> directWriteBuffers = 0;
+	std::atomic<uint64_t> directWriteBytes = 0;
+};
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <stdexcept>
 #include <cstring>
+#include <span>
 
 #include "../Window.h"
 
@@ -28,13 +29,11 @@ ImGuiVulkanUtil::~ImGuiVulkanUtil() {
     cleanup();
 }
 
-void ImGuiVulkanUtil::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& inPhysicalDevice,
-                           vk::raii::Queue& inGraphicsQueue, vk::raii::CommandPool& inCommandPool, uint32_t inGraphicsQueueFamily) {
+void ImGuiVulkanUtil::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& inPhysicalDevice, GpuAllocator& inAllocator, UploadService& inUploadService) {
     device = &inDevice;
     physicalDevice = &inPhysicalDevice;
-    graphicsQueue = &inGraphicsQueue;
-    commandPool = &inCommandPool;
-    graphicsQueueFamily = inGraphicsQueueFamily;
+    allocator = &inAllocator;
+    uploadService = &inUploadService;
 }
 
 void ImGuiVulkanUtil::initialize(float width, float height) {
@@ -87,34 +86,16 @@ void ImGuiVulkanUtil::setStyle(uint32_t index) {
     }
 }
 
-uint32_t ImGuiVulkanUtil::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) {
-    vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice->getMemoryProperties();
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-    throw std::runtime_error("Failed to find suitable memory type!");
-}
-
-void ImGuiVulkanUtil::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory) {
+void ImGuiVulkanUtil::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Buffer& buffer, GpuAllocator::Category category) {
     vk::BufferCreateInfo bufferInfo;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = vk::SharingMode::eExclusive;
 
-    buffer = vk::raii::Buffer(*device, bufferInfo);
-
-    vk::MemoryRequirements memRequirements = buffer.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    bufferMemory = vk::raii::DeviceMemory(*device, allocInfo);
-    buffer.bindMemory(*bufferMemory, 0);
+    buffer = allocator->createBuffer(bufferInfo, properties, category);
 }
 
-void ImGuiVulkanUtil::createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory) {
+void ImGuiVulkanUtil::createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Image& image) {
     vk::ImageCreateInfo imageInfo;
     imageInfo.imageType = vk::ImageType::e2D;
     imageInfo.format = format;
@@ -127,18 +108,10 @@ void ImGuiVulkanUtil::createImage(uint32_t width, uint32_t height, vk::Format fo
     imageInfo.sharingMode = vk::SharingMode::eExclusive;
     imageInfo.initialLayout = vk::ImageLayout::eUndefined;
 
-    image = vk::raii::Image(*device, imageInfo);
-
-    vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    imageMemory = vk::raii::DeviceMemory(*device, allocInfo);
-    image.bindMemory(*imageMemory, 0);
+    image = allocator->createImage(imageInfo, properties, GpuAllocator::Category::ImGui);
 }
 
-vk::raii::ImageView ImGuiVulkanUtil::createImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags) {
+vk::raii::ImageView ImGuiVulkanUtil::createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags) {
     vk::ImageViewCreateInfo viewInfo;
     viewInfo.image = image;
     viewInfo.viewType = vk::ImageViewType::e2D;
@@ -148,87 +121,6 @@ vk::raii::ImageView ImGuiVulkanUtil::createImageView(vk::raii::Image& image, vk:
     return vk::raii::ImageView(*device, viewInfo);
 }
 
-void ImGuiVulkanUtil::transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) {
-    vk::CommandBufferAllocateInfo allocInfo;
-    allocInfo.commandPool = *commandPool;
-    allocInfo.level = vk::CommandBufferLevel::ePrimary;
-    allocInfo.commandBufferCount = 1;
-
-    vk::raii::CommandBuffer commandBuffer = std::move(device->allocateCommandBuffers(allocInfo).front());
-
-    vk::CommandBufferBeginInfo beginInfo;
-    beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-    commandBuffer.begin(beginInfo);
-
-    vk::ImageMemoryBarrier barrier;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.image = image;
-    barrier.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 };
-
-    vk::PipelineStageFlags sourceStage;
-    vk::PipelineStageFlags destinationStage;
-
-    if (oldLayout == vk::ImageLayout::eUndefined && newLayout == vk::ImageLayout::eTransferDstOptimal) {
-        barrier.srcAccessMask = {};
-        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-        sourceStage = vk::PipelineStageFlagBits::eTopOfPipe;
-        destinationStage = vk::PipelineStageFlagBits::eTransfer;
-    } else if (oldLayout == vk::ImageLayout::eTransferDstOptimal && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal) {
-        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-        sourceStage = vk::PipelineStageFlagBits::eTransfer;
-        destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
-    } else {
-        throw std::invalid_argument("Unsupported layout transition!");
-    }
-
-    commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, nullptr, nullptr, barrier);
-
-    commandBuffer.end();
-
-    vk::SubmitInfo submitInfo;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &*commandBuffer;
-
-    graphicsQueue->submit(submitInfo);
-    graphicsQueue->waitIdle();
-}
-
-void ImGuiVulkanUtil::copyBufferToImage(vk::raii::Buffer& buffer, vk::raii::Image& image, uint32_t width, uint32_t height) {
-    vk::CommandBufferAllocateInfo allocInfo;
-    allocInfo.commandPool = *commandPool;
-    allocInfo.level = vk::CommandBufferLevel::ePrimary;
-    allocInfo.commandBufferCount = 1;
-
-    vk::raii::CommandBuffer commandBuffer = std::move(device->allocateCommandBuffers(allocInfo).front());
-
-    vk::CommandBufferBeginInfo beginInfo;
-    beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-    commandBuffer.begin(beginInfo);
-
-    vk::BufferImageCopy region;
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
-    region.imageOffset = vk::Offset3D{ 0, 0, 0 };
-    region.imageExtent = vk::Extent3D{ width, height, 1 };
-
-    commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, { region });
-
-    commandBuffer.end();
-
-    vk::SubmitInfo submitInfo;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &*commandBuffer;
-
-    graphicsQueue->submit(submitInfo);
-    graphicsQueue->waitIdle();
-}
-
 void ImGuiVulkanUtil::initResources() {
     ImGuiIO& io = ImGui::GetIO();
     unsigned char* fontData;
@@ -247,23 +139,14 @@ void ImGuiVulkanUtil::initResources() {
                 vk::ImageTiling::eOptimal,
                 vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
                 vk::MemoryPropertyFlagBits::eDeviceLocal,
-                fontImage, fontImageMemory);
+                fontImage);
 
     fontImageView = createImageView(fontImage, vk::Format::eR8G8B8A8Unorm, vk::ImageAspectFlagBits::eColor);
 
-    vk::raii::Buffer stagingBuffer{ nullptr };
-    vk::raii::DeviceMemory stagingBufferMemory{ nullptr };
-    createBuffer(uploadSize, vk::BufferUsageFlagBits::eTransferSrc,
-                 vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-                 stagingBuffer, stagingBufferMemory);
-
-    void* data = stagingBufferMemory.mapMemory(0, uploadSize);
-    memcpy(data, fontData, uploadSize);
-    stagingBufferMemory.unmapMemory();
-
-    transitionImageLayout(*fontImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-    copyBufferToImage(stagingBuffer, fontImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    transitionImageLayout(*fontImage, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+    fontUploadTicket = uploadService->uploadImage(std::as_bytes(std::span(fontData, static_cast<size_t>(uploadSize))), *fontImage,
+                                                  vk::Format::eR8G8B8A8Unorm, fontExtent.width, fontExtent.height,
+                                                  vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eFragmentShader,
+                                                  vk::AccessFlagBits2::eShaderSampledRead);
 
     vk::SamplerCreateInfo samplerInfo{};
     samplerInfo.magFilter = vk::Filter::eLinear;
@@ -511,7 +394,7 @@ bool ImGuiVulkanUtil::newFrame() {
         
         // Calculate UV coordinates to maintain aspect ratio if needed
         ImVec2 uv0 = ImVec2(0.0f, 0.0f);
-        ImVec2 uv1 = ImVec2(1.0f, 1.0f);
+        ImVec2 uv1 = sceneTextureRegion;
         
         // Display the scene texture using the descriptor set passed from Renderer
         ImGui::Image((ImTextureID)sceneDescriptorSet, viewportSize, uv0, uv1);
@@ -519,10 +402,23 @@ bool ImGuiVulkanUtil::newFrame() {
         ImGui::End();
     }
 
+    for (auto& panel : panels) {
+        if (!panel.visible) {
+            continue;
+        }
+        if (ImGui::Begin(panel.name.c_str(), &panel.visible)) {
+            panel.draw();
+        }
+        ImGui::End();
+    }
+
     // Simple menu bar
     if (ImGui::BeginMenuBar()) {
         if (ImGui::BeginMenu("View")) {
             ImGui::MenuItem("Scene Viewport", NULL, &showSceneViewport);
+            for (auto& panel : panels) {
+                ImGui::MenuItem(panel.name.c_str(), NULL, &panel.visible);
+            }
             ImGui::EndMenu();
         }
         ImGui::EndMenuBar();
@@ -544,7 +440,7 @@ bool ImGuiVulkanUtil::newFrame() {
     return false;
 }
 
-void ImGuiVulkanUtil::updateBuffers() {
+void ImGuiVulkanUtil::updateBuffers(uint32_t frameSlot, DeletionQueue& deletionQueue, uint64_t retireFrame) {
     ImDrawData* drawData = ImGui::GetDrawData();
     if (!drawData || drawData->CmdListsCount == 0) {
         return;
@@ -553,28 +449,32 @@ void ImGuiVulkanUtil::updateBuffers() {
     vk::DeviceSize vertexBufferSize = drawData->TotalVtxCount * sizeof(ImDrawVert);
     vk::DeviceSize indexBufferSize = drawData->TotalIdxCount * sizeof(ImDrawIdx);
 
-    if (vertexBuffer == nullptr || vertexBufferSize > maxVertexBufferSize) {
-        maxVertexBufferSize = std::max(vertexBufferSize, vk::DeviceSize(1024 * 1024));
-        vertexBuffer = nullptr;
-        vertexBufferMemory = nullptr;
-        createBuffer(maxVertexBufferSize, vk::BufferUsageFlagBits::eVertexBuffer,
-                     vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-                     vertexBuffer, vertexBufferMemory);
-        vertexCount = drawData->TotalVtxCount;
+    FrameBuffers& buffers = frameBuffers[frameSlot];
+
+    if (!buffers.vertexBuffer || vertexBufferSize > buffers.maxVertexBufferSize) {
+        buffers.maxVertexBufferSize = std::max(vertexBufferSize, vk::DeviceSize(1024 * 1024));
+        if (buffers.vertexBuffer) {
+            deletionQueue.push(retireFrame, std::move(buffers.vertexBuffer));
+        }
+        createBuffer(buffers.maxVertexBufferSize, vk::BufferUsageFlagBits::eVertexBuffer,
+                     allocator->getHostWriteProperties(buffers.maxVertexBufferSize, GpuAllocator::WritePattern::PerFrame),
+                     buffers.vertexBuffer, GpuAllocator::Category::ImGui);
+        vertexCount = std::max(vertexCount, static_cast<uint32_t>(drawData->TotalVtxCount));
     }
 
-    if (indexBuffer == nullptr || indexBufferSize > maxIndexBufferSize) {
-        maxIndexBufferSize = std::max(indexBufferSize, vk::DeviceSize(1024 * 1024));
-        indexBuffer = nullptr;
-        indexBufferMemory = nullptr;
-        createBuffer(maxIndexBufferSize, vk::BufferUsageFlagBits::eIndexBuffer,
-                     vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-                     indexBuffer, indexBufferMemory);
-        indexCount = drawData->TotalIdxCount;
+    if (!buffers.indexBuffer || indexBufferSize > buffers.maxIndexBufferSize) {
+        buffers.maxIndexBufferSize = std::max(indexBufferSize, vk::DeviceSize(1024 * 1024));
+        if (buffers.indexBuffer) {
+            deletionQueue.push(retireFrame, std::move(buffers.indexBuffer));
+        }
+        createBuffer(buffers.maxIndexBufferSize, vk::BufferUsageFlagBits::eIndexBuffer,
+                     allocator->getHostWriteProperties(buffers.maxIndexBufferSize, GpuAllocator::WritePattern::PerFrame),
+                     buffers.indexBuffer, GpuAllocator::Category::ImGui);
+        indexCount = std::max(indexCount, static_cast<uint32_t>(drawData->TotalIdxCount));
     }
 
-    ImDrawVert* vtxDst = static_cast<ImDrawVert*>(vertexBufferMemory.mapMemory(0, vertexBufferSize));
-    ImDrawIdx* idxDst = static_cast<ImDrawIdx*>(indexBufferMemory.mapMemory(0, indexBufferSize));
+    ImDrawVert* vtxDst = static_cast<ImDrawVert*>(buffers.vertexBuffer.getMappedData());
+    ImDrawIdx* idxDst = static_cast<ImDrawIdx*>(buffers.indexBuffer.getMappedData());
 
     for (int n = 0; n < drawData->CmdListsCount; n++) {
         const ImDrawList* cmdList = drawData->CmdLists[n];
@@ -583,14 +483,11 @@ void ImGuiVulkanUtil::updateBuffers() {
         vtxDst += cmdList->VtxBuffer.Size;
         idxDst += cmdList->IdxBuffer.Size;
     }
-
-    vertexBufferMemory.unmapMemory();
-    indexBufferMemory.unmapMemory();
 }
 
-void ImGuiVulkanUtil::drawFrame(vk::raii::CommandBuffer& commandBuffer, vk::raii::ImageView& swapChainImageView, vk::Extent2D swapChainExtent) {
+void ImGuiVulkanUtil::drawFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frameSlot, vk::raii::ImageView& swapChainImageView, vk::Extent2D swapChainExtent) {
     ImDrawData* drawData = ImGui::GetDrawData();
-    if (!drawData || drawData->CmdListsCount == 0) {
+    if (!drawData || drawData->CmdListsCount == 0 || !uploadService->isReady(fontUploadTicket)) {
         return;
     }
 
@@ -624,10 +521,11 @@ void ImGuiVulkanUtil::drawFrame(vk::raii::CommandBuffer& commandBuffer, vk::raii
     commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eVertex,
                                0, vk::ArrayProxy<const PushConstBlock>(1, &pushConstBlock));
 
-    vk::Buffer vertexBuffers[] = { *vertexBuffer };
+    const FrameBuffers& buffers = frameBuffers[frameSlot];
+    vk::Buffer vertexBuffers[] = { *buffers.vertexBuffer };
     vk::DeviceSize offsets[] = { 0 };
     commandBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
-    commandBuffer.bindIndexBuffer(*indexBuffer, 0, vk::IndexType::eUint16);
+    commandBuffer.bindIndexBuffer(*buffers.indexBuffer, 0, vk::IndexType::eUint16);
 
     int vertexOffset = 0;
     int indexOffset = 0;
@@ -717,14 +615,12 @@ void ImGuiVulkanUtil::cleanup() {
         device->waitIdle();
     }
 
-    fontImage = nullptr;
     fontImageView = nullptr;
+    fontImage = nullptr;
     sampler = nullptr;
-    vertexBuffer = nullptr;
-    indexBuffer = nullptr;
-    vertexBufferMemory = nullptr;
-    indexBufferMemory = nullptr;
-    fontImageMemory = nullptr;
+    for (FrameBuffers& buffers : frameBuffers) {
+        buffers = FrameBuffers{};
+    }
     pipeline = nullptr;
     pipelineLayout = nullptr;
     pipelineCache = nullptr;
@@ -1,26 +1,37 @@
 #pragma once
 
+#include "DeletionQueue.h"
+#include "FrameTimeline.h"
+#include "GpuAllocator.h"
+#include "UploadService.h"
+
 #include <vulkan/vulkan_raii.hpp>
 #include <imgui.h>
 #include <glm/glm.hpp>
 
 #include <vector>
 #include <array>
+#include <functional>
+#include <string>
 
 class ImGuiVulkanUtil {
 private:
     vk::raii::Sampler sampler{ nullptr };
-    vk::raii::Buffer vertexBuffer{ nullptr };
-    vk::raii::Buffer indexBuffer{ nullptr };
-    vk::raii::DeviceMemory vertexBufferMemory{ nullptr };
-    vk::raii::DeviceMemory indexBufferMemory{ nullptr };
+    // Host visible and persistently mapped; one pair per frame slot so the CPU never rewrites geometry a frame
+    // still in flight reads
+    struct FrameBuffers {
+        GpuAllocator::Buffer vertexBuffer{ nullptr };
+        GpuAllocator::Buffer indexBuffer{ nullptr };
+        vk::DeviceSize maxVertexBufferSize = 0;
+        vk::DeviceSize maxIndexBufferSize = 0;
+    };
+    std::array<FrameBuffers, FrameTimeline::MAX_FRAMES_IN_FLIGHT> frameBuffers;
     uint32_t vertexCount = 0;
     uint32_t indexCount = 0;
-    vk::DeviceSize maxVertexBufferSize = 0;
-    vk::DeviceSize maxIndexBufferSize = 0;
-    vk::raii::Image fontImage{ nullptr };
-    vk::raii::DeviceMemory fontImageMemory{ nullptr };
+    GpuAllocator::Image fontImage{ nullptr };
     vk::raii::ImageView fontImageView{ nullptr };
+    // The font goes out with the next upload batch; nothing is drawn until it was acquired
+    UploadService::Ticket fontUploadTicket = 0;
 
     vk::raii::PipelineCache pipelineCache{ nullptr };
     vk::raii::PipelineLayout pipelineLayout{ nullptr };
@@ -31,9 +42,8 @@ private:
 
     vk::raii::Device* device = nullptr;
     vk::raii::PhysicalDevice* physicalDevice = nullptr;
-    vk::raii::Queue* graphicsQueue = nullptr;
-    vk::raii::CommandPool* commandPool = nullptr;
-    uint32_t graphicsQueueFamily = 0;
+    GpuAllocator* allocator = nullptr;
+    UploadService* uploadService = nullptr;
 
     ImGuiStyle vulkanStyle;
 
@@ -52,24 +62,31 @@ private:
     bool sceneTextureValid = false;
     bool sceneTextureRegistered = false;
     VkDescriptorSet sceneDescriptorSet = VK_NULL_HANDLE;
+    // Bottom-right texture coordinate of the region the scene was rendered into; the viewport stretches it
+    ImVec2 sceneTextureRegion = ImVec2(1.0f, 1.0f);
     bool showSceneViewport = true;
 
-    void createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory);
-    void createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory);
-    vk::raii::ImageView createImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags);
-    void transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout);
-    void copyBufferToImage(vk::raii::Buffer& buffer, vk::raii::Image& image, uint32_t width, uint32_t height);
-    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties);
+    // Tool windows registered by engine systems (stats, debug controls), drawn inside the dock space
+    struct Panel {
+        std::string name;
+        std::function<void()> draw;
+        bool visible = true;
+    };
+    std::vector<Panel> panels;
+
+    void createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Buffer& buffer, GpuAllocator::Category category);
+    void createImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Image& image);
+    vk::raii::ImageView createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags);
 
 public:
     ImGuiVulkanUtil();
     ~ImGuiVulkanUtil();
 
-    void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
-              vk::raii::Queue& graphicsQueue, vk::raii::CommandPool& commandPool, uint32_t graphicsQueueFamily);
+    void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, GpuAllocator& allocator, UploadService& uploadService);
     void setColorFormat(vk::Format format) { colorFormat = format; }
     void initialize(float width, float height);
     void updateDisplaySize(float width, float height);
+    // Records the font upload into uploadService's open batch; the caller submits it
     void initResources();
     void setStyle(uint32_t index);
     void setSceneTextureInfo(vk::raii::Sampler* samplerPtr, vk::raii::ImageView* imageViewPtr, VkDescriptorSet descSet) { 
@@ -80,10 +97,16 @@ public:
         sceneTextureRegistered = true;
     }
     void clearSceneTexture() { sceneTextureValid = false; sceneTextureRegistered = false; }
+    // Part of the scene texture to show, in texture coordinates from the top-left corner
+    void setSceneTextureRegion(float u, float v) { sceneTextureRegion = ImVec2(u, v); }
+
+    // Registers a window whose contents draw() emits every frame; it is listed in the View menu
+    void addPanel(const std::string& name, std::function<void()> draw) { panels.push_back({ name, std::move(draw) }); }
 
     bool newFrame();
-    void updateBuffers();
-    void drawFrame(vk::raii::CommandBuffer& commandBuffer, vk::raii::ImageView& swapChainImageView, vk::Extent2D swapChainExtent);
+    // Fills frameSlot's buffers; buffers too small for this frame are handed to deletionQueue until retireFrame completed
+    void updateBuffers(uint32_t frameSlot, DeletionQueue& deletionQueue, uint64_t retireFrame);
+    void drawFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frameSlot, vk::raii::ImageView& swapChainImageView, vk::Extent2D swapChainExtent);
 
     void handleKey(int key, int scancode, int action, int mods);
     bool getWantKeyCapture();
@@ -0,0 +1,259 @@
+#include "MeshCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	const std::string MESH_CACHE_DIRECTORY = "../Engine/Intermediate/MeshCache";
+	constexpr char MESH_CACHE_MAGIC[8] = { 'Q', 'M', 'E', 'S', 'H', 'C', 'A', 'C' };
+	constexpr uint64_t MESH_CACHE_SECTION_ALIGNMENT = 64;
+
+	struct FileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t sectionCount;
+		uint64_t sourceSize;
+		int64_t sourceWriteTime;
+		uint64_t sourceHash;
+		double coldLoadMilliseconds;
+	};
+
+	struct SectionEntry
+	{
+		uint32_t id;
+		uint32_t elementSize;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	uint64_t alignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	uint64_t mix(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+		return value;
+	}
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath)
+{
+	// The path hash keeps same-named assets in different folders apart
+	std::filesystem::path source(sourcePath);
+	char suffix[17];
+	snprintf(suffix, sizeof(suffix), "%016llx", static_cast<unsigned long long>(hashBytes(sourcePath.data(), sourcePath.size())));
+	return MESH_CACHE_DIRECTORY + "/" + source.stem().string() + "-" + suffix + ".meshcache";
+}
+
+bool MeshCache::stampSource(const std::string& sourcePath, SourceStamp& outStamp)
+{
+	std::error_code error;
+	outStamp.size = std::filesystem::file_size(sourcePath, error);
+	if (error)
+	{
+		return false;
+	}
+	outStamp.writeTime = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+	outStamp.contentHash = 0;
+	return !error;
+}
+
+uint64_t MeshCache::hashBytes(const void* data, size_t size)
+{
+	// Word-at-a-time multiply/xorshift hash. Only used to detect changed source assets, not for security.
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = 0x9E3779B97F4A7C15ull ^ (size * 0xC2B2AE3D27D4EB4Full);
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ mix(word)) * 0x9E3779B97F4A7C15ull;
+	}
+
+	uint64_t tail = 0;
+	for (size_t shift = 0; i < size; i++, shift += 8)
+	{
+		tail |= static_cast<uint64_t>(bytes[i]) << shift;
+	}
+	return mix(hash ^ mix(tail));
+}
+
+bool MeshCache::open(const std::string& sourcePath, const SourceStamp& stamp)
+{
+	close();
+
+	if (!file.open(getCachePath(sourcePath)))
+	{
+		return false;
+	}
+
+	if (file.getSize() < sizeof(FileHeader))
+	{
+		close();
+		return false;
+	}
+
+	FileHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	bool valid = memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) == 0 &&
+		header.version == MESH_CACHE_VERSION &&
+		sizeof(FileHeader) + header.sectionCount * sizeof(SectionEntry) <= file.getSize();
+
+	bool sourceMatches = (header.sourceSize == stamp.size && header.sourceWriteTime == stamp.writeTime) ||
+		(stamp.contentHash != 0 && header.sourceHash == stamp.contentHash);
+
+	if (!valid || !sourceMatches)
+	{
+		close();
+		return false;
+	}
+
+	coldLoadMilliseconds = header.coldLoadMilliseconds;
+	return true;
+}
+
+void MeshCache::close()
+{
+	file.close();
+	coldLoadMilliseconds = 0.0;
+}
+
+std::span<const std::byte> MeshCache::getSectionBytes(MeshCacheSection id, size_t elementSize) const
+{
+	if (!file.isOpen())
+	{
+		return {};
+	}
+
+	FileHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	const std::byte* entries = file.getData() + sizeof(FileHeader);
+	for (uint32_t i = 0; i < header.sectionCount; i++)
+	{
+		SectionEntry entry;
+		memcpy(&entry, entries + i * sizeof(SectionEntry), sizeof(entry));
+		if (entry.id != static_cast<uint32_t>(id))
+		{
+			continue;
+		}
+		if (entry.elementSize != elementSize || entry.offset + entry.size > file.getSize())
+		{
+			throw std::runtime_error("mesh cache section has an unexpected layout!");
+		}
+		return { file.getData() + entry.offset, static_cast<size_t>(entry.size) };
+	}
+
+	return {};
+}
+
+bool MeshCache::write(const std::string& sourcePath, const SourceStamp& stamp, double coldLoadMilliseconds,
+	std::span<const SectionData> sections)
+{
+	std::string cachePath = getCachePath(sourcePath);
+	std::string tempPath = cachePath + ".tmp";
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+
+	FileHeader header{};
+	memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+	header.version = MESH_CACHE_VERSION;
+	header.sectionCount = static_cast<uint32_t>(sections.size());
+	header.sourceSize = stamp.size;
+	header.sourceWriteTime = stamp.writeTime;
+	header.sourceHash = stamp.contentHash;
+	header.coldLoadMilliseconds = coldLoadMilliseconds;
+
+	// Section payloads are aligned so the mapped spans can be read in place
+	std::vector<SectionEntry> entries(sections.size());
+	uint64_t offset = alignUp(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry), MESH_CACHE_SECTION_ALIGNMENT);
+	for (size_t i = 0; i < sections.size(); i++)
+	{
+		entries[i].id = static_cast<uint32_t>(sections[i].id);
+		entries[i].elementSize = sections[i].elementSize;
+		entries[i].offset = offset;
+		entries[i].size = sections[i].bytes.size();
+		offset = alignUp(offset + entries[i].size, MESH_CACHE_SECTION_ALIGNMENT);
+	}
+
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+		{
+			std::cout << "Mesh cache: could not write " << tempPath << std::endl;
+			return false;
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(SectionEntry)));
+
+		for (size_t i = 0; i < sections.size(); i++)
+		{
+			out.seekp(static_cast<std::streamoff>(entries[i].offset));
+			out.write(reinterpret_cast<const char*>(sections[i].bytes.data()), static_cast<std::streamsize>(sections[i].bytes.size()));
+		}
+
+		if (!out.good())
+		{
+			std::cout << "Mesh cache: failed while writing " << tempPath << std::endl;
+			out.close();
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::cout << "Mesh cache: could not replace " << cachePath << ": " << error.message() << std::endl;
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::restamp(const std::string& sourcePath, const SourceStamp& stamp)
+{
+	std::string cachePath = getCachePath(sourcePath);
+	std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+	if (!file.is_open())
+	{
+		std::cout << "Mesh cache: could not restamp " << cachePath << std::endl;
+		return false;
+	}
+
+	FileHeader header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 || header.version != MESH_CACHE_VERSION)
+	{
+		return false;
+	}
+
+	header.sourceSize = stamp.size;
+	header.sourceWriteTime = stamp.writeTime;
+	header.sourceHash = stamp.contentHash;
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!file.good())
+	{
+		std::cout << "Mesh cache: failed while restamping " << cachePath << std::endl;
+		return false;
+	}
+	return true;
+}
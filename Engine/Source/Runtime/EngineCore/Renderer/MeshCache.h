@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Runtime/EngineCore/MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Bump whenever the layout of anything stored in the cache changes (Vertex, section contents, ...)
+constexpr uint32_t MESH_CACHE_VERSION = 6;
+
+enum class MeshCacheSection : uint32_t
+{
+	Vertices = 0,
+	Indices = 1, // raw bytes, 16-bit or 32-bit per submesh
+	OptimizationReport = 2, // MeshOptimizer::OptimizationReport for the stored vertex/index order
+	VertexQuantization = 3, // dequantization constants for the packed vertices
+	VertexLayout = 4, // layoutId() of the GpuVertex layout the vertices were packed with
+	Lods = 5, // MeshLod table of every submesh; index ranges are relative to the submesh's first index
+	Submeshes = 6, // Submesh table
+};
+
+/// On-disk cache of the final, GPU-ready vertex/index arrays produced by a mesh import.
+/// A cache file is keyed by a content hash of the source asset; on a hit it is memory-mapped and
+/// its sections are handed out as spans into the mapping, so nothing is copied or decoded.
+class MeshCache
+{
+public:
+	struct SourceStamp
+	{
+		uint64_t size = 0;
+		int64_t writeTime = 0;
+		uint64_t contentHash = 0;
+	};
+
+	struct SectionData
+	{
+		MeshCacheSection id;
+		uint32_t elementSize;
+		std::span<const std::byte> bytes;
+
+		template <typename T>
+		static SectionData of(MeshCacheSection id, std::span<const T> elements)
+		{
+			return { id, static_cast<uint32_t>(sizeof(T)), std::as_bytes(elements) };
+		}
+	};
+
+	/// Cache file location for a source asset.
+	static std::string getCachePath(const std::string& sourcePath);
+
+	/// Stats the source asset. The content hash is left at 0; fill it with hashBytes once the source is read.
+	static bool stampSource(const std::string& sourcePath, SourceStamp& outStamp);
+	static uint64_t hashBytes(const void* data, size_t size);
+
+	/// Maps the cache for sourcePath if it is valid for this build and source asset.
+	/// When the size and write time match, the stored hash is trusted without reading the source.
+	/// Otherwise a non-zero stamp.contentHash is compared, so a touched but unchanged asset still hits.
+	bool open(const std::string& sourcePath, const SourceStamp& stamp);
+	void close();
+	bool isOpen() const { return file.isOpen(); }
+
+	/// Cold-load time recorded when the cache was written, for the cold-vs-warm report.
+	double getColdLoadMilliseconds() const { return coldLoadMilliseconds; }
+	size_t getMappedSize() const { return file.getSize(); }
+
+	template <typename T>
+	std::span<const T> getSection(MeshCacheSection id) const
+	{
+		std::span<const std::byte> bytes = getSectionBytes(id, sizeof(T));
+		return { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+	}
+
+	/// Writes a new cache file atomically (temp file + rename). Failures are reported but not fatal,
+	/// the next launch simply takes the cold path again.
+	static bool write(const std::string& sourcePath, const SourceStamp& stamp, double coldLoadMilliseconds,
+		std::span<const SectionData> sections);
+	/// Rewrites the source stamp in the header of an existing cache file, after a hit through the content hash,
+	/// so the next launch matches by size and write time again. The cache must not be open.
+	static bool restamp(const std::string& sourcePath, const SourceStamp& stamp);
+
+private:
+	std::span<const std::byte> getSectionBytes(MeshCacheSection id, size_t elementSize) const;
+
+	MappedFile file;
+	double coldLoadMilliseconds = 0.0;
+};
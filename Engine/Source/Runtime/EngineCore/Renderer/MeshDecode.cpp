@@ -0,0 +1,185 @@
+#include "MeshDecode.h"
+
+#include <cstring>
+
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// The vertex kernel writes each Vertex as two 16-byte halves: (pos.xyz, normal.x) and (normal.yz, texCoord)
+	static_assert(sizeof(Vertex) == 32, "MeshDecode::assembleVertices assumes a 32-byte Vertex");
+	static_assert(offsetof(Vertex, pos) == 0 && offsetof(Vertex, normal) == 12 && offsetof(Vertex, texCoord) == 24,
+		"MeshDecode::assembleVertices assumes the pos/normal/texCoord layout");
+
+	inline __m128 loadVec3(const std::byte* src, bool canOverread)
+	{
+		// A 16-byte load picks up one float past the vector; only safe while another element follows
+		if (canOverread)
+		{
+			return _mm_loadu_ps(reinterpret_cast<const float*>(src));
+		}
+		float vector[3];
+		memcpy(vector, src, sizeof(vector));
+		return _mm_setr_ps(vector[0], vector[1], vector[2], 0.0f);
+	}
+
+	inline __m128 loadTexCoord(const std::byte* src)
+	{
+		return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+	}
+}
+
+namespace MeshDecode
+{
+	void assembleVertices(const std::byte* positions, size_t positionStride,
+		const std::byte* normals, size_t normalStride,
+		const std::byte* texCoords, size_t texCoordStride,
+		size_t count, Vertex* dst)
+	{
+		const __m128 negateLower = _mm_castsi128_ps(_mm_setr_epi32(0, static_cast<int>(0x80000000u), 0, 0));
+		const __m128 negateUpper = _mm_castsi128_ps(_mm_setr_epi32(static_cast<int>(0x80000000u), 0, 0, 0));
+
+		float* out = reinterpret_cast<float*>(dst);
+		for (size_t i = 0; i < count; i++, out += 8)
+		{
+			bool canOverread = i + 1 < count;
+			__m128 position = loadVec3(positions + i * positionStride, canOverread);
+			__m128 normal = normals ? loadVec3(normals + i * normalStride, canOverread) : _mm_setzero_ps();
+			__m128 texCoord = texCoords ? loadTexCoord(texCoords + i * texCoordStride) : _mm_setzero_ps();
+
+			// (x, y, z, _) -> (x, z, y, _) -> (x, z, y, nx) -> (x, -z, y, nx)
+			__m128 swizzled = _mm_shuffle_ps(position, position, _MM_SHUFFLE(3, 1, 2, 0));
+			__m128 yyNxNx = _mm_shuffle_ps(swizzled, normal, _MM_SHUFFLE(0, 0, 2, 2));
+			__m128 lower = _mm_xor_ps(_mm_shuffle_ps(swizzled, yyNxNx, _MM_SHUFFLE(2, 0, 1, 0)), negateLower);
+
+			// (nz, ny, u, v) -> (-nz, ny, u, v), the rest of the swizzled normal (nx, -nz, ny)
+			__m128 upper = _mm_xor_ps(_mm_shuffle_ps(normal, texCoord, _MM_SHUFFLE(1, 0, 1, 2)), negateUpper);
+
+#if defined(__AVX2__)
+			_mm256_storeu_ps(out, _mm256_set_m128(upper, lower));
+#else
+			_mm_storeu_ps(out, lower);
+			_mm_storeu_ps(out + 4, upper);
+#endif
+		}
+	}
+
+	void generateNormals(std::span<const uint32_t> indices, Vertex* vertices)
+	{
+		for (uint32_t index : indices)
+		{
+			vertices[index].normal = glm::vec3(0.0f);
+		}
+
+		// Unnormalized face normals are proportional to the triangle area, which gives the weighting for free
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			Vertex& v0 = vertices[indices[i + 0]];
+			Vertex& v1 = vertices[indices[i + 1]];
+			Vertex& v2 = vertices[indices[i + 2]];
+			glm::vec3 faceNormal = glm::cross(v1.pos - v0.pos, v2.pos - v0.pos);
+			v0.normal += faceNormal;
+			v1.normal += faceNormal;
+			v2.normal += faceNormal;
+		}
+
+		for (uint32_t index : indices)
+		{
+			glm::vec3& normal = vertices[index].normal;
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normal /= length;
+			}
+		}
+	}
+
+	template <>
+	void widenIndices<uint8_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst)
+	{
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i base8 = _mm256_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+			__m256i wide = _mm256_add_epi32(_mm256_cvtepu8_epi32(packed), base8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), wide);
+		}
+#endif
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i base = _mm_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i lo16 = _mm_unpacklo_epi8(packed, zero);
+			__m128i hi16 = _mm_unpackhi_epi8(packed, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_add_epi32(_mm_unpacklo_epi16(lo16, zero), base));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(lo16, zero), base));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_add_epi32(_mm_unpacklo_epi16(hi16, zero), base));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_add_epi32(_mm_unpackhi_epi16(hi16, zero), base));
+		}
+		for (; i < count; i++)
+		{
+			dst[i] = baseVertex + static_cast<uint8_t>(src[i]);
+		}
+	}
+
+	template <>
+	void widenIndices<uint16_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst)
+	{
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i base8 = _mm256_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(uint16_t)));
+			__m256i wide = _mm256_add_epi32(_mm256_cvtepu16_epi32(packed), base8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), wide);
+		}
+#endif
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i base = _mm_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(uint16_t)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_add_epi32(_mm_unpacklo_epi16(packed, zero), base));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_add_epi32(_mm_unpackhi_epi16(packed, zero), base));
+		}
+		for (; i < count; i++)
+		{
+			uint16_t index;
+			memcpy(&index, src + i * sizeof(uint16_t), sizeof(index));
+			dst[i] = baseVertex + index;
+		}
+	}
+
+	template <>
+	void widenIndices<uint32_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst)
+	{
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i base8 = _mm256_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * sizeof(uint32_t)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi32(indices, base8));
+		}
+#endif
+		const __m128i base = _mm_set1_epi32(static_cast<int>(baseVertex));
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(uint32_t)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(indices, base));
+		}
+		for (; i < count; i++)
+		{
+			uint32_t index;
+			memcpy(&index, src + i * sizeof(uint32_t), sizeof(index));
+			dst[i] = baseVertex + index;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Vertex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Attribute decode kernels used by the glTF importer. Each kernel handles one contiguous range of a
+// primitive, so the importer can split large primitives across the job system. SSE2 is the x64
+// baseline; AVX2 paths are compiled in when the compiler targets it (/arch:AVX2, -mavx2).
+namespace MeshDecode
+{
+	/// Writes count complete vertices: glTF Y-up positions and normals swizzled to the engine's Z-up
+	/// (x, -z, y), and texture coordinates. Missing normals or texture coordinates (null) are written as zero.
+	/// Strides are in bytes, as given by the accessor's buffer view.
+	void assembleVertices(const std::byte* positions, size_t positionStride,
+		const std::byte* normals, size_t normalStride,
+		const std::byte* texCoords, size_t texCoordStride,
+		size_t count, Vertex* dst);
+
+	/// Fills in smooth, area-weighted normals for the vertices referenced by indices, for primitives that
+	/// come without a NORMAL attribute. Indices are absolute into vertices.
+	void generateNormals(std::span<const uint32_t> indices, Vertex* vertices);
+
+	/// Widens count indices of type IndexT to uint32_t and rebases them onto baseVertex.
+	/// Instantiated for uint8_t, uint16_t and uint32_t; src does not need to be aligned.
+	template <typename IndexT>
+	void widenIndices(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst);
+
+	template <> void widenIndices<uint8_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst);
+	template <> void widenIndices<uint16_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst);
+	template <> void widenIndices<uint32_t>(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst);
+
+	using WidenIndicesFunction = void (*)(const std::byte* src, size_t count, uint32_t baseVertex, uint32_t* dst);
+}
@@ -0,0 +1,43 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+
+MeshBounds MeshBounds::compute(std::span<const Vertex> vertices)
+{
+	MeshBounds bounds;
+	if (vertices.empty())
+	{
+		return bounds;
+	}
+
+	glm::vec3 minimum(vertices[0].pos), maximum(vertices[0].pos);
+	for (const Vertex& vertex : vertices)
+	{
+		minimum = glm::min(minimum, vertex.pos);
+		maximum = glm::max(maximum, vertex.pos);
+	}
+
+	bounds.center = (minimum + maximum) * 0.5f;
+	for (const Vertex& vertex : vertices)
+	{
+		bounds.radius = std::max(bounds.radius, glm::length(vertex.pos - bounds.center));
+	}
+	return bounds;
+}
+
+uint32_t selectLod(std::span<const MeshLod> lods, float distance, float pixelsPerUnit, float maxPixelError)
+{
+	// Never divide by zero when the camera is inside the bounds; LOD 0 is always acceptable there
+	distance = std::max(distance, 1e-4f);
+
+	uint32_t selected = 0;
+	for (uint32_t lod = 1; lod < lods.size(); lod++)
+	{
+		if (lods[lod].error * pixelsPerUnit / distance > maxPixelError)
+		{
+			break;
+		}
+		selected = lod;
+	}
+	return selected;
+}
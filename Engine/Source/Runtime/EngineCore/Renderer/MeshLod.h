@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Vertex.h"
+
+#include <cstdint>
+#include <span>
+
+// Length of a LOD table, LOD 0 included: the full mesh plus at most four simplified levels
+constexpr uint32_t MAX_MESH_LODS = 5;
+
+/// One level of detail: a range of the mesh's index buffer over the shared vertex buffer.
+struct MeshLod
+{
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	float error = 0.0f; // worst-case geometric deviation from LOD 0, in model units
+	uint32_t padding = 0;
+};
+
+/// Bounding sphere in model space, used to project LOD errors onto the screen.
+struct MeshBounds
+{
+	glm::vec3 center{ 0.0f };
+	float radius = 0.0f;
+
+	static MeshBounds compute(std::span<const Vertex> vertices);
+};
+
+/// Picks the coarsest LOD whose error, projected at distance, stays within maxPixelError.
+/// pixelsPerUnit is the viewport height divided by 2 * tan(fovY / 2), i.e. pixels per model unit at distance 1.
+uint32_t selectLod(std::span<const MeshLod> lods, float distance, float pixelsPerUnit, float maxPixelError);
@@ -0,0 +1,414 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	// Forsyth's scoring constants; the LRU model is a little larger than typical hardware caches
+	constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+	constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+	constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+	float vertexScore(int cachePosition, uint32_t liveTriangles)
+	{
+		if (liveTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// Vertices of the triangle just emitted; favouring them too much produces strips
+				score = FORSYTH_LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+			}
+		}
+
+		// Prefer vertices with few remaining triangles so they leave the working set early
+		score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(liveTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	// FIFO post-transform cache model shared by the statistics and the overdraw cluster split
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize)
+			: timestamps(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1)
+		{
+		}
+
+		void reset() { time += cacheSize + 1; }
+
+		/// Returns true on a miss, which also inserts the vertex
+		bool access(uint32_t vertex)
+		{
+			if (time - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = time++;
+				return true;
+			}
+			return false;
+		}
+
+	private:
+		std::vector<uint32_t> timestamps;
+		uint32_t cacheSize;
+		uint32_t time;
+	};
+
+	uint32_t triangleMisses(FifoCache& cache, const uint32_t* triangle)
+	{
+		return static_cast<uint32_t>(cache.access(triangle[0])) + cache.access(triangle[1]) + cache.access(triangle[2]);
+	}
+}
+
+namespace MeshOptimizer
+{
+	VertexCacheStatistics analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStatistics statistics;
+		if (indices.size() < 3 || vertexCount == 0)
+		{
+			return statistics;
+		}
+
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> referenced(vertexCount, false);
+		size_t transformed = 0;
+		size_t referencedCount = 0;
+		for (uint32_t index : indices)
+		{
+			transformed += cache.access(index);
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				referencedCount++;
+			}
+		}
+
+		statistics.acmr = static_cast<float>(transformed) / static_cast<float>(indices.size() / 3);
+		statistics.atvr = static_cast<float>(transformed) / static_cast<float>(referencedCount);
+		return statistics;
+	}
+
+	OptimizationReport combineReports(std::span<const OptimizationReport> reports)
+	{
+		OptimizationReport total;
+		double acmrBefore = 0.0, acmrAfter = 0.0, atvrBefore = 0.0, atvrAfter = 0.0;
+		for (const OptimizationReport& report : reports)
+		{
+			acmrBefore += double(report.before.acmr) * report.triangleCount;
+			acmrAfter += double(report.after.acmr) * report.triangleCount;
+			atvrBefore += double(report.before.atvr) * report.vertexCountBefore;
+			atvrAfter += double(report.after.atvr) * report.vertexCountAfter;
+			total.triangleCount += report.triangleCount;
+			total.vertexCountBefore += report.vertexCountBefore;
+			total.vertexCountAfter += report.vertexCountAfter;
+		}
+
+		if (total.triangleCount > 0)
+		{
+			total.before.acmr = static_cast<float>(acmrBefore / total.triangleCount);
+			total.after.acmr = static_cast<float>(acmrAfter / total.triangleCount);
+		}
+		if (total.vertexCountBefore > 0)
+		{
+			total.before.atvr = static_cast<float>(atvrBefore / total.vertexCountBefore);
+		}
+		if (total.vertexCountAfter > 0)
+		{
+			total.after.atvr = static_cast<float>(atvrAfter / total.vertexCountAfter);
+		}
+		return total;
+	}
+
+	void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Vertex -> triangle adjacency; each vertex's live triangles stay packed at the front of its range
+		std::vector<uint32_t> liveTriangles(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			liveTriangles[index]++;
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		std::inclusive_scan(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; i++)
+			{
+				adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		std::vector<int> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vertexScores[v] = vertexScore(-1, liveTriangles[v]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			triangleScores[t] = vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+
+		uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t cacheCount = 0;
+
+		size_t inputCursor = 0;
+		size_t bestTriangle = static_cast<size_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+		while (result.size() < triangleCount * 3)
+		{
+			if (bestTriangle == SIZE_MAX)
+			{
+				// Nothing in the cache has live triangles left; continue with the next unemitted triangle in input order
+				while (emitted[inputCursor])
+				{
+					inputCursor++;
+				}
+				bestTriangle = inputCursor;
+			}
+
+			const uint32_t* triangle = &indices[bestTriangle * 3];
+			result.insert(result.end(), triangle, triangle + 3);
+			emitted[bestTriangle] = true;
+			triangleScores[bestTriangle] = -1.0f;
+
+			// Emitted vertices move to the front of the LRU, the rest shift back
+			uint32_t newCacheCount = 0;
+			for (int k = 0; k < 3; k++)
+			{
+				newCache[newCacheCount++] = triangle[k];
+			}
+			for (uint32_t k = 0; k < cacheCount; k++)
+			{
+				uint32_t vertex = cache[k];
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				{
+					newCache[newCacheCount++] = vertex;
+				}
+			}
+
+			// Drop the emitted triangle from its vertices' live lists
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t vertex = triangle[k];
+				uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+				uint32_t* end = begin + liveTriangles[vertex];
+				uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+				*found = *(end - 1);
+				liveTriangles[vertex]--;
+			}
+
+			// Rescore everything whose cache position changed and pick the best neighbouring triangle
+			bestTriangle = SIZE_MAX;
+			float bestScore = 0.0f;
+			for (uint32_t k = 0; k < newCacheCount; k++)
+			{
+				uint32_t vertex = newCache[k];
+				int position = k < FORSYTH_CACHE_SIZE ? static_cast<int>(k) : -1;
+				cachePositions[vertex] = position;
+
+				float score = vertexScore(position, liveTriangles[vertex]);
+				float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t* begin = &adjacency[adjacencyOffsets[vertex]];
+				for (const uint32_t* it = begin; it != begin + liveTriangles[vertex]; ++it)
+				{
+					float& triangleScore = triangleScores[*it];
+					triangleScore += delta;
+					if (triangleScore > bestScore)
+					{
+						bestScore = triangleScore;
+						bestTriangle = *it;
+					}
+				}
+			}
+
+			cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+			std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+		}
+
+		std::copy(result.begin(), result.end(), indices.begin());
+	}
+
+	void optimizeOverdraw(std::span<uint32_t> indices, const float* positions, size_t positionStride,
+		size_t vertexCount, float threshold)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		auto position = [&](uint32_t vertex)
+		{
+			return reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + vertex * positionStride);
+		};
+
+		// Hard boundaries: triangles that miss on all three vertices start a new cache "run"
+		FifoCache cache(vertexCount, VERTEX_CACHE_SIMULATION_SIZE);
+		std::vector<size_t> hardClusters;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			if (triangleMisses(cache, &indices[t * 3]) == 3)
+			{
+				hardClusters.push_back(t);
+			}
+		}
+		if (hardClusters.empty() || hardClusters[0] != 0)
+		{
+			hardClusters.insert(hardClusters.begin(), 0);
+		}
+		hardClusters.push_back(triangleCount);
+
+		// Soft boundaries: split a run wherever restarting the cache costs no more than threshold x the run's ACMR
+		std::vector<size_t> clusters;
+		for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+		{
+			const size_t start = hardClusters[c];
+			const size_t end = hardClusters[c + 1];
+
+			cache.reset();
+			uint32_t clusterMisses = 0;
+			for (size_t t = start; t < end; t++)
+			{
+				clusterMisses += triangleMisses(cache, &indices[t * 3]);
+			}
+			const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+			clusters.push_back(start);
+			cache.reset();
+			uint32_t runMisses = 0;
+			size_t runStart = start;
+			for (size_t t = start; t < end; t++)
+			{
+				runMisses += triangleMisses(cache, &indices[t * 3]);
+				float runAcmr = static_cast<float>(runMisses) / static_cast<float>(t + 1 - runStart);
+				if (t + 1 < end && runAcmr <= clusterAcmr * threshold)
+				{
+					clusters.push_back(t + 1);
+					cache.reset();
+					runMisses = 0;
+					runStart = t + 1;
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+		const size_t clusterCount = clusters.size() - 1;
+
+		// Area-weighted mesh centroid
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+		std::vector<float> clusterKeys(clusterCount);
+		std::vector<float> clusterData(clusterCount * 7, 0.0f); // centroid * area (3), normal (3), area
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			float* data = &clusterData[c * 7];
+			for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+			{
+				const float* p0 = position(indices[t * 3 + 0]);
+				const float* p1 = position(indices[t * 3 + 1]);
+				const float* p2 = position(indices[t * 3 + 2]);
+
+				float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+				for (int k = 0; k < 3; k++)
+				{
+					data[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+					data[3 + k] += normal[k];
+				}
+				data[6] += area;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				meshCentroid[k] += data[k];
+			}
+			meshArea += data[6];
+		}
+		if (meshArea > 0.0f)
+		{
+			for (float& component : meshCentroid)
+			{
+				component /= meshArea;
+			}
+		}
+
+		// Clusters facing away from the centre (likely occluders from outside views) draw first
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			const float* data = &clusterData[c * 7];
+			float area = data[6] > 0.0f ? data[6] : 1.0f;
+			float normalLength = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+			float inverseNormal = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+			float key = 0.0f;
+			for (int k = 0; k < 3; k++)
+			{
+				key += (data[k] / area - meshCentroid[k]) * data[3 + k] * inverseNormal;
+			}
+			clusterKeys[c] = key;
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return clusterKeys[a] > clusterKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t c : order)
+		{
+			result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+		}
+		std::copy(result.begin(), result.end(), indices.begin());
+	}
+
+	size_t buildVertexFetchRemap(std::span<const uint32_t> indices, size_t vertexCount, std::vector<uint32_t>& remap)
+	{
+		remap.assign(vertexCount, ~0u);
+
+		uint32_t next = 0;
+		for (uint32_t index : indices)
+		{
+			if (remap[index] == ~0u)
+			{
+				remap[index] = next++;
+			}
+		}
+		return next;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Post-import mesh reordering for GPU efficiency. All passes keep the triangle set unchanged and only
+// reorder triangles or vertices, so their results are safe to cache with the mesh.
+namespace MeshOptimizer
+{
+	// FIFO size used when simulating the post-transform cache for statistics and cluster boundaries
+	constexpr uint32_t VERTEX_CACHE_SIMULATION_SIZE = 16;
+	// Clusters may raise ACMR by this factor in exchange for a better overdraw order
+	constexpr float OVERDRAW_CACHE_THRESHOLD = 1.05f;
+
+	struct VertexCacheStatistics
+	{
+		float acmr = 0.0f; // transformed vertices per triangle, lower is better (0.5 is the ideal for large grids)
+		float atvr = 0.0f; // transformed vertices per referenced vertex, 1.0 is ideal
+	};
+
+	struct OptimizationReport
+	{
+		VertexCacheStatistics before;
+		VertexCacheStatistics after;
+		uint32_t vertexCountBefore = 0;
+		uint32_t vertexCountAfter = 0;
+		uint32_t triangleCount = 0;
+	};
+
+	/// Merges per-submesh reports: ACMR is weighted by triangles, ATVR by vertices.
+	OptimizationReport combineReports(std::span<const OptimizationReport> reports);
+
+	VertexCacheStatistics analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount,
+		uint32_t cacheSize = VERTEX_CACHE_SIMULATION_SIZE);
+
+	/// Reorders triangles for post-transform cache hits (Forsyth's linear-speed vertex cache optimizer).
+	void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+	/// Reorders clusters of a cache-optimized index buffer so outward-facing clusters draw first
+	/// (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+	/// positions points at the first vertex's xyz floats, positionStride is the vertex size in bytes.
+	void optimizeOverdraw(std::span<uint32_t> indices, const float* positions, size_t positionStride,
+		size_t vertexCount, float threshold = OVERDRAW_CACHE_THRESHOLD);
+
+	/// Builds a table that renumbers vertices in order of first use. Unreferenced vertices map to ~0u.
+	/// Returns the number of referenced vertices.
+	size_t buildVertexFetchRemap(std::span<const uint32_t> indices, size_t vertexCount, std::vector<uint32_t>& remap);
+
+	/// Renumbers vertices in order of first use so vertex fetch walks memory linearly.
+	/// Unreferenced vertices are dropped.
+	template <typename VertexT>
+	void optimizeVertexFetch(std::span<uint32_t> indices, std::vector<VertexT>& vertices)
+	{
+		std::vector<uint32_t> remap;
+		size_t usedVertexCount = buildVertexFetchRemap(indices, vertices.size(), remap);
+
+		std::vector<VertexT> reordered(usedVertexCount);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			if (remap[i] != ~0u)
+			{
+				reordered[remap[i]] = vertices[i];
+			}
+		}
+		for (uint32_t& index : indices)
+		{
+			index = remap[index];
+		}
+		vertices = std::move(reordered);
+	}
+
+	/// Runs the vertex cache, overdraw and vertex fetch passes in order and reports ACMR/ATVR before and after.
+	/// VertexT must start with its position as three floats.
+	template <typename VertexT>
+	OptimizationReport optimizeMesh(std::span<uint32_t> indices, std::vector<VertexT>& vertices)
+	{
+		OptimizationReport report;
+		report.vertexCountBefore = static_cast<uint32_t>(vertices.size());
+		report.triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		report.before = analyzeVertexCache(indices, vertices.size());
+
+		optimizeVertexCache(indices, vertices.size());
+		optimizeOverdraw(indices, reinterpret_cast<const float*>(vertices.data()), sizeof(VertexT), vertices.size());
+		optimizeVertexFetch(indices, vertices);
+
+		report.vertexCountAfter = static_cast<uint32_t>(vertices.size());
+		report.after = analyzeVertexCache(indices, vertices.size());
+		return report;
+	}
+}
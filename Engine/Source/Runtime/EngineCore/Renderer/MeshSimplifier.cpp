@@ -0,0 +1,349 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+	constexpr int MAX_SIMPLIFY_PASSES = 64;
+
+	/// Symmetric 4x4 plane quadric plus the accumulated area weight, in double for stability on large meshes
+	struct Quadric
+	{
+		double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+		double a11 = 0, a12 = 0, a13 = 0;
+		double a22 = 0, a23 = 0;
+		double a33 = 0;
+		double weight = 0;
+
+		static Quadric fromPlane(const glm::vec3& normal, float distance, double weight)
+		{
+			double a = normal.x, b = normal.y, c = normal.z, d = distance;
+			Quadric q;
+			q.a00 = a * a * weight; q.a01 = a * b * weight; q.a02 = a * c * weight; q.a03 = a * d * weight;
+			q.a11 = b * b * weight; q.a12 = b * c * weight; q.a13 = b * d * weight;
+			q.a22 = c * c * weight; q.a23 = c * d * weight;
+			q.a33 = d * d * weight;
+			q.weight = weight;
+			return q;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+			a11 += other.a11; a12 += other.a12; a13 += other.a13;
+			a22 += other.a22; a23 += other.a23;
+			a33 += other.a33;
+			weight += other.weight;
+			return *this;
+		}
+
+		/// Area-weighted mean squared distance of p to the accumulated planes
+		double evaluate(const glm::vec3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			double value = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+				+ a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+				+ a22 * z * z + 2 * a23 * z
+				+ a33;
+			return weight > 0 ? std::max(value, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	uint64_t edgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+	}
+
+	/// Marks vertices that must not move: seams (position shared by several vertices) and the endpoints
+	/// of open or non-manifold edges, both judged on position-welded topology
+	std::vector<bool> findLockedVertices(std::span<const uint32_t> indices, const std::vector<glm::vec3>& positions)
+	{
+		const size_t vertexCount = positions.size();
+
+		struct PositionHash
+		{
+			size_t operator()(const glm::vec3& p) const
+			{
+				// Adding zero folds -0 into +0, which compare equal and must hash equally
+				float components[3] = { p.x + 0.0f, p.y + 0.0f, p.z + 0.0f };
+				uint32_t bits[3];
+				memcpy(bits, components, sizeof(bits));
+				return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+			}
+		};
+
+		std::unordered_map<glm::vec3, uint32_t, PositionHash> firstVertexAt;
+		firstVertexAt.reserve(vertexCount);
+		std::vector<uint32_t> welded(vertexCount);
+		std::vector<uint32_t> wedgeCount(vertexCount, 0);
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			welded[v] = firstVertexAt.try_emplace(positions[v], v).first->second;
+			wedgeCount[welded[v]]++;
+		}
+
+		std::vector<bool> locked(vertexCount, false);
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			locked[v] = wedgeCount[welded[v]] > 1;
+		}
+
+		std::unordered_map<uint64_t, uint32_t> edgeUses;
+		edgeUses.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				edgeUses[edgeKey(welded[indices[i + k]], welded[indices[i + (k + 1) % 3]])]++;
+			}
+		}
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = indices[i + k];
+				uint32_t b = indices[i + (k + 1) % 3];
+				if (edgeUses[edgeKey(welded[a], welded[b])] != 2)
+				{
+					locked[a] = true;
+					locked[b] = true;
+				}
+			}
+		}
+		return locked;
+	}
+
+	glm::vec3 triangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+	{
+		return glm::cross(p1 - p0, p2 - p0);
+	}
+}
+
+namespace MeshSimplifier
+{
+	std::vector<uint32_t> simplify(std::span<const uint32_t> indices, const float* positions, size_t positionStride,
+		size_t vertexCount, size_t targetIndexCount, float maxError, float* outError)
+	{
+		std::vector<uint32_t> result(indices.begin(), indices.end());
+		if (outError)
+		{
+			*outError = 0.0f;
+		}
+
+		std::vector<glm::vec3> points(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			const float* p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + v * positionStride);
+			points[v] = glm::vec3(p[0], p[1], p[2]);
+		}
+
+		const std::vector<bool> locked = findLockedVertices(indices, points);
+
+		// Every vertex starts with the planes of its triangles, weighted by area
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			glm::vec3 normal = triangleNormal(points[result[i]], points[result[i + 1]], points[result[i + 2]]);
+			float doubleArea = glm::length(normal);
+			if (doubleArea <= 0.0f)
+			{
+				continue;
+			}
+			normal = normal * (1.0f / doubleArea);
+			Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, points[result[i]]), doubleArea * 0.5);
+			for (int k = 0; k < 3; k++)
+			{
+				quadrics[result[i + k]] += plane;
+			}
+		}
+
+		const double maxCost = double(maxError) * double(maxError);
+		double worstCost = 0.0;
+
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+		std::vector<uint32_t> adjacency;
+
+		for (int pass = 0; pass < MAX_SIMPLIFY_PASSES && result.size() > targetIndexCount; pass++)
+		{
+			const size_t triangleCount = result.size() / 3;
+
+			// Vertex -> triangle adjacency of the current mesh, for the flip test
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+			for (uint32_t index : result)
+			{
+				adjacencyOffsets[index + 1]++;
+			}
+			std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+			adjacency.resize(result.size());
+			{
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); i++)
+				{
+					adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// Candidate collapses along every edge, in both directions where the source may move
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t a = result[i + k];
+					uint32_t b = result[i + (k + 1) % 3];
+					if (!locked[a])
+					{
+						Quadric combined = quadrics[a];
+						combined += quadrics[b];
+						collapses.push_back({ a, b, combined.evaluate(points[b]) });
+					}
+					if (!locked[b])
+					{
+						Quadric combined = quadrics[b];
+						combined += quadrics[a];
+						collapses.push_back({ b, a, combined.evaluate(points[a]) });
+					}
+				}
+			}
+
+			order.resize(collapses.size());
+			std::iota(order.begin(), order.end(), 0u);
+			std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) { return collapses[x].cost < collapses[y].cost; });
+
+			std::iota(remap.begin(), remap.end(), 0u);
+			std::fill(touched.begin(), touched.end(), false);
+
+			const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+			size_t trianglesRemoved = 0;
+			size_t collapseCount = 0;
+
+			for (uint32_t c : order)
+			{
+				const Collapse& collapse = collapses[c];
+				if (collapse.cost > maxCost || trianglesRemoved >= trianglesToRemove)
+				{
+					break;
+				}
+				if (touched[collapse.from] || touched[collapse.to])
+				{
+					continue;
+				}
+
+				// Reject collapses that flip or degenerate any surviving triangle around the source
+				bool valid = true;
+				size_t removed = 0;
+				for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && valid; a++)
+				{
+					const uint32_t* triangle = &result[adjacency[a] * 3];
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+					{
+						removed++;
+						continue;
+					}
+
+					glm::vec3 before[3], after[3];
+					for (int k = 0; k < 3; k++)
+					{
+						before[k] = points[triangle[k]];
+						after[k] = triangle[k] == collapse.from ? points[collapse.to] : before[k];
+					}
+					glm::vec3 normalBefore = triangleNormal(before[0], before[1], before[2]);
+					glm::vec3 normalAfter = triangleNormal(after[0], after[1], after[2]);
+					valid = glm::dot(normalBefore, normalAfter) > 0.25f * glm::length(normalBefore) * glm::length(normalAfter);
+				}
+				if (!valid || removed == 0)
+				{
+					continue;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				worstCost = std::max(worstCost, collapse.cost);
+				trianglesRemoved += removed;
+				collapseCount++;
+
+				// Freeze the neighbourhood so later flip tests in this pass see final positions
+				for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+				{
+					const uint32_t* triangle = &result[adjacency[a] * 3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+				}
+				touched[collapse.to] = true;
+			}
+
+			if (collapseCount == 0)
+			{
+				break;
+			}
+
+			size_t write = 0;
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				uint32_t a = remap[result[t * 3 + 0]];
+				uint32_t b = remap[result[t * 3 + 1]];
+				uint32_t c = remap[result[t * 3 + 2]];
+				if (a != b && b != c && c != a)
+				{
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+			}
+			result.resize(write);
+		}
+
+		if (outError)
+		{
+			*outError = static_cast<float>(std::sqrt(worstCost));
+		}
+		return result;
+	}
+
+	std::vector<MeshLod> buildLodChain(std::vector<uint32_t>& indices, const float* positions, size_t positionStride,
+		size_t vertexCount, float meshRadius)
+	{
+		std::vector<MeshLod> lods;
+		lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+		const float maxError = LOD_MAX_RELATIVE_ERROR * meshRadius;
+		while (lods.size() < MAX_MESH_LODS)
+		{
+			const MeshLod& previous = lods.back();
+			std::span<const uint32_t> source(indices.data() + previous.firstIndex, previous.indexCount);
+
+			size_t target = static_cast<size_t>(previous.indexCount * LOD_REDUCTION) / 3 * 3;
+			float error = 0.0f;
+			std::vector<uint32_t> simplified = simplify(source, positions, positionStride, vertexCount, target, maxError, &error);
+			if (simplified.empty() || simplified.size() > previous.indexCount * LOD_MIN_REDUCTION)
+			{
+				break;
+			}
+
+			MeshOptimizer::optimizeVertexCache(simplified, vertexCount);
+
+			MeshLod lod;
+			lod.firstIndex = static_cast<uint32_t>(indices.size());
+			lod.indexCount = static_cast<uint32_t>(simplified.size());
+			lod.error = previous.error + error;
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+			lods.push_back(lod);
+		}
+		return lods;
+	}
+}
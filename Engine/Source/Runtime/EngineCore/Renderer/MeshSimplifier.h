@@ -0,0 +1,32 @@
+#pragma once
+
+#include "MeshLod.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Import-time mesh simplification. Edges are collapsed onto one of their existing endpoints, so every
+// LOD is just another index buffer over the original vertex buffer.
+namespace MeshSimplifier
+{
+	// Each LOD aims for this fraction of the previous LOD's triangles
+	constexpr float LOD_REDUCTION = 0.5f;
+	// A LOD is dropped when simplification stalls above this fraction of the previous LOD
+	constexpr float LOD_MIN_REDUCTION = 0.85f;
+	// Error bound per LOD step, relative to the mesh's bounding radius
+	constexpr float LOD_MAX_RELATIVE_ERROR = 0.02f;
+
+	/// Quadric error metric simplification (Garland and Heckbert) towards targetIndexCount.
+	/// Collapses stop at maxError (model units), so the result may stay above the target. Vertices on open
+	/// borders, UV/normal seams (several vertices sharing one position) and non-manifold edges never move.
+	/// outError receives the largest error of any collapse performed.
+	std::vector<uint32_t> simplify(std::span<const uint32_t> indices, const float* positions, size_t positionStride,
+		size_t vertexCount, size_t targetIndexCount, float maxError, float* outError = nullptr);
+
+	/// Simplifies indices[0, lod0IndexCount) repeatedly and appends every useful LOD to indices, each one
+	/// vertex-cache optimized. Returns the LOD table, LOD 0 included; errors accumulate across steps.
+	std::vector<MeshLod> buildLodChain(std::vector<uint32_t>& indices, const float* positions, size_t positionStride,
+		size_t vertexCount, float meshRadius);
+}
@@ -0,0 +1,266 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace
+{
+	constexpr uint32_t DOWNSAMPLE_GROUP_SIZE = 8;
+
+	void recordMipBarrier(vk::raii::CommandBuffer& commandBuffer, vk::Image image, uint32_t baseLevel, uint32_t levelCount,
+		vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+		vk::PipelineStageFlags2 srcStage, vk::AccessFlags2 srcAccess, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+	{
+		vk::ImageMemoryBarrier2 barrier;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { vk::ImageAspectFlagBits::eColor, baseLevel, levelCount, 0, 1 };
+
+		vk::DependencyInfo dependencyInfo;
+		dependencyInfo.imageMemoryBarrierCount = 1;
+		dependencyInfo.pImageMemoryBarriers = &barrier;
+		commandBuffer.pipelineBarrier2(dependencyInfo);
+	}
+}
+
+uint32_t MipGenerator::getMipLevelCount(uint32_t width, uint32_t height)
+{
+	return static_cast<uint32_t>(std::bit_width(std::max({ width, height, 1u })));
+}
+
+const char* MipGenerator::getMethodName(Method method)
+{
+	switch (method)
+	{
+	case Method::Blit:
+		return "blit";
+	case Method::Compute:
+		return "compute";
+	default:
+		return "none";
+	}
+}
+
+vk::ImageUsageFlags MipGenerator::getRequiredUsage(Method method)
+{
+	switch (method)
+	{
+	case Method::Blit:
+		return vk::ImageUsageFlagBits::eTransferSrc;
+	case Method::Compute:
+		return vk::ImageUsageFlagBits::eStorage;
+	default:
+		return {};
+	}
+}
+
+void MipGenerator::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& inPhysicalDevice, const std::vector<char>& computeShaderCode)
+{
+	device = &inDevice;
+	physicalDevice = &inPhysicalDevice;
+
+	// The shader writes through an image without a format qualifier so one pipeline serves every format
+	storageWriteWithoutFormat = physicalDevice->getFeatures().shaderStorageImageWriteWithoutFormat;
+	if (!storageWriteWithoutFormat || computeShaderCode.empty())
+	{
+		return;
+	}
+
+	vk::SamplerCreateInfo samplerInfo;
+	samplerInfo.magFilter = vk::Filter::eNearest;
+	samplerInfo.minFilter = vk::Filter::eNearest;
+	samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+	samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+	samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+	samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+	sampler = vk::raii::Sampler(*device, samplerInfo);
+
+	std::array bindings = {
+		vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+		vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
+	};
+	vk::DescriptorSetLayoutCreateInfo layoutInfo({}, bindings.size(), bindings.data());
+	descriptorSetLayout = vk::raii::DescriptorSetLayout(*device, layoutInfo);
+
+	vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &*descriptorSetLayout;
+	pipelineLayout = vk::raii::PipelineLayout(*device, pipelineLayoutInfo);
+
+	vk::ShaderModuleCreateInfo shaderInfo;
+	shaderInfo.codeSize = computeShaderCode.size();
+	shaderInfo.pCode = reinterpret_cast<const uint32_t*>(computeShaderCode.data());
+	vk::raii::ShaderModule shaderModule(*device, shaderInfo);
+
+	vk::PipelineShaderStageCreateInfo stageInfo;
+	stageInfo.stage = vk::ShaderStageFlagBits::eCompute;
+	stageInfo.module = shaderModule;
+	stageInfo.pName = "main";
+
+	vk::ComputePipelineCreateInfo pipelineInfo;
+	pipelineInfo.stage = stageInfo;
+	pipelineInfo.layout = pipelineLayout;
+	pipeline = vk::raii::Pipeline(*device, nullptr, pipelineInfo);
+}
+
+void MipGenerator::destroy()
+{
+	pipeline = nullptr;
+	pipelineLayout = nullptr;
+	descriptorSetLayout = nullptr;
+	sampler = nullptr;
+}
+
+MipGenerator::Method MipGenerator::getMethod(vk::Format format) const
+{
+	vk::FormatFeatureFlags features = physicalDevice->getFormatProperties(format).optimalTilingFeatures;
+
+	vk::FormatFeatureFlags blitFeatures = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+	if ((features & blitFeatures) == blitFeatures)
+	{
+		return Method::Blit;
+	}
+
+	vk::FormatFeatureFlags computeFeatures = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eStorageImage;
+	if (*pipeline && (features & computeFeatures) == computeFeatures)
+	{
+		return Method::Compute;
+	}
+
+	return Method::None;
+}
+
+MipGenerator::Resources MipGenerator::record(vk::raii::CommandBuffer& commandBuffer, vk::Image image, vk::Format format, uint32_t width, uint32_t height,
+	uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	switch (getMethod(format))
+	{
+	case Method::Blit:
+		recordBlit(commandBuffer, image, width, height, mipLevels, finalLayout, dstStage, dstAccess);
+		return {};
+	case Method::Compute:
+		return recordCompute(commandBuffer, image, format, width, height, mipLevels, finalLayout, dstStage, dstAccess);
+	default:
+		// Nothing to generate from; still hand the image over in the layout the caller expects
+		recordMipBarrier(commandBuffer, image, 0, mipLevels, vk::ImageLayout::eTransferDstOptimal, finalLayout,
+			vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, dstStage, dstAccess);
+		return {};
+	}
+}
+
+void MipGenerator::recordBlit(vk::raii::CommandBuffer& commandBuffer, vk::Image image, uint32_t width, uint32_t height,
+	uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	int32_t mipWidth = static_cast<int32_t>(width);
+	int32_t mipHeight = static_cast<int32_t>(height);
+
+	for (uint32_t level = 1; level < mipLevels; level++)
+	{
+		// The previous level was just written (by the upload copy or the last blit) and becomes the source
+		recordMipBarrier(commandBuffer, image, level - 1, 1, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal,
+			vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+			vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead);
+
+		int32_t nextWidth = std::max(mipWidth / 2, 1);
+		int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+		vk::ImageBlit blit;
+		blit.srcSubresource = { vk::ImageAspectFlagBits::eColor, level - 1, 0, 1 };
+		blit.srcOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+		blit.srcOffsets[1] = vk::Offset3D{ mipWidth, mipHeight, 1 };
+		blit.dstSubresource = { vk::ImageAspectFlagBits::eColor, level, 0, 1 };
+		blit.dstOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+		blit.dstOffsets[1] = vk::Offset3D{ nextWidth, nextHeight, 1 };
+		commandBuffer.blitImage(image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+
+		recordMipBarrier(commandBuffer, image, level - 1, 1, vk::ImageLayout::eTransferSrcOptimal, finalLayout,
+			vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead, dstStage, dstAccess);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	recordMipBarrier(commandBuffer, image, mipLevels - 1, 1, vk::ImageLayout::eTransferDstOptimal, finalLayout,
+		vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, dstStage, dstAccess);
+}
+
+MipGenerator::Resources MipGenerator::recordCompute(vk::raii::CommandBuffer& commandBuffer, vk::Image image, vk::Format format, uint32_t width, uint32_t height,
+	uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	Resources resources;
+
+	recordMipBarrier(commandBuffer, image, 0, mipLevels, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eGeneral,
+		vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+		vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageWrite);
+
+	if (mipLevels > 1)
+	{
+		const uint32_t stepCount = mipLevels - 1;
+		std::array poolSizes{
+			vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, stepCount),
+			vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, stepCount)
+		};
+		vk::DescriptorPoolCreateInfo poolInfo;
+		poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
+		poolInfo.maxSets = stepCount;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		resources.descriptorPool = vk::raii::DescriptorPool(*device, poolInfo);
+
+		std::vector<vk::DescriptorSetLayout> layouts(stepCount, *descriptorSetLayout);
+		vk::DescriptorSetAllocateInfo allocInfo;
+		allocInfo.descriptorPool = *resources.descriptorPool;
+		allocInfo.descriptorSetCount = stepCount;
+		allocInfo.pSetLayouts = layouts.data();
+		resources.descriptorSets = device->allocateDescriptorSets(allocInfo);
+
+		for (uint32_t level = 0; level < mipLevels; level++)
+		{
+			vk::ImageViewCreateInfo viewInfo;
+			viewInfo.image = image;
+			viewInfo.viewType = vk::ImageViewType::e2D;
+			viewInfo.format = format;
+			viewInfo.subresourceRange = { vk::ImageAspectFlagBits::eColor, level, 1, 0, 1 };
+			resources.views.emplace_back(*device, viewInfo);
+		}
+	}
+
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+	for (uint32_t level = 1; level < mipLevels; level++)
+	{
+		vk::raii::DescriptorSet& descriptorSet = resources.descriptorSets[level - 1];
+
+		vk::DescriptorImageInfo sourceInfo(*sampler, *resources.views[level - 1], vk::ImageLayout::eGeneral);
+		vk::DescriptorImageInfo destinationInfo(nullptr, *resources.views[level], vk::ImageLayout::eGeneral);
+		std::array writes{
+			vk::WriteDescriptorSet(*descriptorSet, 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &sourceInfo),
+			vk::WriteDescriptorSet(*descriptorSet, 1, 0, 1, vk::DescriptorType::eStorageImage, &destinationInfo)
+		};
+		device->updateDescriptorSets(writes, {});
+
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *descriptorSet, nullptr);
+
+		uint32_t levelWidth = std::max(width >> level, 1u);
+		uint32_t levelHeight = std::max(height >> level, 1u);
+		commandBuffer.dispatch((levelWidth + DOWNSAMPLE_GROUP_SIZE - 1) / DOWNSAMPLE_GROUP_SIZE, (levelHeight + DOWNSAMPLE_GROUP_SIZE - 1) / DOWNSAMPLE_GROUP_SIZE, 1);
+
+		// The level just written is read by the next step
+		recordMipBarrier(commandBuffer, image, level, 1, vk::ImageLayout::eGeneral, vk::ImageLayout::eGeneral,
+			vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite,
+			vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderSampledRead);
+	}
+
+	recordMipBarrier(commandBuffer, image, 0, mipLevels, vk::ImageLayout::eGeneral, finalLayout,
+		vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageWrite,
+		dstStage, dstAccess);
+
+	return resources;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// Fills the mip chain of a 2D color image on the GPU from its level 0. Formats with linear-filtered
+/// blit support use a vkCmdBlitImage chain; other formats that allow storage writes fall back to a 2x2
+/// box-filter compute shader. Recording needs a queue with graphics (blit) or compute support.
+class MipGenerator
+{
+public:
+	enum class Method
+	{
+		None, // the format supports neither path; upload mips from the asset instead
+		Blit,
+		Compute,
+	};
+
+	/// Descriptor pool and per-mip views used by a compute recording; keep alive until the GPU finished it
+	struct Resources
+	{
+		vk::raii::DescriptorPool descriptorPool{ nullptr };
+		std::vector<vk::raii::DescriptorSet> descriptorSets;
+		std::vector<vk::raii::ImageView> views;
+	};
+
+	static uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+	static const char* getMethodName(Method method);
+	/// Usage flags the image needs on top of eTransferDst | eSampled for the given method
+	static vk::ImageUsageFlags getRequiredUsage(Method method);
+
+	/// computeShaderCode is the SPIR-V of MipDownsample_Comp.glsl; without it only the blit path is available.
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, const std::vector<char>& computeShaderCode);
+	void destroy();
+
+	Method getMethod(vk::Format format) const;
+
+	/// Expects every mip level in eTransferDstOptimal, level 0 written by transfer and its writes made
+	/// available to this command buffer. Leaves all levels in finalLayout, visible to dstStage/dstAccess.
+	Resources record(vk::raii::CommandBuffer& commandBuffer, vk::Image image, vk::Format format, uint32_t width, uint32_t height,
+		uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+
+private:
+	void recordBlit(vk::raii::CommandBuffer& commandBuffer, vk::Image image, uint32_t width, uint32_t height,
+		uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+	Resources recordCompute(vk::raii::CommandBuffer& commandBuffer, vk::Image image, vk::Format format, uint32_t width, uint32_t height,
+		uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+
+	vk::raii::Device* device = nullptr;
+	vk::raii::PhysicalDevice* physicalDevice = nullptr;
+	bool storageWriteWithoutFormat = false;
+
+	vk::raii::Sampler sampler{ nullptr };
+	vk::raii::DescriptorSetLayout descriptorSetLayout{ nullptr };
+	vk::raii::PipelineLayout pipelineLayout{ nullptr };
+	vk::raii::Pipeline pipeline{ nullptr };
+};
@@ -0,0 +1,105 @@
+#include "ParallelCommandRecorder.h"
+
+#include "Runtime/EngineCore/JobSystem.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void ParallelCommandRecorder::init(vk::raii::Device& inDevice, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t frameSlots)
+{
+	device = &inDevice;
+	frameSlot = 0;
+
+	// Buffers are never reset one by one, only with their whole pool
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+	poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+	threads = std::vector<ThreadState>(std::max(threadCount, 1u));
+	for (ThreadState& thread : threads)
+	{
+		thread.slots = std::vector<SlotPool>(frameSlots);
+		for (SlotPool& slot : thread.slots)
+		{
+			slot.pool = vk::raii::CommandPool(*device, poolInfo);
+		}
+	}
+}
+
+void ParallelCommandRecorder::destroy()
+{
+	// Buffers go before the pools they came from
+	for (ThreadState& thread : threads)
+	{
+		for (SlotPool& slot : thread.slots)
+		{
+			slot.commandBuffers.clear();
+		}
+	}
+	threads.clear();
+	device = nullptr;
+}
+
+void ParallelCommandRecorder::beginFrame(uint32_t inFrameSlot)
+{
+	frameSlot = inFrameSlot;
+	for (ThreadState& thread : threads)
+	{
+		SlotPool& slot = thread.slots[frameSlot];
+		if (slot.usedCommandBuffers > 0)
+		{
+			slot.pool.reset();
+			slot.usedCommandBuffers = 0;
+		}
+
+		double peakRecordMilliseconds = std::max(thread.lastFrame.peakRecordMilliseconds, thread.frame.recordMilliseconds);
+		thread.lastFrame = thread.frame;
+		thread.lastFrame.peakRecordMilliseconds = peakRecordMilliseconds;
+		thread.frame = {};
+	}
+}
+
+vk::raii::CommandBuffer& ParallelCommandRecorder::acquire()
+{
+	uint32_t threadIndex = JobSystem::getThreadIndex();
+	if (threadIndex >= threads.size())
+	{
+		throw std::runtime_error("command recording thread has no command pool!");
+	}
+
+	SlotPool& slot = threads[threadIndex].slots[frameSlot];
+	if (slot.usedCommandBuffers == slot.commandBuffers.size())
+	{
+		vk::CommandBufferAllocateInfo allocInfo;
+		allocInfo.commandPool = *slot.pool;
+		allocInfo.level = vk::CommandBufferLevel::eSecondary;
+		allocInfo.commandBufferCount = 1;
+		vk::raii::CommandBuffers allocated(*device, allocInfo);
+		slot.commandBuffers.push_back(std::move(allocated.front()));
+	}
+
+	threads[threadIndex].frame.commandBuffers++;
+	return slot.commandBuffers[slot.usedCommandBuffers++];
+}
+
+void ParallelCommandRecorder::addRecording(double milliseconds, uint32_t draws)
+{
+	ThreadStatistics& statistics = threads[JobSystem::getThreadIndex()].frame;
+	statistics.recordMilliseconds += milliseconds;
+	statistics.draws += draws;
+}
+
+ParallelCommandRecorder::Statistics ParallelCommandRecorder::getStatistics() const
+{
+	Statistics statistics;
+	statistics.threads.reserve(threads.size());
+	for (const ThreadState& thread : threads)
+	{
+		statistics.threads.push_back(thread.lastFrame);
+		for (const SlotPool& slot : thread.slots)
+		{
+			statistics.allocatedCommandBuffers += static_cast<uint32_t>(slot.commandBuffers.size());
+		}
+	}
+	return statistics;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// Secondary command buffers for recording on job system workers. Every thread (JobSystem::getThreadIndex())
+/// has its own command pool per frame slot, so allocation and recording never take a lock: a pool is only used
+/// by its thread, and only while the slot's frame is recorded. beginFrame() resets all pools of the slot at once
+/// after the frame that last used it completed; their buffers are kept and handed out again.
+class ParallelCommandRecorder
+{
+public:
+	struct ThreadStatistics
+	{
+		uint32_t commandBuffers = 0; // recorded in the last finished frame
+		uint32_t draws = 0;
+		double recordMilliseconds = 0.0;
+		double peakRecordMilliseconds = 0.0;
+	};
+
+	struct Statistics
+	{
+		std::vector<ThreadStatistics> threads; // indexed by JobSystem::getThreadIndex()
+		uint32_t allocatedCommandBuffers = 0;
+	};
+
+	ParallelCommandRecorder() = default;
+	~ParallelCommandRecorder() = default;
+
+	ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+	ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+	/// threadCount covers the calling thread and every worker: JobSystem::getWorkerCount() + 1
+	void init(vk::raii::Device& device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t frameSlots);
+	void destroy();
+
+	/// Render thread, before any recording of the frame: the frame that last used frameSlot has completed
+	void beginFrame(uint32_t frameSlot);
+
+	/// Calling thread: a secondary buffer from its own pool, not yet begun, valid until the slot comes around again
+	vk::raii::CommandBuffer& acquire();
+	/// Calling thread: adds a finished recording to its statistics
+	void addRecording(double milliseconds, uint32_t draws);
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(threads.size()); }
+	Statistics getStatistics() const;
+
+private:
+	struct SlotPool
+	{
+		vk::raii::CommandPool pool{ nullptr };
+		std::vector<vk::raii::CommandBuffer> commandBuffers;
+		uint32_t usedCommandBuffers = 0;
+	};
+
+	// Written by one thread at a time; aligned so neighbouring threads do not share a cache line
+	struct alignas(64) ThreadState
+	{
+		std::vector<SlotPool> slots;
+		ThreadStatistics frame;
+		ThreadStatistics lastFrame;
+	};
+
+	vk::raii::Device* device = nullptr;
+	std::vector<ThreadState> threads;
+	uint32_t frameSlot = 0;
+};
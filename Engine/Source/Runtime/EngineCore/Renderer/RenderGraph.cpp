@@ -0,0 +1,495 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	constexpr vk::AccessFlags2 WRITE_ACCESS = vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eDepthStencilAttachmentWrite |
+		vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eTransferWrite |
+		vk::AccessFlagBits2::eMemoryWrite;
+}
+
+RenderGraph::State RenderGraph::getUsageState(Usage usage)
+{
+	switch (usage)
+	{
+	case Usage::ColorAttachmentWrite:
+		return { vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+			vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite, vk::ImageLayout::eColorAttachmentOptimal };
+	case Usage::DepthAttachmentWrite:
+		return { vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests,
+			vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite, vk::ImageLayout::eDepthAttachmentOptimal };
+	case Usage::DepthAttachmentRead:
+		return { vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests,
+			vk::AccessFlagBits2::eDepthStencilAttachmentRead, vk::ImageLayout::eDepthReadOnlyOptimal };
+	case Usage::FragmentSampled:
+		return { vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead, vk::ImageLayout::eShaderReadOnlyOptimal };
+	case Usage::FragmentStorageRead:
+		return { vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderStorageRead, vk::ImageLayout::eGeneral };
+	case Usage::ComputeStorageRead:
+		return { vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead, vk::ImageLayout::eGeneral };
+	case Usage::ComputeStorageWrite:
+		return { vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite, vk::ImageLayout::eGeneral };
+	case Usage::Present:
+		return { vk::PipelineStageFlagBits2::eBottomOfPipe, {}, vk::ImageLayout::ePresentSrcKHR };
+	default:
+		throw std::runtime_error("unknown render graph usage!");
+	}
+}
+
+const char* RenderGraph::getUsageName(Usage usage)
+{
+	switch (usage)
+	{
+	case Usage::ColorAttachmentWrite: return "color attachment";
+	case Usage::DepthAttachmentWrite: return "depth attachment";
+	case Usage::DepthAttachmentRead: return "depth read";
+	case Usage::FragmentSampled: return "fragment sampled";
+	case Usage::FragmentStorageRead: return "fragment storage read";
+	case Usage::ComputeStorageRead: return "compute storage read";
+	case Usage::ComputeStorageWrite: return "compute storage write";
+	case Usage::Present: return "present";
+	default: return "unknown";
+	}
+}
+
+void RenderGraph::reset()
+{
+	passes.clear();
+	resources.clear();
+	executionOrder.clear();
+	exportImageBarriers.clear();
+	exportBufferBarriers.clear();
+	statistics = {};
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(const char* name, vk::Image image, vk::ImageAspectFlags aspect, const State& initialState)
+{
+	Resource& resource = resources.emplace_back();
+	resource.name = name;
+	resource.image = image;
+	resource.aspect = aspect;
+	resource.initialState = initialState;
+	resource.finalState = initialState;
+	return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importBuffer(const char* name, vk::Buffer buffer, const State& initialState)
+{
+	Resource& resource = resources.emplace_back();
+	resource.name = name;
+	resource.buffer = buffer;
+	resource.initialState = initialState;
+	resource.finalState = initialState;
+	return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+void RenderGraph::exportResource(ResourceHandle resource, Usage usage)
+{
+	resources[resource].exportUsage = usage;
+}
+
+RenderGraph::PassHandle RenderGraph::addPass(const char* name, RecordFunction record)
+{
+	Pass& pass = passes.emplace_back();
+	pass.name = name;
+	pass.record = std::move(record);
+	return static_cast<PassHandle>(passes.size() - 1);
+}
+
+void RenderGraph::read(PassHandle pass, ResourceHandle resource, Usage usage)
+{
+	passes[pass].uses.push_back({ resource, usage, false, false });
+}
+
+void RenderGraph::write(PassHandle pass, ResourceHandle resource, Usage usage, bool discard)
+{
+	passes[pass].uses.push_back({ resource, usage, true, discard });
+}
+
+void RenderGraph::setSideEffects(PassHandle pass)
+{
+	passes[pass].sideEffects = true;
+}
+
+void RenderGraph::compile()
+{
+	// One barrier per resource and pass keeps every batch valid
+	for (const Pass& pass : passes)
+	{
+		for (size_t i = 0; i < pass.uses.size(); i++)
+		{
+			for (size_t j = i + 1; j < pass.uses.size(); j++)
+			{
+				if (pass.uses[i].resource == pass.uses[j].resource)
+				{
+					throw std::runtime_error("render graph pass uses a resource twice!");
+				}
+			}
+		}
+	}
+
+	cullPasses();
+	orderPasses();
+
+	std::vector<Tracker> trackers(resources.size());
+	for (size_t index = 0; index < resources.size(); index++)
+	{
+		const State& state = resources[index].initialState;
+		Tracker& tracker = trackers[index];
+		if (state.access & WRITE_ACCESS)
+		{
+			tracker.writeStages = state.stages;
+			tracker.writeAccess = state.access;
+		}
+		else
+		{
+			tracker.readStages = state.stages;
+		}
+		tracker.layout = state.layout;
+	}
+
+	for (PassHandle passIndex : executionOrder)
+	{
+		Pass& pass = passes[passIndex];
+		pass.imageBarriers.clear();
+		pass.bufferBarriers.clear();
+		for (const Use& use : pass.uses)
+		{
+			addBarrier(resources[use.resource], trackers[use.resource], use.usage, use.write, use.discard, pass.imageBarriers, pass.bufferBarriers);
+		}
+		if (!pass.imageBarriers.empty() || !pass.bufferBarriers.empty())
+		{
+			statistics.barrierBatches++;
+		}
+		statistics.imageBarriers += static_cast<uint32_t>(pass.imageBarriers.size());
+		statistics.bufferBarriers += static_cast<uint32_t>(pass.bufferBarriers.size());
+	}
+
+	for (size_t index = 0; index < resources.size(); index++)
+	{
+		Resource& resource = resources[index];
+		Tracker& tracker = trackers[index];
+		if (resource.exportUsage != Usage::Count)
+		{
+			addBarrier(resource, tracker, resource.exportUsage, false, false, exportImageBarriers, exportBufferBarriers);
+		}
+		resource.finalState.stages = tracker.writeStages | tracker.readStages;
+		resource.finalState.access = tracker.writeAccess;
+		resource.finalState.layout = tracker.layout;
+	}
+	if (!exportImageBarriers.empty() || !exportBufferBarriers.empty())
+	{
+		statistics.barrierBatches++;
+	}
+	statistics.imageBarriers += static_cast<uint32_t>(exportImageBarriers.size());
+	statistics.bufferBarriers += static_cast<uint32_t>(exportBufferBarriers.size());
+}
+
+void RenderGraph::cullPasses()
+{
+	// Walks back from the exported resources: a pass survives if a later surviving pass or an export needs
+	// something it writes. A discarding write ends the need for the contents before it.
+	std::vector<bool> needed(resources.size(), false);
+	for (size_t index = 0; index < resources.size(); index++)
+	{
+		needed[index] = resources[index].exportUsage != Usage::Count;
+	}
+
+	statistics.passes = static_cast<uint32_t>(passes.size());
+	statistics.culledPasses = 0;
+	for (size_t index = passes.size(); index-- > 0;)
+	{
+		Pass& pass = passes[index];
+		bool keep = pass.sideEffects || std::ranges::any_of(pass.uses, [&](const Use& use) { return use.write && needed[use.resource]; });
+		pass.culled = !keep;
+		if (!keep)
+		{
+			statistics.culledPasses++;
+			continue;
+		}
+		for (const Use& use : pass.uses)
+		{
+			needed[use.resource] = !(use.write && use.discard);
+		}
+	}
+}
+
+void RenderGraph::orderPasses()
+{
+	// Dependencies between surviving passes: read after write, write after write and write after read
+	std::vector<std::vector<PassHandle>> successors(passes.size());
+	std::vector<std::vector<PassHandle>> predecessors(passes.size());
+	std::vector<uint32_t> pendingPredecessors(passes.size(), 0);
+	std::vector<int64_t> lastWriter(resources.size(), -1);
+	std::vector<std::vector<PassHandle>> readers(resources.size());
+	auto addEdge = [&](PassHandle from, PassHandle to)
+	{
+		if (from != to && std::ranges::find(successors[from], to) == successors[from].end())
+		{
+			successors[from].push_back(to);
+			predecessors[to].push_back(from);
+			pendingPredecessors[to]++;
+		}
+	};
+
+	std::vector<PassHandle> declarationOrder;
+	for (PassHandle index = 0; index < passes.size(); index++)
+	{
+		if (passes[index].culled)
+		{
+			continue;
+		}
+		declarationOrder.push_back(index);
+		for (const Use& use : passes[index].uses)
+		{
+			if (lastWriter[use.resource] >= 0)
+			{
+				addEdge(static_cast<PassHandle>(lastWriter[use.resource]), index);
+			}
+			if (use.write)
+			{
+				for (PassHandle reader : readers[use.resource])
+				{
+					addEdge(reader, index);
+				}
+				readers[use.resource].clear();
+				lastWriter[use.resource] = index;
+			}
+			else
+			{
+				readers[use.resource].push_back(index);
+			}
+		}
+	}
+
+	// List scheduling: of the passes whose dependencies ran, take the earliest added one that does not depend on
+	// the pass just scheduled, so the barrier between a producer and its consumer has other work to hide behind
+	std::vector<PassHandle> ready;
+	for (PassHandle index : declarationOrder)
+	{
+		if (pendingPredecessors[index] == 0)
+		{
+			ready.push_back(index);
+		}
+	}
+
+	executionOrder.clear();
+	while (!ready.empty())
+	{
+		std::ranges::sort(ready);
+		auto chosen = ready.begin();
+		if (!executionOrder.empty())
+		{
+			PassHandle previous = executionOrder.back();
+			auto independent = std::ranges::find_if(ready, [&](PassHandle candidate)
+			{
+				return std::ranges::find(predecessors[candidate], previous) == predecessors[candidate].end();
+			});
+			if (independent != ready.end())
+			{
+				chosen = independent;
+			}
+		}
+
+		PassHandle pass = *chosen;
+		ready.erase(chosen);
+		executionOrder.push_back(pass);
+		for (PassHandle successor : successors[pass])
+		{
+			if (--pendingPredecessors[successor] == 0)
+			{
+				ready.push_back(successor);
+			}
+		}
+	}
+
+	statistics.reorderedPasses = 0;
+	for (size_t position = 0; position < executionOrder.size(); position++)
+	{
+		if (executionOrder[position] != declarationOrder[position])
+		{
+			statistics.reorderedPasses++;
+		}
+	}
+}
+
+void RenderGraph::addBarrier(const Resource& resource, Tracker& tracker, Usage usage, bool write, bool discard,
+	std::vector<vk::ImageMemoryBarrier2>& imageBarriers, std::vector<vk::BufferMemoryBarrier2>& bufferBarriers) const
+{
+	State target = getUsageState(usage);
+	bool isImage = static_cast<bool>(resource.image);
+	bool layoutChange = isImage && target.layout != tracker.layout;
+
+	vk::PipelineStageFlags2 srcStages;
+	vk::AccessFlags2 srcAccess;
+	bool needsBarrier = layoutChange;
+	if (write || layoutChange)
+	{
+		// Writes and transitions wait for everything since the last write, reads included
+		srcStages = tracker.writeStages | tracker.readStages;
+		srcAccess = tracker.writeAccess;
+		needsBarrier = needsBarrier || static_cast<bool>(srcStages);
+	}
+	else if (tracker.writeStages && ((target.stages & ~tracker.visibleStages) || (target.access & ~tracker.visibleAccess)))
+	{
+		// A read only waits when the last write was not yet made visible to its stage and access
+		srcStages = tracker.writeStages;
+		srcAccess = tracker.writeAccess;
+		needsBarrier = true;
+	}
+
+	if (needsBarrier)
+	{
+		if (isImage)
+		{
+			vk::ImageMemoryBarrier2& barrier = imageBarriers.emplace_back();
+			barrier.srcStageMask = srcStages ? srcStages : vk::PipelineStageFlagBits2::eNone;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = target.stages;
+			barrier.dstAccessMask = target.access;
+			barrier.oldLayout = discard ? vk::ImageLayout::eUndefined : tracker.layout;
+			barrier.newLayout = target.layout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = resource.image;
+			barrier.subresourceRange = { resource.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+		}
+		else
+		{
+			vk::BufferMemoryBarrier2& barrier = bufferBarriers.emplace_back();
+			barrier.srcStageMask = srcStages ? srcStages : vk::PipelineStageFlagBits2::eNone;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = target.stages;
+			barrier.dstAccessMask = target.access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = resource.buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+		}
+	}
+
+	if (write)
+	{
+		tracker.writeStages = target.stages;
+		tracker.writeAccess = target.access & WRITE_ACCESS;
+		tracker.readStages = {};
+		tracker.visibleStages = {};
+		tracker.visibleAccess = {};
+	}
+	else if (layoutChange)
+	{
+		// The transition is the new last write; it is visible to this use's stages and needs no flush
+		tracker.writeStages = target.stages;
+		tracker.writeAccess = {};
+		tracker.readStages = target.stages;
+		tracker.visibleStages = target.stages;
+		tracker.visibleAccess = target.access;
+	}
+	else
+	{
+		tracker.readStages |= target.stages;
+		if (needsBarrier)
+		{
+			tracker.visibleStages |= target.stages;
+			tracker.visibleAccess |= target.access;
+		}
+	}
+	if (isImage)
+	{
+		tracker.layout = target.layout;
+	}
+}
+
+void RenderGraph::execute(const vk::raii::CommandBuffer& commandBuffer)
+{
+	for (PassHandle passIndex : executionOrder)
+	{
+		const Pass& pass = passes[passIndex];
+		recordBarriers(commandBuffer, pass.imageBarriers, pass.bufferBarriers);
+		if (pass.record)
+		{
+			pass.record(commandBuffer);
+		}
+	}
+	recordBarriers(commandBuffer, exportImageBarriers, exportBufferBarriers);
+}
+
+void RenderGraph::recordBarriers(const vk::raii::CommandBuffer& commandBuffer, std::span<const vk::ImageMemoryBarrier2> imageBarriers,
+	std::span<const vk::BufferMemoryBarrier2> bufferBarriers) const
+{
+	if (imageBarriers.empty() && bufferBarriers.empty())
+	{
+		return;
+	}
+
+	vk::DependencyInfo dependencyInfo;
+	dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+	dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+	dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+	dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+	commandBuffer.pipelineBarrier2(dependencyInfo);
+}
+
+std::string RenderGraph::toGraphviz() const
+{
+	std::ostringstream dot;
+	dot << "digraph FrameGraph {\n";
+	dot << "\trankdir=LR;\n";
+	dot << "\tnode [fontname=\"Helvetica\"];\n";
+
+	for (size_t index = 0; index < resources.size(); index++)
+	{
+		const Resource& resource = resources[index];
+		dot << "\tr" << index << " [shape=ellipse, label=\"" << resource.name;
+		if (resource.exportUsage != Usage::Count)
+		{
+			dot << "\\nexported for " << getUsageName(resource.exportUsage);
+		}
+		dot << "\"];\n";
+	}
+
+	for (size_t index = 0; index < passes.size(); index++)
+	{
+		const Pass& pass = passes[index];
+		auto position = std::ranges::find(executionOrder, static_cast<PassHandle>(index));
+		dot << "\tp" << index << " [shape=box, label=\"";
+		if (pass.culled)
+		{
+			dot << pass.name << "\\nculled\", style=dashed, fontcolor=gray];\n";
+		}
+		else
+		{
+			dot << "#" << (position - executionOrder.begin()) << " " << pass.name << "\\n" << pass.imageBarriers.size() << " image / "
+				<< pass.bufferBarriers.size() << " buffer barriers\"];\n";
+		}
+		for (const Use& use : pass.uses)
+		{
+			if (use.write)
+			{
+				dot << "\tp" << index << " -> r" << use.resource;
+			}
+			else
+			{
+				dot << "\tr" << use.resource << " -> p" << index;
+			}
+			dot << " [label=\"" << getUsageName(use.usage) << (use.discard ? " (discard)" : "") << "\"";
+			if (pass.culled)
+			{
+				dot << ", style=dashed, color=gray";
+			}
+			dot << "];\n";
+		}
+	}
+
+	// Execution order, which may differ from the order the passes were added in
+	for (size_t position = 1; position < executionOrder.size(); position++)
+	{
+		dot << "\tp" << executionOrder[position - 1] << " -> p" << executionOrder[position] << " [style=dotted, color=blue, constraint=false];\n";
+	}
+	dot << "}\n";
+	return dot.str();
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+/// Frame graph for one command buffer. Passes declare which resources they read and write and how; compile()
+/// culls passes whose results nothing uses, orders the rest so dependent passes are spread apart where the
+/// dependencies allow, and derives the barriers between them. execute() records each pass behind a single
+/// batched barrier holding every image transition and buffer dependency it needs.
+/// Resources are imported with the state the previous frame (or another queue) left them in, so the graph
+/// also covers dependencies across frames. The graph is rebuilt every frame after reset().
+class RenderGraph
+{
+public:
+	using ResourceHandle = uint32_t;
+	using PassHandle = uint32_t;
+	using RecordFunction = std::function<void(const vk::raii::CommandBuffer&)>;
+
+	/// How a pass touches a resource. Each usage stands for one stage, access and image layout.
+	enum class Usage : uint32_t
+	{
+		ColorAttachmentWrite,
+		DepthAttachmentWrite,
+		DepthAttachmentRead,
+		FragmentSampled,
+		FragmentStorageRead,
+		ComputeStorageRead,
+		ComputeStorageWrite,
+		Present,
+		Count
+	};
+
+	/// Synchronization state of a resource where the graph starts or ends. access holds writes that are not
+	/// yet visible; with no access, stages are the reads later writers have to wait for.
+	struct State
+	{
+		vk::PipelineStageFlags2 stages;
+		vk::AccessFlags2 access;
+		vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+	};
+
+	struct Statistics
+	{
+		uint32_t passes = 0;
+		uint32_t culledPasses = 0;
+		uint32_t reorderedPasses = 0; // passes that execute at another position than they were added at
+		uint32_t barrierBatches = 0;
+		uint32_t imageBarriers = 0;
+		uint32_t bufferBarriers = 0;
+	};
+
+	RenderGraph() = default;
+	~RenderGraph() = default;
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	/// Clears passes and resources for the next frame
+	void reset();
+
+	ResourceHandle importImage(const char* name, vk::Image image, vk::ImageAspectFlags aspect, const State& initialState);
+	ResourceHandle importBuffer(const char* name, vk::Buffer buffer, const State& initialState);
+	/// The resource leaves the graph in usage's state; passes writing it are never culled
+	void exportResource(ResourceHandle resource, Usage usage);
+
+	PassHandle addPass(const char* name, RecordFunction record);
+	void read(PassHandle pass, ResourceHandle resource, Usage usage);
+	/// discard: the previous contents are not needed (cleared or fully overwritten), so earlier writers may be
+	/// culled and images transition from eUndefined
+	void write(PassHandle pass, ResourceHandle resource, Usage usage, bool discard = false);
+	/// Keeps a pass whose results leave the graph some other way
+	void setSideEffects(PassHandle pass);
+
+	void compile();
+	void execute(const vk::raii::CommandBuffer& commandBuffer);
+
+	/// After compile(): the state to import the resource with next frame
+	State getFinalState(ResourceHandle resource) const { return resources[resource].finalState; }
+	/// After compile(): passes in execution order, culled passes grayed out, with the barriers before each pass
+	std::string toGraphviz() const;
+	const Statistics& getStatistics() const { return statistics; }
+
+	static State getUsageState(Usage usage);
+	static const char* getUsageName(Usage usage);
+
+private:
+	struct Use
+	{
+		ResourceHandle resource = 0;
+		Usage usage = Usage::Count;
+		bool write = false;
+		bool discard = false;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		RecordFunction record;
+		std::vector<Use> uses;
+		bool sideEffects = false;
+		bool culled = false;
+		// Filled by compile()
+		std::vector<vk::ImageMemoryBarrier2> imageBarriers;
+		std::vector<vk::BufferMemoryBarrier2> bufferBarriers;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		vk::Image image;
+		vk::Buffer buffer;
+		vk::ImageAspectFlags aspect;
+		State initialState;
+		Usage exportUsage = Usage::Count;
+		State finalState;
+	};
+
+	// Tracks one resource while barriers are derived
+	struct Tracker
+	{
+		vk::PipelineStageFlags2 writeStages; // last write or layout transition; later accesses chain onto it
+		vk::AccessFlags2 writeAccess; // not yet made available
+		vk::PipelineStageFlags2 readStages; // reads since the last write
+		vk::PipelineStageFlags2 visibleStages; // stages the last write was made visible to
+		vk::AccessFlags2 visibleAccess;
+		vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+	};
+
+	void cullPasses();
+	void orderPasses();
+	/// Appends the barrier use needs, if any, and advances tracker
+	void addBarrier(const Resource& resource, Tracker& tracker, Usage usage, bool write, bool discard,
+		std::vector<vk::ImageMemoryBarrier2>& imageBarriers, std::vector<vk::BufferMemoryBarrier2>& bufferBarriers) const;
+	void recordBarriers(const vk::raii::CommandBuffer& commandBuffer, std::span<const vk::ImageMemoryBarrier2> imageBarriers,
+		std::span<const vk::BufferMemoryBarrier2> bufferBarriers) const;
+
+	std::vector<Pass> passes;
+	std::vector<Resource> resources;
+	std::vector<PassHandle> executionOrder;
+	// After the last pass: transitions into the export states
+	std::vector<vk::ImageMemoryBarrier2> exportImageBarriers;
+	std::vector<vk::BufferMemoryBarrier2> exportBufferBarriers;
+	Statistics statistics;
+};
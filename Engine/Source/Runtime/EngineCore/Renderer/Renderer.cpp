@@ -5,10 +5,44 @@
 #define VULKAN_HPP_HANDLE_ERROR_OUT_OF_DATE_AS_SUCCESS
 
 #include "Renderer.h"
+#include "MeshDecode.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 #include <chrono>
+#include <filesystem>
 
 #include "Runtime/EngineCore/Window.h"
 
+namespace
+{
+    void PrintMeshOptimizationReport(const MeshOptimizer::OptimizationReport& report)
+    {
+        std::cout << "Mesh optimization (FIFO " << MeshOptimizer::VERTEX_CACHE_SIMULATION_SIZE << "): ACMR "
+            << report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+            << report.before.atvr << " -> " << report.after.atvr << ", vertices "
+            << report.vertexCountBefore << " -> " << report.vertexCountAfter << std::endl;
+    }
+
+    void PrintSubmeshSummary(std::span<const Submesh> submeshes, size_t indexBytes)
+    {
+        size_t shortIndexSubmeshes = 0;
+        size_t indexCount = 0;
+        for (const Submesh& submesh : submeshes)
+        {
+            shortIndexSubmeshes += submesh.indexSize == sizeof(uint16_t) ? 1 : 0;
+            indexCount += submesh.indexCount;
+        }
+        std::cout << "Submeshes: " << submeshes.size() << " (" << shortIndexSubmeshes << " with 16-bit indices), "
+            << indexBytes / 1024 << " KB index data for all LODs, LOD 0 " << indexCount / 3 << " triangles" << std::endl;
+        for (size_t submeshIndex = 0; submeshIndex < submeshes.size(); submeshIndex++)
+        {
+            const Submesh& submesh = submeshes[submeshIndex];
+            std::cout << "  Submesh " << submeshIndex << ": " << submesh.vertexCount << " vertices, "
+                << submesh.indexCount / 3 << " triangles, " << submesh.indexSize * 8 << "-bit indices, "
+                << submesh.lodCount << " LODs, material " << submesh.material << std::endl;
+        }
+    }
+}
 
 //TODO: File system and ecs load objedct and set the filepath
 const std::string MODEL_PATH = /*"../Engine/Content/Models/viking_room.obj"*/ "../Engine/Content/Models/viking_room.glb";
@@ -19,7 +53,25 @@ const std::vector<char const*> validationLayers = {
 	"VK_LAYER_KHRONOS_validation"
 };
 
-constexpr int      MAX_FRAMES_IN_FLIGHT = 2;
+// Per-frame resources exist for the deepest pipelining; framesInFlight picks how much of it is used
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = FrameTimeline::MAX_FRAMES_IN_FLIGHT;
+// Room for the view data of every pass and ObjectUniforms of a few thousand objects per frame
+constexpr vk::DeviceSize UNIFORM_ARENA_BYTES_PER_FRAME = 1024 * 1024;
+// Slots in the bindless texture table, clamped to the device's update-after-bind limits
+constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+// Descriptors per set reserved by the renderer's descriptor pools, roughly the mix of its layouts
+constexpr std::array<DescriptorAllocator::PoolRatio, 4> DESCRIPTOR_POOL_RATIOS = { {
+    { vk::DescriptorType::eUniformBufferDynamic, 1.0f },
+    { vk::DescriptorType::eUniformBuffer, 1.0f },
+    { vk::DescriptorType::eCombinedImageSampler, 1.0f },
+    { vk::DescriptorType::eStorageBuffer, 2.0f } } };
+// Below this many draws per worker, splitting a pass across secondary command buffers costs more than it saves
+constexpr size_t MIN_DRAWS_PER_RECORDING_JOB = 128;
+// Written by the stats panel's frame graph button, relative to the working directory
+const std::string FRAME_GRAPH_DUMP_PATH = "FrameGraph.dot";
+// First pool of the long-lived and per-frame descriptor allocators; later pools grow from there
+constexpr uint32_t PERSISTENT_DESCRIPTOR_SETS = 16;
+constexpr uint32_t FRAME_DESCRIPTOR_SETS = 16;
 
 #ifdef NDEBUG
 constexpr bool enableValidationLayers = false;
@@ -45,51 +97,79 @@ void Renderer::Initialize()
     CreateSurface();
     PickPhysicalDevice();
     CreateLogicalDevice();
+    gpuAllocator.init(VulkanInstance, VulkanPhysicalDevice, VulkanLogicalDevice, VK_API_VERSION_1_3, memoryBudgetSupported);
     CreateSwapChain();
     CreateImageViews();
+    bindlessTextures.init(VulkanLogicalDevice, VulkanPhysicalDevice, MAX_FRAMES_IN_FLIGHT, MAX_BINDLESS_TEXTURES);
     CreateDescriptorSetLayout();
     CreateGraphicsPipeline();
     CreateCommandPool();
-    CreateDepthResources();
-    
-    CreateTextureImage();
-    // CreateTextureImageWithKTX();
-    CreateTextureImageView();
-    CreateTextureSampler();
+    commandRecorder.init(VulkanLogicalDevice, queueIndex, jobSystem.getWorkerCount() + 1, MAX_FRAMES_IN_FLIGHT);
+    asyncCompute.init(VulkanLogicalDevice, VulkanPhysicalDevice, queueIndex, computeQueueIndex, computeQueueSlot, MAX_FRAMES_IN_FLIGHT);
+    dynamicResolution.init(VulkanLogicalDevice, VulkanPhysicalDevice, queueIndex, MAX_FRAMES_IN_FLIGHT, DynamicResolution::Settings{});
+
+    uploadService.init(VulkanLogicalDevice, VulkanPhysicalDevice, gpuAllocator, transferQueueIndex, queueIndex, MAX_FRAMES_IN_FLIGHT,
+        ReadFile("../Engine/Binaries/Shaders/MipDownsample_Comp.glsl.spv"));
+    textureStreamer.init(VulkanLogicalDevice, VulkanPhysicalDevice, gpuAllocator, uploadService, MAX_FRAMES_IN_FLIGHT, TextureStreamer::Settings{});
+    gpuAllocator.addBudgetCallback([this](const GpuAllocator::BudgetEvent& event) { OnMemoryBudgetEvent(event); });
+
+    // KTX2 textures are read and transcoded on a worker while the model is imported
+    std::future<TextureTranscoder::Texture> ktxTexture;
+    if (std::filesystem::path(TEXTURE_PATH).extension() == ".ktx2")
+    {
+        textureTranscodeTargets = TextureTranscoder::querySupportedTargets(VulkanPhysicalDevice);
+        ktxTexture = jobSystem.submit([this]() { return TextureTranscoder::load(TEXTURE_PATH, textureTranscodeTargets); });
+    }
+    else
+    {
+        CreateTextureImage();
+    }
     //LoadModel();
     LoadModelWithGLTF();
+    if (ktxTexture.valid())
+    {
+        CreateTextureImageWithKTX(ktxTexture.get());
+    }
+    CreateTextureSampler();
+    bindlessTextures.setSampler(*textureSampler);
+    CreateMaterials();
     CreateVertexBuffer();
     CreateIndexBuffer();
+
+    // Initialize ImGui
+    imGui.init(VulkanLogicalDevice, VulkanPhysicalDevice, gpuAllocator, uploadService);
+    imGui.setColorFormat(VulkanSwapChainSurfaceFormat.format);
+    imGui.initialize(static_cast<float>(VulkanSwapChainExtent.width), static_cast<float>(VulkanSwapChainExtent.height));
+    imGui.initResources();
+    imGui.addPanel("Renderer Stats", [this]() { DrawStatsPanel(); });
+
+    // The texture, model and font copies go out as one batch; frames render without them until it lands
+    assetUploadTicket = uploadService.submit();
     CreateUniformBuffers();
-    CreateDescriptorPool();
+    CreateDescriptorAllocators();
     CreateDescriptorSets();
     
-    // Forward+ setup (needs VulkanUniformBuffers created first)
+    // Forward+ setup (needs the uniform arena created first)
     CreateForwardPlusLightBuffer();
     CreateForwardPlusDescriptorSetLayout();
     CreateLightCullingPipeline();
     CreateForwardPlusPipeline();
-    CreateForwardPlusDescriptorPool();
-    CreateForwardPlusDescriptorSets();
     
     CreateCommandBuffers();
     CreateSyncObjects();
 
-    // Initialize ImGui
-    imGui.init(VulkanLogicalDevice, VulkanPhysicalDevice, VulkanGraphicsQueue, VulkanCommandPool, queueIndex);
-    imGui.setColorFormat(VulkanSwapChainSurfaceFormat.format);
-    imGui.initialize(static_cast<float>(VulkanSwapChainExtent.width), static_cast<float>(VulkanSwapChainExtent.height));
-    imGui.initResources();
-
     // Create scene render target for rendering 3D scene to texture
     // Only create if we have valid dimensions
+    transientAttachments.init(VulkanLogicalDevice, gpuAllocator);
     if (VulkanSwapChainExtent.width > 0 && VulkanSwapChainExtent.height > 0) {
         vk::Format depthFormat = findDepthFormat();
-        sceneRenderTarget.create(VulkanLogicalDevice, VulkanPhysicalDevice,
+        sceneRenderTarget.create(VulkanLogicalDevice, gpuAllocator, transientAttachments,
             VulkanSwapChainExtent.width, VulkanSwapChainExtent.height,
-            VulkanSwapChainSurfaceFormat.format, depthFormat);
+            VulkanSwapChainSurfaceFormat.format, depthFormat,
+            static_cast<uint32_t>(FramePass::Scene), static_cast<uint32_t>(FramePass::Scene));
+        transientAttachments.build();
         sceneRenderTarget.createSampler(VulkanLogicalDevice);
-        sceneRenderTarget.createDescriptorSet(VulkanLogicalDevice, VulkanDescriptorPool);
+        sceneRenderTarget.createDescriptorSet(VulkanLogicalDevice, descriptorAllocator);
         
     // Set scene texture for ImGui viewport
     imGui.setSceneTextureInfo(&sceneRenderTarget.getSampler(), &sceneRenderTarget.getColorImageView(), sceneRenderTarget.getVkDescriptorSet());
@@ -98,13 +178,12 @@ void Renderer::Initialize()
 
 void Renderer::Render()
 {
-    // Note: inFlightFences, presentCompleteSemaphores, and commandBuffers are indexed by frameIndex,
-            //       while renderFinishedSemaphores is indexed by imageIndex
-    auto fenceResult = VulkanLogicalDevice.waitForFences(*inFlightFences[frameIndex], vk::True, UINT64_MAX);
-    if (fenceResult != vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to wait for fence!");
-    }
+    // Note: presentCompleteSemaphores and commandBuffers are indexed by frameIndex, the frame number's slot,
+    //       while renderFinishedSemaphores is indexed by imageIndex
+    uint64_t frameNumber = frameTimeline.waitForFrame(framesInFlight);
+    frameIndex = frameTimeline.getFrameSlot();
+    gpuAllocator.updateBudget(static_cast<uint32_t>(frameNumber));
+    deletionQueue.collect(frameTimeline.getCompletedFrame());
 
     auto [result, imageIndex] = VulkanSwapChain.acquireNextImage(UINT64_MAX, *VulkanPresentCompleteSemaphores[frameIndex], nullptr);
 
@@ -122,6 +201,21 @@ void Renderer::Render()
         assert(result == vk::Result::eTimeout || result == vk::Result::eNotReady);
         throw std::runtime_error("failed to acquire swap chain image!");
     }
+
+    // The uniforms and the ImGui viewport both depend on this frame's scene resolution. The viewport samples only
+    // the rendered region, stopping half a texel short of a partial one so bilinear upscaling never reads past it.
+    dynamicResolution.beginFrame(frameIndex);
+    sceneRenderExtent = dynamicResolution.getRenderExtent(vk::Extent2D{ sceneRenderTarget.getWidth(), sceneRenderTarget.getHeight() });
+    if (sceneRenderTarget.getWidth() > 0 && sceneRenderTarget.getHeight() > 0)
+    {
+        auto regionEdge = [](uint32_t rendered, uint32_t size)
+        {
+            float edge = rendered < size ? static_cast<float>(rendered) - 0.5f : static_cast<float>(rendered);
+            return edge / static_cast<float>(size);
+        };
+        imGui.setSceneTextureRegion(regionEdge(sceneRenderExtent.width, sceneRenderTarget.getWidth()),
+            regionEdge(sceneRenderExtent.height, sceneRenderTarget.getHeight()));
+    }
     UpdateUniformBuffer(frameIndex);
 
     // Update ImGui display size for current window size
@@ -129,25 +223,51 @@ void Renderer::Render()
 
     // Update ImGui
     imGui.newFrame();
-    imGui.updateBuffers();
-
-    // Only reset the fence if we are submitting work
-    VulkanLogicalDevice.resetFences(*inFlightFences[frameIndex]);
+    imGui.updateBuffers(frameIndex, deletionQueue, frameTimeline.getSubmittedFrame());
 
     VulkanCommandBuffers[frameIndex].reset();
     recordCommandBuffer(imageIndex);
+    // Texel density requests gathered while recording become uploads for later frames
+    textureStreamer.endFrame();
+
+    std::array<vk::SemaphoreSubmitInfo, 3> waitInfos;
+    uint32_t waitCount = 0;
+    waitInfos[waitCount].semaphore = *VulkanPresentCompleteSemaphores[frameIndex];
+    waitInfos[waitCount].stageMask = SWAPCHAIN_ACQUIRE_STAGE;
+    waitCount++;
+    // Acquired uploads have already finished, so this wait only orders the transfer queue's writes before this frame
+    if (frameUploadWaitValue > 0)
+    {
+        waitInfos[waitCount].semaphore = uploadService.getTimelineSemaphore();
+        waitInfos[waitCount].value = frameUploadWaitValue;
+        waitInfos[waitCount].stageMask = vk::PipelineStageFlagBits2::eAllCommands;
+        waitCount++;
+    }
+    // Only fragment shading consumes the tile light lists, so everything before it may overlap the culling
+    if (lightCullingAsync)
+    {
+        waitInfos[waitCount] = asyncCompute.getWaitInfo(asyncCompute.submit(), vk::PipelineStageFlagBits2::eFragmentShader);
+        waitCount++;
+    }
 
-    vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
-    vk::SubmitInfo   submitInfo;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &*VulkanPresentCompleteSemaphores[frameIndex];
-    submitInfo.pWaitDstStageMask = &waitDestinationStageMask;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &*VulkanCommandBuffers[frameIndex];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &*VulkanRenderFinishedSemaphores[imageIndex];
+    vk::CommandBufferSubmitInfo commandBufferInfo;
+    commandBufferInfo.commandBuffer = *VulkanCommandBuffers[frameIndex];
 
-    VulkanGraphicsQueue.submit(submitInfo, *inFlightFences[frameIndex]);
+    // Presentation waits on the binary semaphore; the timeline value marks the whole frame as done
+    std::array<vk::SemaphoreSubmitInfo, 2> signalInfos;
+    signalInfos[0].semaphore = *VulkanRenderFinishedSemaphores[imageIndex];
+    signalInfos[0].stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
+    signalInfos[1] = frameTimeline.signalSubmit(vk::PipelineStageFlagBits2::eAllCommands);
+
+    vk::SubmitInfo2 submitInfo;
+    submitInfo.waitSemaphoreInfoCount = waitCount;
+    submitInfo.pWaitSemaphoreInfos = waitInfos.data();
+    submitInfo.commandBufferInfoCount = 1;
+    submitInfo.pCommandBufferInfos = &commandBufferInfo;
+    submitInfo.signalSemaphoreInfoCount = static_cast<uint32_t>(signalInfos.size());
+    submitInfo.pSignalSemaphoreInfos = signalInfos.data();
+
+    VulkanGraphicsQueue.submit2(submitInfo);
 
     vk::PresentInfoKHR presentInfoKHR;
     presentInfoKHR.waitSemaphoreCount = 1;
@@ -169,12 +289,34 @@ void Renderer::Render()
         // There are no other success codes than eSuccess; on any error code, presentKHR already threw an exception.
         assert(result == vk::Result::eSuccess);
     }
-    frameIndex = (frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+void Renderer::SetFramesInFlight(uint32_t count)
+{
+    // Takes effect with the next frame's wait; resources for the deepest setting already exist
+    framesInFlight = std::clamp<uint32_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
 }
 
 void Renderer::Shutdown()
 {
-    sceneRenderTarget.destroy(VulkanLogicalDevice);
+    // The device is idle by now; retired descriptor sets go back to the scene target before it is destroyed
+    deletionQueue.flush();
+    sceneRenderTarget.destroy();
+    transientAttachments.destroy();
+    bindlessTextures.destroy();
+    forwardPlusDescriptorSet = nullptr;
+    for (DescriptorAllocator& allocator : frameDescriptorAllocators)
+    {
+        allocator.destroy();
+    }
+    descriptorAllocator.destroy();
+    textureStreamer.destroy();
+    uploadService.destroy();
+    uniformArena.destroy();
+    commandRecorder.destroy();
+    asyncCompute.destroy();
+    dynamicResolution.destroy();
+    frameTimeline.destroy();
 }
 
 void Renderer::CreateInstance()
@@ -278,9 +420,12 @@ void Renderer::PickPhysicalDevice()
 
             auto features = device.template getFeatures2<vk::PhysicalDeviceFeatures2,
                 vk::PhysicalDeviceVulkan11Features,
+                vk::PhysicalDeviceVulkan12Features,
                 vk::PhysicalDeviceVulkan13Features,
                 vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
             bool supportsRequiredFeatures = features.template get<vk::PhysicalDeviceVulkan11Features>().shaderDrawParameters && features.template get<vk::PhysicalDeviceVulkan13Features>().synchronization2 &&
+                features.template get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore &&
+                BindlessTextureTable::isSupported(features.template get<vk::PhysicalDeviceVulkan12Features>()) &&
                 features.template get<vk::PhysicalDeviceFeatures2>().features.samplerAnisotropy &&
                 features.template get<vk::PhysicalDeviceVulkan13Features>().dynamicRendering &&
                 features.template get<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>().extendedDynamicState;
@@ -318,8 +463,29 @@ void Renderer::CreateLogicalDevice()
         throw std::runtime_error("Could not find a queue for graphics and present -> terminating");
     }
 
+    // Uploads go to a separate family when the device has one so they overlap with rendering
+    transferQueueIndex = UploadService::findTransferQueueFamily(queueFamilyProperties, queueIndex);
+    // Light culling runs on its own compute queue when there is one. Sharing the upload queue would need
+    // locking across threads, so that family only qualifies with a second queue.
+    computeQueueIndex = AsyncComputeQueue::findComputeQueueFamily(queueFamilyProperties, queueIndex);
+    computeQueueSlot = 0;
+    if (computeQueueIndex == transferQueueIndex && computeQueueIndex != queueIndex)
+    {
+        if (queueFamilyProperties[computeQueueIndex].queueCount > 1)
+        {
+            computeQueueSlot = 1;
+        }
+        else
+        {
+            computeQueueIndex = queueIndex;
+        }
+    }
+    computeSharingFamilies = { queueIndex, computeQueueIndex };
+
     vk::PhysicalDeviceFeatures2 feature2;
     feature2.features.samplerAnisotropy = true;
+    // Lets the mip downsample fallback write any storage format with one pipeline
+    feature2.features.shaderStorageImageWriteWithoutFormat = VulkanPhysicalDevice.getFeatures().shaderStorageImageWriteWithoutFormat;
     // query for Vulkan 1.3 features
     vk::PhysicalDeviceVulkan13Features vulkan13Features{};
     vulkan13Features.dynamicRendering = true;
@@ -331,32 +497,61 @@ void Renderer::CreateLogicalDevice()
     vk::PhysicalDeviceVulkan11Features vulkan11Features{};
     vulkan11Features.shaderDrawParameters = true;
 
-    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan13Features, vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT> featureChain(
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.timelineSemaphore = true;
+    BindlessTextureTable::enableFeatures(vulkan12Features);
+
+    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features, vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT> featureChain(
         feature2,                                   // vk::PhysicalDeviceFeatures2
         vulkan11Features,                       // vk::PhysicalDeviceVulkan11Features
+        vulkan12Features,                     // vk::PhysicalDeviceVulkan12Features
         vulkan13Features,                     // vk::PhysicalDeviceVulkan13Features
         extendedDynamicStateFeatures          // vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT
     );
 
     // create a Device
-    float                     queuePriority = 0.5f;
+    std::array<float, 2>      queuePriorities = { 0.5f, 0.5f };
+    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
     vk::DeviceQueueCreateInfo deviceQueueCreateInfo;
     deviceQueueCreateInfo.queueFamilyIndex = queueIndex;
     deviceQueueCreateInfo.queueCount = 1;
-    deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
+    deviceQueueCreateInfo.pQueuePriorities = queuePriorities.data();
+    deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+    if (transferQueueIndex != queueIndex)
+    {
+        deviceQueueCreateInfo.queueFamilyIndex = transferQueueIndex;
+        deviceQueueCreateInfo.queueCount = transferQueueIndex == computeQueueIndex ? computeQueueSlot + 1 : 1;
+        deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+    }
+    if (computeQueueIndex != queueIndex && computeQueueIndex != transferQueueIndex)
+    {
+        deviceQueueCreateInfo.queueFamilyIndex = computeQueueIndex;
+        deviceQueueCreateInfo.queueCount = 1;
+        deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+    }
 
     vk::DeviceCreateInfo deviceCreateInfo;
     deviceCreateInfo.pNext = &featureChain.get<vk::PhysicalDeviceFeatures2>();
-    deviceCreateInfo.queueCreateInfoCount = 1;
-    deviceCreateInfo.pQueueCreateInfos = &deviceQueueCreateInfo;
-    deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanRequiredDeviceExtension.size());
-    deviceCreateInfo.ppEnabledExtensionNames = VulkanRequiredDeviceExtension.data();
+    deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size());
+    deviceCreateInfo.pQueueCreateInfos = deviceQueueCreateInfos.data();
+    // Memory budget reporting is optional; without it the allocator estimates heap budgets itself
+    std::vector<const char*> deviceExtensions = VulkanRequiredDeviceExtension;
+    auto availableDeviceExtensions = VulkanPhysicalDevice.enumerateDeviceExtensionProperties();
+    memoryBudgetSupported = std::ranges::any_of(availableDeviceExtensions,
+        [](auto const& extension) { return strcmp(extension.extensionName, vk::EXTMemoryBudgetExtensionName) == 0; });
+    if (memoryBudgetSupported)
+    {
+        deviceExtensions.push_back(vk::EXTMemoryBudgetExtensionName);
+    }
+
+    deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
     VulkanLogicalDevice = vk::raii::Device(VulkanPhysicalDevice, deviceCreateInfo);
     VulkanGraphicsQueue = vk::raii::Queue(VulkanLogicalDevice, queueIndex, 0);
 }
 
-void Renderer::CreateSwapChain()
+void Renderer::CreateSwapChain(vk::SwapchainKHR oldSwapChain)
 {
     auto surfaceCapabilities = VulkanPhysicalDevice.getSurfaceCapabilitiesKHR(*VulkanSurface);
     VulkanSwapChainExtent = chooseSwapExtent(surfaceCapabilities);
@@ -375,18 +570,19 @@ void Renderer::CreateSwapChain()
     swapChainCreateInfo.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
     swapChainCreateInfo.presentMode = chooseSwapPresentMode(VulkanPhysicalDevice.getSurfacePresentModesKHR(*VulkanSurface));
     swapChainCreateInfo.clipped = true;
+    swapChainCreateInfo.oldSwapchain = oldSwapChain;
 
     VulkanSwapChain = vk::raii::SwapchainKHR(VulkanLogicalDevice, swapChainCreateInfo);
     VulkanSwapChainImages = VulkanSwapChain.getImages();
 }
 
-vk::raii::ImageView Renderer::CreateImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags)
+vk::raii::ImageView Renderer::CreateImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, uint32_t mipLevels)
 {
     vk::ImageViewCreateInfo viewInfo;
     viewInfo.image = image;
     viewInfo.viewType = vk::ImageViewType::e2D;
     viewInfo.format = format;
-    viewInfo.subresourceRange = { aspectFlags, 0, 1, 0, 1 };
+    viewInfo.subresourceRange = { aspectFlags, 0, mipLevels, 0, 1 };
 
     return vk::raii::ImageView(VulkanLogicalDevice, viewInfo);
 }
@@ -409,15 +605,19 @@ void Renderer::CreateImageViews()
 
 void Renderer::CreateDescriptorSetLayout()
 {
-    //Create Uniform Buffer Object Layout Binding
+    //Create Uniform Buffer Object Layout Binding; textures come from the bindless table in set 2
     std::array bindings = {
-      vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex, nullptr),
-      vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr)
+      vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex, nullptr)
     };
 
     vk::DescriptorSetLayoutCreateInfo layoutInfo({}, bindings.size(), bindings.data());
 
     VulkanDescriptorSetLayout = vk::raii::DescriptorSetLayout(VulkanLogicalDevice, layoutInfo);
+
+    // Per-object uniforms live in their own set so draws only rebind it with a new dynamic offset
+    vk::DescriptorSetLayoutBinding objectBinding(0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex, nullptr);
+    vk::DescriptorSetLayoutCreateInfo objectLayoutInfo({}, 1, &objectBinding);
+    objectDescriptorSetLayout = vk::raii::DescriptorSetLayout(VulkanLogicalDevice, objectLayoutInfo);
 }
 
 void Renderer::CreateGraphicsPipeline()
@@ -438,8 +638,8 @@ void Renderer::CreateGraphicsPipeline()
     vk::PipelineShaderStageCreateInfo ShaderStages[] = { VertShaderStageInfo, FragShaderStageInfo };
 
     // Graphic Pipeline
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    constexpr auto bindingDescription = GpuVertex::getBindingDescription();
+    constexpr auto attributeDescriptions = GpuVertex::getAttributeDescriptions();
 
     vk::PipelineVertexInputStateCreateInfo   vertexInputInfo;//<--- InputAssembly
     vertexInputInfo.vertexBindingDescriptionCount = 1;
@@ -492,10 +692,18 @@ void Renderer::CreateGraphicsPipeline()
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
+    std::array setLayouts = { *VulkanDescriptorSetLayout, *objectDescriptorSetLayout, *bindlessTextures.getLayout() };
     vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &*VulkanDescriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+    // Per-mesh dequantization of the packed vertex attributes, then the per-draw material for the fragment stage
+    std::array pushConstantRanges = {
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(VertexQuantization)),
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eFragment, sizeof(VertexQuantization), sizeof(MaterialConstants))
+    };
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
     VulkanPipelineLayout = vk::raii::PipelineLayout(VulkanLogicalDevice, pipelineLayoutInfo);
 
@@ -533,13 +741,6 @@ void Renderer::CreateCommandPool()
     VulkanCommandPool = vk::raii::CommandPool(VulkanLogicalDevice, poolInfo);
 }
 
-void Renderer::CreateDepthResources()
-{
-    vk::Format depthFormat = findDepthFormat();
-    CreateImage(VulkanSwapChainExtent.width, VulkanSwapChainExtent.height, depthFormat, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::MemoryPropertyFlagBits::eDeviceLocal, depthImage, depthImageMemory);
-    depthImageView = CreateImageView(depthImage, depthFormat, vk::ImageAspectFlagBits::eDepth);
-}
-
 void Renderer::CreateTextureImage()
 {
     int texWidth, texHeight, texChannels;
@@ -550,93 +751,30 @@ void Renderer::CreateTextureImage()
         throw std::runtime_error("failed to load texture image!");
     }
 
-    vk::raii::Buffer stagingBuffer({});
-    vk::raii::DeviceMemory stagingBufferMemory({});
-
-    CreateBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingBuffer, stagingBufferMemory);
-
-    void* data = stagingBufferMemory.mapMemory(0, imageSize);
-    memcpy(data, pixels, imageSize);
-    stagingBufferMemory.unmapMemory();
-
+    std::span<const std::byte> pixelBytes = std::as_bytes(std::span(pixels, static_cast<size_t>(imageSize)));
+    std::vector<std::byte> texels(pixelBytes.begin(), pixelBytes.end());
     stbi_image_free(pixels);
 
-    CreateImage(texWidth, texHeight, vk::Format::eR8G8B8A8Srgb, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, textureImage, textureImageMemory);
-
-    transitionImageLayout(textureImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-    copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    transitionImageLayout(textureImage, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-
+    // Only the low mips are uploaded now; finer levels stream in once draws ask for them
+    textureHandle = textureStreamer.add(TextureStreamer::makeSource(std::move(texels), vk::Format::eR8G8B8A8Srgb,
+        static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)));
 }
 
-void Renderer::CreateTextureImageWithKTX() {
-    /*// Load KTX2 texture instead of using stb_image
-    ktxTexture* kTexture;
-    KTX_error_code result = ktxTexture_CreateFromNamedFile(
-        TEXTURE_PATH.c_str(),
-        KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
-        &kTexture);
-
-    if (result != KTX_SUCCESS)
-    {
-        throw std::runtime_error("failed to load ktx texture image!");
-    }
-
-    // Get texture dimensions and data
-    uint32_t     texWidth = kTexture->baseWidth;
-    uint32_t     texHeight = kTexture->baseHeight;
-    ktx_size_t   imageSize = ktxTexture_GetImageSize(kTexture, 0);
-    ktx_uint8_t* ktxTextureData = ktxTexture_GetData(kTexture);
-
-    vk::raii::Buffer       stagingBuffer({});
-    vk::raii::DeviceMemory stagingBufferMemory({});
-    createBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingBuffer, stagingBufferMemory);
-
-    void* data = stagingBufferMemory.mapMemory(0, imageSize);
-    memcpy(data, ktxTextureData, imageSize);
-    stagingBufferMemory.unmapMemory();
-
-    // Determine the Vulkan format from KTX format
-    vk::Format textureFormat;
-
-    // Check if the KTX texture has a format
-    if (kTexture->classId == ktxTexture2_c)
-    {
-        // For KTX2 files, we can get the format directly
-        auto* ktx2 = reinterpret_cast<ktxTexture2*>(kTexture);
-        textureFormat = static_cast<vk::Format>(ktx2->vkFormat);
-        if (textureFormat == vk::Format::eUndefined)
-        {
-            // If the format is undefined, fall back to a reasonable default
-            textureFormat = vk::Format::eR8G8B8A8Unorm;
-        }
-    }
-    else
-    {
-        // For KTX1 files or if we can't determine the format, use a reasonable default
-        textureFormat = vk::Format::eR8G8B8A8Unorm;
-    }
-
-    textureImageFormat = textureFormat;
-
-    createImage(texWidth, texHeight, textureFormat, vk::ImageTiling::eOptimal,
-        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-        vk::MemoryPropertyFlagBits::eDeviceLocal, textureImage, textureImageMemory);
-
-    transitionImageLayout(textureImage, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-    copyBufferToImage(stagingBuffer, textureImage, texWidth, texHeight);
-    transitionImageLayout(textureImage, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+void Renderer::CreateTextureImageWithKTX(TextureTranscoder::Texture texture)
+{
+    std::cout << "Texture (KTX2): " << texture.width << "x" << texture.height << ", " << texture.mipLevels << " mips, "
+        << vk::to_string(texture.format) << ", " << texture.getData().size() / 1024 << " KB, transcoded in " << texture.transcodeMilliseconds << " ms" << std::endl;
 
-    ktxTexture_Destroy(kTexture);*/
+    textureHandle = textureStreamer.add(TextureStreamer::makeSource(std::move(texture)));
 }
 
-void Renderer::CreateImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory)
+void Renderer::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Image& image, GpuAllocator::Category category)
 {
     vk::ImageCreateInfo imageInfo;
     imageInfo.imageType = vk::ImageType::e2D;
     imageInfo.format = format,
         imageInfo.extent = vk::Extent3D{ width, height, 1 };
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 1,
         imageInfo.samples = vk::SampleCountFlagBits::e1;
     imageInfo.tiling = tiling;
@@ -644,20 +782,7 @@ void Renderer::CreateImage(uint32_t width, uint32_t height, vk::Format format, v
     imageInfo.sharingMode = vk::SharingMode::eExclusive;
     imageInfo.initialLayout = vk::ImageLayout::eUndefined;
 
-    image = vk::raii::Image(VulkanLogicalDevice, imageInfo);
-
-    vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    imageMemory = vk::raii::DeviceMemory(VulkanLogicalDevice, allocInfo);
-    image.bindMemory(imageMemory, 0);
-}
-
-void Renderer::CreateTextureImageView()
-{
-    textureImageView = CreateImageView(textureImage, vk::Format::eR8G8B8A8Srgb, vk::ImageAspectFlagBits::eColor);
+    image = gpuAllocator.createImage(imageInfo, properties, category);
 }
 
 void Renderer::CreateTextureSampler()
@@ -671,6 +796,8 @@ void Renderer::CreateTextureSampler()
     samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
     samplerInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
     samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = vk::LodClampNone;
     samplerInfo.anisotropyEnable = vk::True;
     samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
     samplerInfo.compareEnable = vk::False;
@@ -679,6 +806,17 @@ void Renderer::CreateTextureSampler()
     textureSampler = vk::raii::Sampler(VulkanLogicalDevice, samplerInfo);
 }
 
+void Renderer::CreateMaterials()
+{
+    // The scene texture is the only one loaded so far, so every material the model references samples it
+    int32_t materialCount = 1;
+    for (const Submesh& submesh : modelSubmeshes)
+    {
+        materialCount = std::max(materialCount, submesh.material + 1);
+    }
+    materialTextures.assign(materialCount, textureHandle);
+}
+
 void Renderer::LoadModel()
 {
     /*tinyobj::attrib_t attrib;
@@ -725,13 +863,88 @@ void Renderer::LoadModel()
 }
 
 void Renderer::LoadModelWithGLTF() {
+    auto loadStart = std::chrono::high_resolution_clock::now();
+
+    MeshCache::SourceStamp stamp;
+    if (!MeshCache::stampSource(MODEL_PATH, stamp))
+    {
+        throw std::runtime_error("Failed to find glTF model: " + MODEL_PATH);
+    }
+
+    // Cached vertices are only usable by the vertex layout that packed them
+    auto openModelCache = [&]()
+    {
+        if (!modelCache.open(MODEL_PATH, stamp))
+        {
+            return false;
+        }
+        std::span<const uint32_t> layout = modelCache.getSection<uint32_t>(MeshCacheSection::VertexLayout);
+        if (layout.size() == 1 && layout[0] == GpuVertex::layoutId())
+        {
+            return true;
+        }
+        modelCache.close();
+        return false;
+    };
+
+    // Warm start: the cache matches the source asset by size and write time, nothing is read or decoded
+    bool cacheHit = openModelCache();
+
+    std::vector<char> source;
+    if (!cacheHit)
+    {
+        // The asset was touched or is new; hash its content so an unchanged file still hits
+        source = ReadFile(MODEL_PATH);
+        stamp.contentHash = MeshCache::hashBytes(source.data(), source.size());
+        cacheHit = openModelCache();
+        if (cacheHit)
+        {
+            // Store the new size and write time so the next launch hits without hashing. The file cannot be
+            // written while it is mapped, so it is reopened afterwards; a failed restamp still hits by hash.
+            modelCache.close();
+            MeshCache::restamp(MODEL_PATH, stamp);
+            cacheHit = openModelCache();
+        }
+    }
+
+    if (cacheHit)
+    {
+        modelVertices = modelCache.getSection<GpuVertex::Data>(MeshCacheSection::Vertices);
+        modelIndices = modelCache.getSection<std::byte>(MeshCacheSection::Indices);
+        std::span<const VertexQuantization> quantization = modelCache.getSection<VertexQuantization>(MeshCacheSection::VertexQuantization);
+        modelQuantization = quantization.empty() ? VertexQuantization{} : quantization[0];
+        modelLods = modelCache.getSection<MeshLod>(MeshCacheSection::Lods);
+        modelSubmeshes = modelCache.getSection<Submesh>(MeshCacheSection::Submeshes);
+        std::span<const MeshOptimizer::OptimizationReport> optimizationReport =
+            modelCache.getSection<MeshOptimizer::OptimizationReport>(MeshCacheSection::OptimizationReport);
+
+        double warmMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+        double coldMilliseconds = modelCache.getColdLoadMilliseconds();
+        std::cout << "Model load (warm, mesh cache): " << warmMilliseconds << " ms, "
+            << modelCache.getMappedSize() / 1024 << " KB mapped | cold load was " << coldMilliseconds << " ms";
+        if (warmMilliseconds > 0.0)
+        {
+            std::cout << " (" << coldMilliseconds / warmMilliseconds << "x faster)";
+        }
+        std::cout << std::endl;
+        PrintSubmeshSummary(modelSubmeshes, modelIndices.size_bytes());
+        if (!optimizationReport.empty())
+        {
+            PrintMeshOptimizationReport(optimizationReport[0]);
+        }
+        return;
+    }
+
+    // Cold start: parse the glTF from the bytes already read for hashing
+    auto parseStart = std::chrono::high_resolution_clock::now();
+
     // Use tinygltf to load the model instead of tinyobjloader
     tinygltf::Model    model;
     tinygltf::TinyGLTF loader;
     std::string        err;
     std::string        warn;
 
-    bool ret = loader.LoadBinaryFromFile(&model, &err, &warn, MODEL_PATH);
+    bool ret = loader.LoadBinaryFromMemory(&model, &err, &warn, reinterpret_cast<const unsigned char*>(source.data()), static_cast<unsigned int>(source.size()));
 
     if (!warn.empty())
     {
@@ -748,234 +961,397 @@ void Renderer::LoadModelWithGLTF() {
         throw std::runtime_error("Failed to load glTF model");
     }
 
-    vertices.clear();
-    indices.clear();
+    auto decodeStart = std::chrono::high_resolution_clock::now();
+
+    // Lay out every primitive up front and resolve its accessors and component types once, so the
+    // decode jobs below only run branch-free kernels over disjoint output ranges
+    struct PrimitiveRange
+    {
+        const std::byte* positions;
+        size_t positionStride;
+        const std::byte* normals;
+        size_t normalStride;
+        const std::byte* texCoords;
+        size_t texCoordStride;
+        const std::byte* indexData;
+        size_t indexStride;
+        MeshDecode::WidenIndicesFunction widenIndices;
+        size_t vertexCount;
+        size_t indexCount;
+        int material;
+    };
+
+    auto accessorData = [&model](const tinygltf::Accessor& accessor) -> const std::byte*
+    {
+        const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+        return reinterpret_cast<const std::byte*>(buffer.data.data() + bufferView.byteOffset + accessor.byteOffset);
+    };
+
+    std::vector<PrimitiveRange> primitives;
 
     // Process all meshes in the model
     for (const auto& mesh : model.meshes)
     {
         for (const auto& primitive : mesh.primitives)
         {
-            // Get indices
-            const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
-            const tinygltf::BufferView& indexBufferView = model.bufferViews[indexAccessor.bufferView];
-            const tinygltf::Buffer& indexBuffer = model.buffers[indexBufferView.buffer];
+            PrimitiveRange range{};
 
             // Get vertex positions
             const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.at("POSITION")];
-            const tinygltf::BufferView& posBufferView = model.bufferViews[posAccessor.bufferView];
-            const tinygltf::Buffer& posBuffer = model.buffers[posBufferView.buffer];
-
-            // Get texture coordinates if available
-            bool                        hasTexCoords = primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end();
-            const tinygltf::Accessor* texCoordAccessor = nullptr;
-            const tinygltf::BufferView* texCoordBufferView = nullptr;
-            const tinygltf::Buffer* texCoordBuffer = nullptr;
-
-            if (hasTexCoords)
+            if (posAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || posAccessor.type != TINYGLTF_TYPE_VEC3)
             {
-                texCoordAccessor = &model.accessors[primitive.attributes.at("TEXCOORD_0")];
-                texCoordBufferView = &model.bufferViews[texCoordAccessor->bufferView];
-                texCoordBuffer = &model.buffers[texCoordBufferView->buffer];
+                throw std::runtime_error("Unsupported glTF POSITION format");
             }
+            range.positions = accessorData(posAccessor);
+            range.positionStride = static_cast<size_t>(posAccessor.ByteStride(model.bufferViews[posAccessor.bufferView]));
+            range.vertexCount = posAccessor.count;
 
-            uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
-
-            for (size_t i = 0; i < posAccessor.count; i++)
+            // Get normals if available; primitives without them get smooth normals after decoding
+            auto normalIt = primitive.attributes.find("NORMAL");
+            if (normalIt != primitive.attributes.end())
             {
-                Vertex vertex{};
-
-                const float* pos = reinterpret_cast<const float*>(&posBuffer.data[posBufferView.byteOffset + posAccessor.byteOffset + i * 12]);
-                // Convert from glTF Y-up to Vulkan Y-down (Z-up for Vulkan)
-                vertex.pos = { pos[0], -pos[2], pos[1] };
-
-                if (hasTexCoords)
-                {
-                    const float* texCoord = reinterpret_cast<const float*>(&texCoordBuffer->data[texCoordBufferView->byteOffset + texCoordAccessor->byteOffset + i * 8]);
-                    vertex.texCoord = { texCoord[0], texCoord[1] };
-                }
-                else
+                const tinygltf::Accessor& normalAccessor = model.accessors[normalIt->second];
+                if (normalAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || normalAccessor.type != TINYGLTF_TYPE_VEC3)
                 {
-                    vertex.texCoord = { 0.0f, 0.0f };
+                    throw std::runtime_error("Unsupported glTF NORMAL format");
                 }
-
-                vertex.color = { 1.0f, 1.0f, 1.0f };
-
-                vertices.push_back(vertex);
+                range.normals = accessorData(normalAccessor);
+                range.normalStride = static_cast<size_t>(normalAccessor.ByteStride(model.bufferViews[normalAccessor.bufferView]));
             }
 
-            const unsigned char* indexData = &indexBuffer.data[indexBufferView.byteOffset + indexAccessor.byteOffset];
-            size_t               indexCount = indexAccessor.count;
-            size_t               indexStride = 0;
-
-            // Determine index stride based on component type
-            if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-            {
-                indexStride = sizeof(uint16_t);
-            }
-            else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-            {
-                indexStride = sizeof(uint32_t);
-            }
-            else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+            // Get texture coordinates if available
+            auto texCoordIt = primitive.attributes.find("TEXCOORD_0");
+            if (texCoordIt != primitive.attributes.end())
             {
-                indexStride = sizeof(uint8_t);
+                const tinygltf::Accessor& texCoordAccessor = model.accessors[texCoordIt->second];
+                if (texCoordAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || texCoordAccessor.type != TINYGLTF_TYPE_VEC2)
+                {
+                    throw std::runtime_error("Unsupported glTF TEXCOORD_0 format");
+                }
+                range.texCoords = accessorData(texCoordAccessor);
+                range.texCoordStride = static_cast<size_t>(texCoordAccessor.ByteStride(model.bufferViews[texCoordAccessor.bufferView]));
             }
-            else
+
+            // Get indices; the component type picks the kernel here instead of inside the per-index loop
+            const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
+            switch (indexAccessor.componentType)
             {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                range.widenIndices = &MeshDecode::widenIndices<uint8_t>;
+                range.indexStride = sizeof(uint8_t);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                range.widenIndices = &MeshDecode::widenIndices<uint16_t>;
+                range.indexStride = sizeof(uint16_t);
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                range.widenIndices = &MeshDecode::widenIndices<uint32_t>;
+                range.indexStride = sizeof(uint32_t);
+                break;
+            default:
                 throw std::runtime_error("Unsupported index component type");
             }
+            range.indexData = accessorData(indexAccessor);
+            range.indexCount = indexAccessor.count;
+            range.material = primitive.material;
 
-            indices.reserve(indices.size() + indexCount);
+            primitives.push_back(range);
+        }
+    }
 
-            for (size_t i = 0; i < indexCount; i++)
-            {
-                uint32_t index = 0;
+    // Every primitive becomes a submesh that is decoded, optimized and simplified on its own; its indices
+    // stay local to its vertices so small primitives can keep 16-bit indices
+    struct SubmeshImport
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<MeshLod> lods;
+        MeshOptimizer::OptimizationReport report;
+        MeshBounds bounds;
+        float uvDensity = 0.0f;
+    };
 
-                if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                {
-                    index = *reinterpret_cast<const uint16_t*>(indexData + i * indexStride);
-                }
-                else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-                {
-                    index = *reinterpret_cast<const uint32_t*>(indexData + i * indexStride);
-                }
-                else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                {
-                    index = *reinterpret_cast<const uint8_t*>(indexData + i * indexStride);
-                }
+    std::vector<SubmeshImport> imports(primitives.size());
+    for (size_t primitiveIndex = 0; primitiveIndex < primitives.size(); primitiveIndex++)
+    {
+        imports[primitiveIndex].vertices.resize(primitives[primitiveIndex].vertexCount);
+        imports[primitiveIndex].indices.resize(primitives[primitiveIndex].indexCount);
+    }
+
+    // Split primitives into fixed-size chunks so a single huge primitive still spreads across the workers
+    constexpr size_t DECODE_CHUNK_SIZE = 64 * 1024;
+    struct DecodeChunk
+    {
+        size_t primitiveIndex;
+        bool decodeIndices;
+        size_t begin;
+        size_t count;
+    };
+
+    std::vector<DecodeChunk> chunks;
+    for (size_t primitiveIndex = 0; primitiveIndex < primitives.size(); primitiveIndex++)
+    {
+        const PrimitiveRange& range = primitives[primitiveIndex];
+        for (size_t begin = 0; begin < range.vertexCount; begin += DECODE_CHUNK_SIZE)
+        {
+            chunks.push_back({ primitiveIndex, false, begin, std::min(DECODE_CHUNK_SIZE, range.vertexCount - begin) });
+        }
+        for (size_t begin = 0; begin < range.indexCount; begin += DECODE_CHUNK_SIZE)
+        {
+            chunks.push_back({ primitiveIndex, true, begin, std::min(DECODE_CHUNK_SIZE, range.indexCount - begin) });
+        }
+    }
+
+    jobSystem.parallelFor(chunks.size(), [&](size_t chunkIndex)
+    {
+        const DecodeChunk& chunk = chunks[chunkIndex];
+        const PrimitiveRange& range = primitives[chunk.primitiveIndex];
+        SubmeshImport& submesh = imports[chunk.primitiveIndex];
 
-                indices.push_back(baseVertex + index);
+        if (chunk.decodeIndices)
+        {
+            range.widenIndices(range.indexData + chunk.begin * range.indexStride, chunk.count, 0,
+                submesh.indices.data() + chunk.begin);
+        }
+        else
+        {
+            MeshDecode::assembleVertices(
+                range.positions + chunk.begin * range.positionStride, range.positionStride,
+                range.normals ? range.normals + chunk.begin * range.normalStride : nullptr, range.normalStride,
+                range.texCoords ? range.texCoords + chunk.begin * range.texCoordStride : nullptr, range.texCoordStride,
+                chunk.count, submesh.vertices.data() + chunk.begin);
+        }
+    });
+
+    // Reorder for the post-transform cache, overdraw and linear vertex fetch, then build the LOD chain,
+    // before the result is cached so warm starts get both for free. LOD index ranges are appended after
+    // LOD 0 and share the submesh's optimized vertices.
+    auto optimizeStart = std::chrono::high_resolution_clock::now();
+    jobSystem.parallelFor(imports.size(), [&](size_t primitiveIndex)
+    {
+        SubmeshImport& submesh = imports[primitiveIndex];
+        if (!primitives[primitiveIndex].normals)
+        {
+            MeshDecode::generateNormals(submesh.indices, submesh.vertices.data());
+        }
+
+        submesh.report = MeshOptimizer::optimizeMesh(std::span<uint32_t>(submesh.indices), submesh.vertices);
+        submesh.bounds = MeshBounds::compute(submesh.vertices);
+        submesh.uvDensity = TextureStreamer::computeUvDensity(submesh.indices, submesh.vertices);
+        submesh.lods = submesh.vertices.empty() ? std::vector<MeshLod>{}
+            : MeshSimplifier::buildLodChain(submesh.indices, &submesh.vertices[0].pos.x, sizeof(Vertex), submesh.vertices.size(), submesh.bounds.radius);
+    });
+
+    // Concatenate the submeshes into one vertex buffer and one index buffer of mixed index widths
+    auto packStart = std::chrono::high_resolution_clock::now();
+    size_t vertexCount = 0;
+    for (const SubmeshImport& submesh : imports)
+    {
+        vertexCount += submesh.vertices.size();
+    }
+    vertices.clear();
+    vertices.reserve(vertexCount);
+    packedIndices.clear();
+    submeshes.clear();
+    lods.clear();
+
+    std::vector<MeshOptimizer::OptimizationReport> submeshReports;
+    for (size_t primitiveIndex = 0; primitiveIndex < imports.size(); primitiveIndex++)
+    {
+        const SubmeshImport& submeshImport = imports[primitiveIndex];
+
+        Submesh submesh;
+        submesh.vertexOffset = static_cast<uint32_t>(vertices.size());
+        submesh.vertexCount = static_cast<uint32_t>(submeshImport.vertices.size());
+        submesh.indexSize = submesh.vertexCount <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+        submesh.indexByteOffset = static_cast<uint32_t>((packedIndices.size() + submesh.indexSize - 1) / submesh.indexSize * submesh.indexSize);
+        submesh.indexCount = submeshImport.lods.empty() ? 0 : submeshImport.lods[0].indexCount;
+        submesh.firstLod = static_cast<uint32_t>(lods.size());
+        submesh.lodCount = static_cast<uint32_t>(submeshImport.lods.size());
+        submesh.material = primitives[primitiveIndex].material;
+        submesh.bounds = submeshImport.bounds;
+        submesh.uvDensity = submeshImport.uvDensity;
+
+        packedIndices.resize(submesh.indexByteOffset + submeshImport.indices.size() * submesh.indexSize);
+        std::byte* indexData = packedIndices.data() + submesh.indexByteOffset;
+        if (submesh.indexSize == sizeof(uint16_t))
+        {
+            for (uint32_t index : submeshImport.indices)
+            {
+                uint16_t narrowed = static_cast<uint16_t>(index);
+                memcpy(indexData, &narrowed, sizeof(narrowed));
+                indexData += sizeof(narrowed);
             }
         }
+        else
+        {
+            memcpy(indexData, submeshImport.indices.data(), submeshImport.indices.size() * sizeof(uint32_t));
+        }
+
+        vertices.insert(vertices.end(), submeshImport.vertices.begin(), submeshImport.vertices.end());
+        lods.insert(lods.end(), submeshImport.lods.begin(), submeshImport.lods.end());
+        submeshReports.push_back(submeshImport.report);
+        submeshes.push_back(submesh);
     }
+    imports.clear();
+    MeshOptimizer::OptimizationReport optimizationReport = MeshOptimizer::combineReports(submeshReports);
+
+    // Pack into the compile-time GPU layout; the full-precision vertices are not needed past this point
+    modelQuantization = GpuVertex::computeQuantization(vertices);
+    packedVertices.resize(vertices.size());
+    GpuVertex::pack(vertices, modelQuantization, packedVertices.data());
+    vertices.clear();
+    vertices.shrink_to_fit();
+
+    modelVertices = packedVertices;
+    modelIndices = packedIndices;
+    modelLods = lods;
+    modelSubmeshes = submeshes;
+
+    auto packEnd = std::chrono::high_resolution_clock::now();
+    double readMilliseconds = std::chrono::duration<double, std::milli>(parseStart - loadStart).count();
+    double parseMilliseconds = std::chrono::duration<double, std::milli>(decodeStart - parseStart).count();
+    double decodeMilliseconds = std::chrono::duration<double, std::milli>(optimizeStart - decodeStart).count();
+    double optimizeMilliseconds = std::chrono::duration<double, std::milli>(packStart - optimizeStart).count();
+    double packMilliseconds = std::chrono::duration<double, std::milli>(packEnd - packStart).count();
+    double coldMilliseconds = std::chrono::duration<double, std::milli>(packEnd - loadStart).count();
+
+    const uint32_t layoutId = GpuVertex::layoutId();
+    std::array sections{
+        MeshCache::SectionData::of(MeshCacheSection::Vertices, modelVertices),
+        MeshCache::SectionData::of(MeshCacheSection::Indices, modelIndices),
+        MeshCache::SectionData::of(MeshCacheSection::OptimizationReport, std::span<const MeshOptimizer::OptimizationReport>(&optimizationReport, 1)),
+        MeshCache::SectionData::of(MeshCacheSection::VertexQuantization, std::span<const VertexQuantization>(&modelQuantization, 1)),
+        MeshCache::SectionData::of(MeshCacheSection::VertexLayout, std::span<const uint32_t>(&layoutId, 1)),
+        MeshCache::SectionData::of(MeshCacheSection::Lods, modelLods),
+        MeshCache::SectionData::of(MeshCacheSection::Submeshes, modelSubmeshes) };
+    MeshCache::write(MODEL_PATH, stamp, coldMilliseconds, sections);
+
+    double cacheWriteMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - packEnd).count();
+    std::cout << "Model load (cold): " << coldMilliseconds << " ms (read + hash " << readMilliseconds
+        << " ms, parse " << parseMilliseconds << " ms, decode " << decodeMilliseconds
+        << " ms, optimize + LODs " << optimizeMilliseconds << " ms, pack " << packMilliseconds
+        << " ms), mesh cache write " << cacheWriteMilliseconds << " ms" << std::endl;
+    std::cout << "Vertex layout: " << GpuVertex::stride << " bytes/vertex (" << VertexLayouts::Full::stride
+        << " at full precision), " << modelVertices.size_bytes() / 1024 << " KB vertex data" << std::endl;
+    PrintSubmeshSummary(modelSubmeshes, modelIndices.size_bytes());
+    PrintMeshOptimizationReport(optimizationReport);
 }
 
-void Renderer::CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory)
+void Renderer::CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Buffer& buffer, GpuAllocator::Category category,
+    std::span<const uint32_t> sharingFamilies)
 {
     vk::BufferCreateInfo bufferInfo;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
-    bufferInfo.sharingMode = vk::SharingMode::eExclusive;
-
-    buffer = vk::raii::Buffer(VulkanLogicalDevice, bufferInfo);
-
-    vk::MemoryRequirements memRequirements = buffer.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    bufferInfo.sharingMode = sharingFamilies.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+    if (sharingFamilies.size() > 1)
+    {
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingFamilies.size());
+        bufferInfo.pQueueFamilyIndices = sharingFamilies.data();
+    }
 
-    bufferMemory = vk::raii::DeviceMemory(VulkanLogicalDevice, allocInfo);
-    buffer.bindMemory(*bufferMemory, 0);
+    buffer = gpuAllocator.createBuffer(bufferInfo, properties, category);
 }
 
-void Renderer::CreateDescriptorPool()
+void Renderer::CreateDescriptorAllocators()
 {
-    std::array poolSize{
-     vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_FRAMES_IN_FLIGHT),
-     vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, MAX_FRAMES_IN_FLIGHT + 10)  // +10 for scene render target and extras
-    };
-    vk::DescriptorPoolCreateInfo poolInfo;
-    poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
-    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT + 10;  // +10 for scene render target and extras
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSize.size());
-    poolInfo.pPoolSizes = poolSize.data();
+    descriptorAllocator.init(VulkanLogicalDevice, PERSISTENT_DESCRIPTOR_SETS, DESCRIPTOR_POOL_RATIOS);
 
-    VulkanDescriptorPool = vk::raii::DescriptorPool(VulkanLogicalDevice, poolInfo);
+    frameDescriptorAllocators = std::vector<DescriptorAllocator>(MAX_FRAMES_IN_FLIGHT);
+    for (DescriptorAllocator& allocator : frameDescriptorAllocators)
+    {
+        allocator.init(VulkanLogicalDevice, FRAME_DESCRIPTOR_SETS, DESCRIPTOR_POOL_RATIOS);
+    }
 }
 
 void Renderer::CreateDescriptorSets()
 {
-    std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *VulkanDescriptorSetLayout);
-    vk::DescriptorSetAllocateInfo allocInfo;
-    allocInfo.descriptorPool = VulkanDescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
-    allocInfo.pSetLayouts = layouts.data();
-
     VulkanDescriptorSets.clear();
-    VulkanDescriptorSets = VulkanLogicalDevice.allocateDescriptorSets(allocInfo);
-
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        vk::DescriptorBufferInfo bufferInfo;
-        bufferInfo.buffer = VulkanUniformBuffers[i];
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
+        VulkanDescriptorSets.push_back(descriptorAllocator.allocate(*VulkanDescriptorSetLayout, "Frame"));
+    }
 
-        vk::DescriptorImageInfo imageInfo;
-        imageInfo.sampler = textureSampler;
-        imageInfo.imageView = textureImageView;
-        imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        vk::DescriptorBufferInfo bufferInfo = uniformArena.getDescriptorInfo(sizeof(UniformBufferObject));
 
         vk::WriteDescriptorSet bufferdescriptorWrite;
         bufferdescriptorWrite.dstSet = VulkanDescriptorSets[i];
         bufferdescriptorWrite.dstBinding = 0;
         bufferdescriptorWrite.dstArrayElement = 0;
         bufferdescriptorWrite.descriptorCount = 1;
-        bufferdescriptorWrite.descriptorType = vk::DescriptorType::eUniformBuffer;
+        bufferdescriptorWrite.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
         bufferdescriptorWrite.pBufferInfo = &bufferInfo;
 
-        vk::WriteDescriptorSet imageinfodescriptorWrite;
-        imageinfodescriptorWrite.dstSet = VulkanDescriptorSets[i];
-        imageinfodescriptorWrite.dstBinding = 1;
-        imageinfodescriptorWrite.dstArrayElement = 0;
-        imageinfodescriptorWrite.descriptorCount = 1;
-        imageinfodescriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-        imageinfodescriptorWrite.pImageInfo = &imageInfo;
+        VulkanLogicalDevice.updateDescriptorSets(bufferdescriptorWrite, {});
+    }
+
+    objectDescriptorSet = descriptorAllocator.allocate(*objectDescriptorSetLayout, "Object");
+
+    vk::DescriptorBufferInfo objectBufferInfo = uniformArena.getDescriptorInfo(sizeof(ObjectUniforms));
+    vk::WriteDescriptorSet objectWrite{ objectDescriptorSet, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &objectBufferInfo, nullptr };
+    VulkanLogicalDevice.updateDescriptorSets(objectWrite, {});
+}
 
-        std::array descriptorWrites{ bufferdescriptorWrite , imageinfodescriptorWrite };
-        VulkanLogicalDevice.updateDescriptorSets(descriptorWrites, {});
+void Renderer::UpdateBindlessTextures()
+{
+    // A texture whose streamed view changed gets a fresh slot; earlier frames may still be sampling the old one,
+    // which the table only hands out again once they have retired
+    bindlessTextures.beginFrame();
+    textureSlots.resize(textureStreamer.getTextureCount());
+    for (TextureStreamer::Handle handle = 0; handle < textureSlots.size(); handle++)
+    {
+        uint64_t generation = textureStreamer.getViewGeneration(handle);
+        std::optional<BindlessSlot>& slot = textureSlots[handle];
+        if (slot && slot->viewGeneration == generation)
+        {
+            continue;
+        }
+        if (slot)
+        {
+            bindlessTextures.release(slot->index);
+        }
+        slot = BindlessSlot{ generation, bindlessTextures.add(textureStreamer.getImageView(handle)) };
     }
 }
 
 void Renderer::CreateVertexBuffer()
 {
-    vk::DeviceSize         bufferSize = sizeof(vertices[0]) * vertices.size();
-    vk::raii::Buffer       stagingBuffer({});
-    vk::raii::DeviceMemory stagingBufferMemory({});
-    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingBuffer, stagingBufferMemory);
-
-    void* dataStaging = stagingBufferMemory.mapMemory(0, bufferSize);
-    memcpy(dataStaging, vertices.data(), bufferSize);
-    stagingBufferMemory.unmapMemory();
-
-    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, VulkanVertexBuffer, VulkanVertexBufferMemory);
-
-    copyBuffer(stagingBuffer, VulkanVertexBuffer, bufferSize);
+    CreateGeometryBuffer(std::as_bytes(modelVertices), vk::BufferUsageFlagBits::eVertexBuffer, VulkanVertexBuffer,
+        vk::PipelineStageFlagBits2::eVertexAttributeInput, vk::AccessFlagBits2::eVertexAttributeRead);
 }
 
 void Renderer::CreateIndexBuffer()
 {
-    vk::DeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    vk::raii::Buffer       stagingBuffer({});
-    vk::raii::DeviceMemory stagingBufferMemory({});
-    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingBuffer, stagingBufferMemory);
-
-    void* data = stagingBufferMemory.mapMemory(0, bufferSize);
-    memcpy(data, indices.data(), (size_t)bufferSize);
-    stagingBufferMemory.unmapMemory();
+    CreateGeometryBuffer(modelIndices, vk::BufferUsageFlagBits::eIndexBuffer, VulkanIndexBuffer,
+        vk::PipelineStageFlagBits2::eIndexInput, vk::AccessFlagBits2::eIndexRead);
+}
 
-    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, VulkanIndexBuffer, VulkanIndexBufferMemory);
+void Renderer::CreateGeometryBuffer(std::span<const std::byte> data, vk::BufferUsageFlags usage, GpuAllocator::Buffer& buffer,
+    vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+    // Where the CPU can write VRAM, the data goes straight into the final buffer: no staging copy, no transfer
+    // submission. Host writes before the frame's queue submit are visible to it without a barrier.
+    if (gpuAllocator.prefersDirectWrite(data.size(), GpuAllocator::WritePattern::Once))
+    {
+        CreateBuffer(data.size(), usage, GpuAllocator::getDirectWriteProperties(), buffer, GpuAllocator::Category::Geometry);
+        memcpy(buffer.getMappedData(), data.data(), data.size());
+        directGeometryBytes += data.size();
+        return;
+    }
 
-    copyBuffer(stagingBuffer, VulkanIndexBuffer, bufferSize);
+    CreateBuffer(data.size(), usage | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal, buffer, GpuAllocator::Category::Geometry);
+    uploadService.uploadBuffer(data, *buffer, 0, dstStage, dstAccess);
 }
 
 void Renderer::CreateUniformBuffers()
 {
-    VulkanUniformBuffers.clear();
-    VulkanUniformBuffersMemory.clear();
-    VulkanUniformBuffersMapped.clear();
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
-        vk::raii::Buffer buffer({});
-        vk::raii::DeviceMemory bufferMem({});
-        CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, buffer, bufferMem);
-        VulkanUniformBuffers.emplace_back(std::move(buffer));
-        VulkanUniformBuffersMemory.emplace_back(std::move(bufferMem));
-        VulkanUniformBuffersMapped.emplace_back(VulkanUniformBuffersMemory[i].mapMemory(0, bufferSize));
-    }
+    // Light culling reads the view block from the compute queue
+    uniformArena.init(gpuAllocator, VulkanPhysicalDevice.getProperties().limits, MAX_FRAMES_IN_FLIGHT, UNIFORM_ARENA_BYTES_PER_FRAME,
+        GetComputeSharingFamilies());
 }
 
 void Renderer::CreateCommandBuffers()
@@ -992,23 +1368,30 @@ void Renderer::CreateCommandBuffers()
 
 void Renderer::CreateSyncObjects()
 {
-    assert(VulkanPresentCompleteSemaphores.empty() && VulkanRenderFinishedSemaphores.empty() && inFlightFences.empty());
+    assert(VulkanPresentCompleteSemaphores.empty());
 
-    for (size_t i = 0; i < VulkanSwapChainImages.size(); i++)
-    {
-        VulkanRenderFinishedSemaphores.emplace_back(VulkanLogicalDevice, vk::SemaphoreCreateInfo());
-    }
+    CreateRenderFinishedSemaphores();
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        vk::FenceCreateInfo FenceCreateInfo;
-        FenceCreateInfo.flags = vk::FenceCreateFlagBits::eSignaled;
-
         VulkanPresentCompleteSemaphores.emplace_back(VulkanLogicalDevice, vk::SemaphoreCreateInfo());
-        inFlightFences.emplace_back(VulkanLogicalDevice, FenceCreateInfo);
     }
+
+    frameTimeline.init(VulkanLogicalDevice);
 };
 
+void Renderer::CreateRenderFinishedSemaphores()
+{
+    assert(VulkanRenderFinishedSemaphores.empty());
+
+    // One per swapchain image: presentation of an image waits on it, and the image is only acquired again once
+    // that present went through
+    for (size_t i = 0; i < VulkanSwapChainImages.size(); i++)
+    {
+        VulkanRenderFinishedSemaphores.emplace_back(VulkanLogicalDevice, vk::SemaphoreCreateInfo());
+    }
+}
+
 void Renderer::UpdateUniformBuffer(uint32_t currentImage)
 {
     static auto startTime = std::chrono::high_resolution_clock::now();
@@ -1016,162 +1399,141 @@ void Renderer::UpdateUniformBuffer(uint32_t currentImage)
     auto  currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float>(currentTime - startTime).count();
 
+    // The frame that last used this slot has completed, so its part of the arena is free again
+    uniformArena.beginFrame(currentImage);
+
     UniformBufferObject ubo{};
-    ubo.model = rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.proj = glm::perspective(glm::radians(45.0f), static_cast<float>(VulkanSwapChainExtent.width) / static_cast<float>(VulkanSwapChainExtent.height), 0.1f, 10.0f);
+    modelMatrix = rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.view = lookAt(cameraPosition, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.proj = glm::perspective(cameraFovY, static_cast<float>(VulkanSwapChainExtent.width) / static_cast<float>(VulkanSwapChainExtent.height), 0.1f, 10.0f);
     ubo.proj[1][1] *= -1;
-    ubo.viewPos = glm::vec3(2.0f, 2.0f, 2.0f);
+    ubo.viewPos = cameraPosition;
     ubo.lightPos = glm::vec3(0.0f, 0.0f, 2.0f);
     ubo.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
     ubo.lightRadius = 10.0f;
     ubo.exposure = 1.0f;
+    // Tiles cover the rendered region only; the tile buffers are sized for the full target
     ubo.numTiles = glm::vec2(
-        static_cast<float>((VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE),
-        static_cast<float>((VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE)
+        static_cast<float>((sceneRenderExtent.width + TILE_SIZE - 1) / TILE_SIZE),
+        static_cast<float>((sceneRenderExtent.height + TILE_SIZE - 1) / TILE_SIZE)
     );
 
-    if (!VulkanUniformBuffersMapped.empty()) {
-        memcpy(VulkanUniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
-    }
+    // The view block is the frame's first allocation, and every slice holds far more than one. Should it still not
+    // fit, the arena has counted the overflow and this frame skips the passes that read the block.
+    std::optional<UniformArena::Allocation> viewUniforms = uniformArena.push(ubo);
+    frameUniformsValid = viewUniforms.has_value();
+    frameUniformOffset = viewUniforms ? viewUniforms->offset : 0;
 }
 
 void Renderer::recordCommandBuffer(uint32_t imageIndex)
 {
     auto& commandBuffer = VulkanCommandBuffers[frameIndex];
     commandBuffer.begin({});
-    
-    // Transition the swapchain image to COLOR_ATTACHMENT_OPTIMAL
-    transition_image_layout(
-        VulkanSwapChainImages[imageIndex],
-        vk::ImageLayout::eUndefined,
-        vk::ImageLayout::eColorAttachmentOptimal,
-        {},
-        vk::AccessFlagBits2::eColorAttachmentWrite,
-        vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-        vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-        vk::ImageAspectFlagBits::eColor);
+
+    // Take ownership of finished uploads before anything in this frame reads them
+    frameUploadWaitValue = uploadService.recordAcquires(commandBuffer);
+    textureStreamer.beginFrame();
+    UpdateBindlessTextures();
+
+    // Sets, command buffers and timestamps of this frame slot's previous frame are no longer in use
+    frameDescriptorAllocators[frameIndex].reset();
+    commandRecorder.beginFrame(frameIndex);
+    asyncCompute.beginFrame(frameIndex);
+    asyncCompute.writeGraphicsBegin(commandBuffer);
+    AllocateForwardPlusDescriptorSet();
     
     // ==================== LIGHT CULLING (Compute) ====================
-    RecordLightCulling(imageIndex);
-    
-    // ==================== FORWARD+ RENDER to Scene Texture ====================
-    RecordForwardPlusPass(imageIndex);
-    
-    // Transition scene color image to shader read optimal for ImGui display
-    {
-        vk::ImageMemoryBarrier2 barrier;
-        barrier.srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
-        barrier.srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
-        barrier.dstStageMask = vk::PipelineStageFlagBits2::eFragmentShader;
-        barrier.dstAccessMask = vk::AccessFlagBits2::eShaderRead;
-        barrier.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
-        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = *sceneRenderTarget.getColorImage();
-        barrier.subresourceRange = {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
-
-        vk::DependencyInfo dependency_info;
-        dependency_info.dependencyFlags = {};
-        dependency_info.imageMemoryBarrierCount = 1;
-        dependency_info.pImageMemoryBarriers = &barrier;
-
-        commandBuffer.pipelineBarrier2(dependency_info);
+    // On the async compute queue the culling overlaps the previous frame's ImGui pass and this frame's early
+    // graphics work; Render() makes the graphics submission wait for it before fragment shading
+    lightCullingAsync = asyncCompute.isAsync() && asyncLightCulling && frameUniformsValid;
+    if (lightCullingAsync)
+    {
+        RecordLightCulling(asyncCompute.begin());
     }
-    
-    // ==================== RENDER IMGUI WINDOW with Scene ====================
-    // Render ImGui on top (includes scene texture in a window)
-    imGui.drawFrame(commandBuffer, VulkanSwapChainImageViews[imageIndex], VulkanSwapChainExtent);
-    
-    // Transition the swapchain image to PRESENT_SRC
-    transition_image_layout(
-        VulkanSwapChainImages[imageIndex],
-        vk::ImageLayout::eColorAttachmentOptimal,
-        vk::ImageLayout::ePresentSrcKHR,
-        vk::AccessFlagBits2::eColorAttachmentWrite,
-        {},
-        vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-        vk::PipelineStageFlagBits2::eBottomOfPipe,
-        vk::ImageAspectFlagBits::eColor);
-    
-    commandBuffer.end();
-}
-
-
-
 
+    // ==================== FORWARD+ and IMGUI ====================
+    BuildFrameGraph(imageIndex);
+    frameGraph.execute(commandBuffer);
 
-void Renderer::transition_image_layout(
-    vk::Image               image,
-    vk::ImageLayout         old_layout,
-    vk::ImageLayout         new_layout,
-    vk::AccessFlags2        src_access_mask,
-    vk::AccessFlags2        dst_access_mask,
-    vk::PipelineStageFlags2 src_stage_mask,
-    vk::PipelineStageFlags2 dst_stage_mask,
-    vk::ImageAspectFlags    image_aspect_flags)
-{
-    vk::ImageMemoryBarrier2 barrier;
-    barrier.srcStageMask = src_stage_mask;
-    barrier.srcAccessMask = src_access_mask;
-    barrier.dstStageMask = dst_stage_mask;
-    barrier.dstAccessMask = dst_access_mask;
-    barrier.oldLayout = old_layout;
-    barrier.newLayout = new_layout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange = {
-                image_aspect_flags,
-                 0,
-                1,
-                0,
-                1 };
-
-    vk::DependencyInfo dependency_info;
-    dependency_info.dependencyFlags = {};
-    dependency_info.imageMemoryBarrierCount = 1;
-    dependency_info.pImageMemoryBarriers = &barrier;
-
-    VulkanCommandBuffers[frameIndex].pipelineBarrier2(dependency_info);
+    asyncCompute.writeGraphicsEnd(commandBuffer);
+    commandBuffer.end();
 }
 
-void Renderer::transitionImageLayout(const vk::raii::Image& image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout)
+void Renderer::BuildFrameGraph(uint32_t imageIndex)
 {
-    auto commandBuffer = beginSingleTimeCommands();
-    vk::ImageMemoryBarrier barrier;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.image = image;
-    barrier.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 };
-
-    vk::PipelineStageFlags sourceStage;
-    vk::PipelineStageFlags destinationStage;
-
-    if (oldLayout == vk::ImageLayout::eUndefined && newLayout == vk::ImageLayout::eTransferDstOptimal)
+    frameGraph.reset();
+
+    // The acquire semaphore is waited on at SWAPCHAIN_ACQUIRE_STAGE, so the image's first barrier chains onto that
+    // wait; the previous contents are never needed
+    RenderGraph::ResourceHandle swapchainImage = frameGraph.importImage("Swapchain", VulkanSwapChainImages[imageIndex], vk::ImageAspectFlagBits::eColor,
+        { SWAPCHAIN_ACQUIRE_STAGE, {}, vk::ImageLayout::eUndefined });
+    frameGraph.exportResource(swapchainImage, RenderGraph::Usage::Present);
+
+    // This slot's tile buffers were last used by a completed frame; the async culling is ordered by a semaphore
+    RenderGraph::ResourceHandle tileLightIndices = frameGraph.importBuffer("Tile Light Indices", tileLightIndexBuffers[frameIndex], {});
+    RenderGraph::ResourceHandle tileLightCounts = frameGraph.importBuffer("Tile Light Counts", tileCountBuffers[frameIndex], {});
+    if (!lightCullingAsync && frameUniformsValid)
     {
-        barrier.srcAccessMask = {};
-        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-
-        sourceStage = vk::PipelineStageFlagBits::eTopOfPipe;
-        destinationStage = vk::PipelineStageFlagBits::eTransfer;
+        RenderGraph::PassHandle cullingPass = frameGraph.addPass("Light Culling", [this](const vk::raii::CommandBuffer& commandBuffer)
+        {
+            RecordLightCulling(commandBuffer);
+        });
+        frameGraph.write(cullingPass, tileLightIndices, RenderGraph::Usage::ComputeStorageWrite, true);
+        frameGraph.write(cullingPass, tileLightCounts, RenderGraph::Usage::ComputeStorageWrite, true);
     }
-    else if (oldLayout == vk::ImageLayout::eTransferDstOptimal && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal)
+
+    RenderGraph::ResourceHandle sceneColor = 0;
+    bool hasScene = sceneRenderTarget.getWidth() > 0 && sceneRenderTarget.getHeight() > 0;
+    if (hasScene)
     {
-        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        // Last frame's ImGui pass may still sample the color target, and the transient depth may alias memory
+        // that earlier attachments wrote
+        sceneColor = frameGraph.importImage("Scene Color", *sceneRenderTarget.getColorImage(), vk::ImageAspectFlagBits::eColor, sceneColorState);
+        RenderGraph::ResourceHandle sceneDepth = frameGraph.importImage("Scene Depth", sceneRenderTarget.getDepthImage(), vk::ImageAspectFlagBits::eDepth,
+            { vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests | vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+              vk::AccessFlagBits2::eDepthStencilAttachmentWrite | vk::AccessFlagBits2::eColorAttachmentWrite, vk::ImageLayout::eUndefined });
+
+        // Without this frame's view uniforms the target keeps last frame's image
+        if (frameUniformsValid)
+        {
+            // Dynamic resolution times this pass alone, behind the barrier the graph records in front of it
+            RenderGraph::PassHandle scenePass = frameGraph.addPass("Forward+", [this](const vk::raii::CommandBuffer& commandBuffer)
+            {
+                dynamicResolution.writeSceneBegin(commandBuffer);
+                RecordForwardPlusPass(commandBuffer);
+                dynamicResolution.writeSceneEnd(commandBuffer);
+            });
+            frameGraph.write(scenePass, sceneColor, RenderGraph::Usage::ColorAttachmentWrite, true);
+            frameGraph.write(scenePass, sceneDepth, RenderGraph::Usage::DepthAttachmentWrite, true);
+            frameGraph.read(scenePass, tileLightIndices, RenderGraph::Usage::FragmentStorageRead);
+            frameGraph.read(scenePass, tileLightCounts, RenderGraph::Usage::FragmentStorageRead);
+        }
+    }
 
-        sourceStage = vk::PipelineStageFlagBits::eTransfer;
-        destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
+    // ImGui draws the scene texture in its viewport window on top of the swapchain image
+    RenderGraph::PassHandle imGuiPass = frameGraph.addPass("ImGui", [this, imageIndex](const vk::raii::CommandBuffer& commandBuffer)
+    {
+        imGui.drawFrame(commandBuffer, frameIndex, VulkanSwapChainImageViews[imageIndex], VulkanSwapChainExtent);
+    });
+    frameGraph.write(imGuiPass, swapchainImage, RenderGraph::Usage::ColorAttachmentWrite, true);
+    if (hasScene)
+    {
+        frameGraph.read(imGuiPass, sceneColor, RenderGraph::Usage::FragmentSampled);
     }
-    else
+
+    frameGraph.compile();
+    if (hasScene)
     {
-        throw std::invalid_argument("unsupported layout transition!");
+        sceneColorState = frameGraph.getFinalState(sceneColor);
     }
-    commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, nullptr, barrier);
 
-    endSingleTimeCommands(commandBuffer);
+    if (dumpFrameGraph)
+    {
+        dumpFrameGraph = false;
+        std::ofstream file(FRAME_GRAPH_DUMP_PATH);
+        file << frameGraph.toGraphviz();
+        std::cout << "Frame graph written to " << FRAME_GRAPH_DUMP_PATH << std::endl;
+    }
 }
 
 vk::Extent2D Renderer::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities)
@@ -1188,12 +1550,6 @@ vk::Extent2D Renderer::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabi
         std::clamp<uint32_t>(WindowHeight, capabilities.minImageExtent.height, capabilities.maxImageExtent.height) };
 }
 
-void Renderer::CleanupSwapChain()
-{
-    VulkanSwapChainImageViews.clear();
-    VulkanSwapChain = nullptr;
-}
-
 void Renderer::RecreateSwapChain()
 {
     int width = 0, height = 0;
@@ -1204,30 +1560,47 @@ void Renderer::RecreateSwapChain()
         glfwWaitEvents();
     }
 
-    VulkanLogicalDevice.waitIdle();
-
-    CleanupSwapChain();
-    CleanupForwardPlus();
-    
-    CreateSwapChain();
+    // Nothing waits for the GPU here: every frame submitted so far may still use what is replaced, so it goes to
+    // the deletion queue until the last of them completed
+    uint64_t retireFrame = frameTimeline.getSubmittedFrame();
+    // Presentation is not tracked by the timeline. Frames submitted after the old swapchain's last present come
+    // after it on the queue, so once they completed the presentation engine has let go of its images and
+    // semaphores as well.
+    uint64_t swapChainRetireFrame = retireFrame + MAX_FRAMES_IN_FLIGHT;
+
+    vk::raii::SwapchainKHR oldSwapChain = std::move(VulkanSwapChain);
+    CreateSwapChain(*oldSwapChain);
+    deletionQueue.push(swapChainRetireFrame, std::move(VulkanSwapChainImageViews));
+    deletionQueue.push(swapChainRetireFrame, std::move(oldSwapChain));
+    deletionQueue.push(swapChainRetireFrame, std::move(VulkanRenderFinishedSemaphores));
+    VulkanSwapChainImageViews.clear();
+    VulkanRenderFinishedSemaphores.clear();
     CreateImageViews();
-    CreateDepthResources();
+    // The image count may differ from the old swapchain's
+    CreateRenderFinishedSemaphores();
+    swapChainRecreations++;
     
     // Recreate scene render target with new size (after swapchain is recreated)
     if (VulkanSwapChainExtent.width > 0 && VulkanSwapChainExtent.height > 0) {
-        sceneRenderTarget.resize(VulkanLogicalDevice, VulkanPhysicalDevice,
+        transientAttachments.retire(deletionQueue, retireFrame);
+        sceneColorState = {};
+        sceneRenderTarget.resize(VulkanLogicalDevice, gpuAllocator, transientAttachments, deletionQueue, retireFrame,
             VulkanSwapChainExtent.width, VulkanSwapChainExtent.height,
-            VulkanSwapChainSurfaceFormat.format, findDepthFormat());
+            VulkanSwapChainSurfaceFormat.format, findDepthFormat(),
+            static_cast<uint32_t>(FramePass::Scene), static_cast<uint32_t>(FramePass::Scene));
+        transientAttachments.build();
         // Clear and re-register texture with ImGui
         imGui.clearSceneTexture();
         imGui.setSceneTextureInfo(&sceneRenderTarget.getSampler(), &sceneRenderTarget.getColorImageView(), sceneRenderTarget.getVkDescriptorSet());
     }
     
-    // Reinitialize Forward+ buffers
-    CreateForwardPlusLightBuffer();
-    
-    // Update descriptor sets
-    CreateForwardPlusDescriptorSets();
+    // Tile buffers follow the new extent; the next frame's Forward+ set picks them up. Compute work of a frame
+    // completes before its graphics work, so the frame timeline covers the async culling queue too.
+    deletionQueue.push(retireFrame, std::move(tileLightIndexBuffers));
+    deletionQueue.push(retireFrame, std::move(tileCountBuffers));
+    tileLightIndexBuffers.clear();
+    tileCountBuffers.clear();
+    CreateForwardPlusTileBuffers();
 }
 
 std::vector<const char*> Renderer::getRequiredExtensions() {
@@ -1246,8 +1619,9 @@ void Renderer::CreateForwardPlusLightBuffer()
 {
     // Create buffer for light data
     vk::DeviceSize bufferSize = sizeof(ForwardPlusLight) * MAX_LIGHTS;
-    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, forwardPlusLightBuffer, forwardPlusLightBufferMemory);
-    forwardPlusLightBufferMapped = forwardPlusLightBufferMemory.mapMemory(0, bufferSize);
+    CreateBuffer(bufferSize, vk::BufferUsageFlagBits::eUniformBuffer, gpuAllocator.getHostWriteProperties(bufferSize, GpuAllocator::WritePattern::PerFrame), forwardPlusLightBuffer, GpuAllocator::Category::ForwardPlus,
+        GetComputeSharingFamilies());
+    forwardPlusLightBufferMapped = forwardPlusLightBuffer.getMappedData();
     
     // Initialize with default lights (commented out - no real lights yet)
     // std::vector<ForwardPlusLight> lights(MAX_LIGHTS);
@@ -1258,26 +1632,39 @@ void Renderer::CreateForwardPlusLightBuffer()
     //     lights[i].intensity = 1.0f;
     // }
     // memcpy(forwardPlusLightBufferMapped, lights.data(), sizeof(ForwardPlusLight) * MAX_LIGHTS);
-    
+
+    CreateForwardPlusTileBuffers();
+}
+
+void Renderer::CreateForwardPlusTileBuffers()
+{
     // Create tile light index buffer (max lights per tile * num tiles)
     uint32_t tileCountX = (VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE;
     uint32_t tileCountY = (VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE;
     uint32_t tileCount = tileCountX * tileCountY;
     vk::DeviceSize tileBufferSize = sizeof(uint32_t) * MAX_LIGHTS_PER_TILE * tileCount;
-    
-    CreateBuffer(tileBufferSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, tileLightIndexBuffer, tileLightIndexBufferMemory);
-    
-    // Create tile count buffer (atomic counter for culling)
     vk::DeviceSize tileCountBufferSize = sizeof(uint32_t) * tileCount;
-    CreateBuffer(tileCountBufferSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, tileCountBuffer, tileCountBufferMemory);
+
+    // One set of tile buffers per frame slot: culling for the next frame can then run on the compute queue while
+    // this frame's fragments still read its lists
+    tileLightIndexBuffers.clear();
+    tileCountBuffers.clear();
+    for (uint32_t slot = 0; slot < MAX_FRAMES_IN_FLIGHT; slot++)
+    {
+        CreateBuffer(tileBufferSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, tileLightIndexBuffers.emplace_back(nullptr),
+            GpuAllocator::Category::ForwardPlus, GetComputeSharingFamilies());
+
+        // Create tile count buffer (atomic counter for culling)
+        CreateBuffer(tileCountBufferSize, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, tileCountBuffers.emplace_back(nullptr),
+            GpuAllocator::Category::ForwardPlus, GetComputeSharingFamilies());
+    }
 }
 
 void Renderer::CreateForwardPlusDescriptorSetLayout()
 {
-    // Forward+ descriptor layout (without tile buffers for now)
+    // Forward+ descriptor layout (without tile buffers for now). Binding 1 is unused: textures are read from the bindless table in set 2
     std::array bindings = {
-        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute, nullptr),
-        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr),
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute, nullptr),
         vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
         // Add these back for tile-based culling:
         // vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eFragment, nullptr),
@@ -1288,80 +1675,43 @@ void Renderer::CreateForwardPlusDescriptorSetLayout()
     forwardPlusDescriptorSetLayout = vk::raii::DescriptorSetLayout(VulkanLogicalDevice, layoutInfo);
 }
 
-void Renderer::CreateForwardPlusDescriptorPool()
+void Renderer::AllocateForwardPlusDescriptorSet()
 {
-    std::array poolSize = {
-        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_FRAMES_IN_FLIGHT * 2),
-        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, MAX_FRAMES_IN_FLIGHT),
-        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, MAX_FRAMES_IN_FLIGHT * 2)
-    };
+    forwardPlusDescriptorSet = frameDescriptorAllocators[frameIndex].allocate(*forwardPlusDescriptorSetLayout, "Forward+");
+
+    vk::DescriptorBufferInfo uboInfo = uniformArena.getDescriptorInfo(sizeof(UniformBufferObject));
     
-    vk::DescriptorPoolCreateInfo poolInfo;
-    poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
-    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSize.size());
-    poolInfo.pPoolSizes = poolSize.data();
+    vk::DescriptorBufferInfo lightBufferInfo;
+    lightBufferInfo.buffer = forwardPlusLightBuffer;
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range = sizeof(ForwardPlusLight) * MAX_LIGHTS;
     
-    forwardPlusDescriptorPool = vk::raii::DescriptorPool(VulkanLogicalDevice, poolInfo);
-}
-
-void Renderer::CreateForwardPlusDescriptorSets()
-{
-    forwardPlusDescriptorSets.clear();
+    // Tile buffer bindings (for Forward+ light culling) - commented out for now
+    /*
+    vk::DescriptorBufferInfo tileIndexBufferInfo;
+    tileIndexBufferInfo.buffer = tileLightIndexBuffers[frameIndex];
+    tileIndexBufferInfo.offset = 0;
+    tileIndexBufferInfo.range = sizeof(uint32_t) * MAX_LIGHTS_PER_TILE * 
+        ((VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE) * 
+        ((VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE);
     
-    std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, *forwardPlusDescriptorSetLayout);
-    vk::DescriptorSetAllocateInfo allocInfo;
-    allocInfo.descriptorPool = forwardPlusDescriptorPool;
-    allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
-    allocInfo.pSetLayouts = layouts.data();
+    uint32_t tileCountX = (VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t tileCountY = (VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE;
+    vk::DescriptorBufferInfo tileCountBufferInfo;
+    tileCountBufferInfo.buffer = tileCountBuffers[frameIndex];
+    tileCountBufferInfo.offset = 0;
+    tileCountBufferInfo.range = sizeof(uint32_t) * tileCountX * tileCountY;
+    */
     
-    forwardPlusDescriptorSets = VulkanLogicalDevice.allocateDescriptorSets(allocInfo);
+    std::array descriptorWrites = {
+        vk::WriteDescriptorSet{forwardPlusDescriptorSet, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &uboInfo, nullptr},
+        vk::WriteDescriptorSet{forwardPlusDescriptorSet, 2, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &lightBufferInfo, nullptr}
+        // Add these back when enabling tile-based light culling:
+        // vk::WriteDescriptorSet{forwardPlusDescriptorSet, 3, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &tileIndexBufferInfo, nullptr},
+        // vk::WriteDescriptorSet{forwardPlusDescriptorSet, 4, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &tileCountBufferInfo, nullptr}
+    };
     
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        vk::DescriptorBufferInfo uboInfo;
-        uboInfo.buffer = VulkanUniformBuffers[i];
-        uboInfo.offset = 0;
-        uboInfo.range = sizeof(UniformBufferObject);
-        
-        vk::DescriptorImageInfo imageInfo;
-        imageInfo.sampler = textureSampler;
-        imageInfo.imageView = textureImageView;
-        imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-        
-        vk::DescriptorBufferInfo lightBufferInfo;
-        lightBufferInfo.buffer = forwardPlusLightBuffer;
-        lightBufferInfo.offset = 0;
-        lightBufferInfo.range = sizeof(ForwardPlusLight) * MAX_LIGHTS;
-        
-        // Tile buffer bindings (for Forward+ light culling) - commented out for now
-        /*
-        vk::DescriptorBufferInfo tileIndexBufferInfo;
-        tileIndexBufferInfo.buffer = tileLightIndexBuffer;
-        tileIndexBufferInfo.offset = 0;
-        tileIndexBufferInfo.range = sizeof(uint32_t) * MAX_LIGHTS_PER_TILE * 
-            ((VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE) * 
-            ((VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE);
-        
-        uint32_t tileCountX = (VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE;
-        uint32_t tileCountY = (VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE;
-        vk::DescriptorBufferInfo tileCountBufferInfo;
-        tileCountBufferInfo.buffer = tileCountBuffer;
-        tileCountBufferInfo.offset = 0;
-        tileCountBufferInfo.range = sizeof(uint32_t) * tileCountX * tileCountY;
-        */
-        
-        std::array descriptorWrites = {
-            vk::WriteDescriptorSet{forwardPlusDescriptorSets[i], 0, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &uboInfo, nullptr},
-            vk::WriteDescriptorSet{forwardPlusDescriptorSets[i], 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr},
-            vk::WriteDescriptorSet{forwardPlusDescriptorSets[i], 2, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &lightBufferInfo, nullptr}
-            // Add these back when enabling tile-based light culling:
-            // vk::WriteDescriptorSet{forwardPlusDescriptorSets[i], 3, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &tileIndexBufferInfo, nullptr},
-            // vk::WriteDescriptorSet{forwardPlusDescriptorSets[i], 4, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &tileCountBufferInfo, nullptr}
-        };
-        
-        VulkanLogicalDevice.updateDescriptorSets(descriptorWrites, {});
-    }
+    VulkanLogicalDevice.updateDescriptorSets(descriptorWrites, {});
 }
 
 void Renderer::CreateLightCullingPipeline()
@@ -1391,10 +1741,16 @@ void Renderer::CreateForwardPlusPipeline()
     vk::raii::ShaderModule vertexShaderModule = CreateShaderModule(ReadFile("../Engine/Binaries/Shaders/ForwardPlus_Vertex.vert.glsl.spv"));
     vk::raii::ShaderModule fragmentShaderModule = CreateShaderModule(ReadFile("../Engine/Binaries/Shaders/ForwardPlus_Fragment.frag.glsl.spv"));
     
+    // The vertex shader decodes octahedral normals only for layouts that store them
+    vk::Bool32 octahedralNormals = GpuVertex::octahedralNormals ? vk::True : vk::False;
+    vk::SpecializationMapEntry octahedralNormalsEntry(0, 0, sizeof(vk::Bool32));
+    vk::SpecializationInfo vertexSpecialization(1, &octahedralNormalsEntry, sizeof(octahedralNormals), &octahedralNormals);
+
     vk::PipelineShaderStageCreateInfo vertShaderStageInfo;
     vertShaderStageInfo.stage = vk::ShaderStageFlagBits::eVertex;
     vertShaderStageInfo.module = vertexShaderModule;
     vertShaderStageInfo.pName = "main";
+    vertShaderStageInfo.pSpecializationInfo = &vertexSpecialization;
     
     vk::PipelineShaderStageCreateInfo fragShaderStageInfo;
     fragShaderStageInfo.stage = vk::ShaderStageFlagBits::eFragment;
@@ -1403,8 +1759,8 @@ void Renderer::CreateForwardPlusPipeline()
     
     vk::PipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
     
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    constexpr auto bindingDescription = GpuVertex::getBindingDescription();
+    constexpr auto attributeDescriptions = GpuVertex::getAttributeDescriptions();
     
     vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
     vertexInputInfo.vertexBindingDescriptionCount = 1;
@@ -1457,9 +1813,17 @@ void Renderer::CreateForwardPlusPipeline()
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
     
+    std::array setLayouts = { *forwardPlusDescriptorSetLayout, *objectDescriptorSetLayout, *bindlessTextures.getLayout() };
     vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &*forwardPlusDescriptorSetLayout;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    
+    std::array pushConstantRanges = {
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(VertexQuantization)),
+        vk::PushConstantRange(vk::ShaderStageFlagBits::eFragment, sizeof(VertexQuantization), sizeof(MaterialConstants))
+    };
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
     
     forwardPlusPipelineLayout = vk::raii::PipelineLayout(VulkanLogicalDevice, pipelineLayoutInfo);
     
@@ -1488,72 +1852,20 @@ void Renderer::CreateForwardPlusPipeline()
     forwardPlusPipeline = vk::raii::Pipeline(VulkanLogicalDevice, nullptr, graphicsPipelineInfo);
 }
 
-void Renderer::RecordLightCulling(uint32_t imageIndex)
+void Renderer::RecordLightCulling(const vk::raii::CommandBuffer& commandBuffer)
 {
-    auto& commandBuffer = VulkanCommandBuffers[frameIndex];
-    
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *lightCullingPipeline);
-    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, lightCullingPipelineLayout, 0, *forwardPlusDescriptorSets[frameIndex], nullptr);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, lightCullingPipelineLayout, 0, forwardPlusDescriptorSet, frameUniformOffset);
     
-    uint32_t groupCountX = (VulkanSwapChainExtent.width + TILE_SIZE - 1) / TILE_SIZE;
-    uint32_t groupCountY = (VulkanSwapChainExtent.height + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t groupCountX = (sceneRenderExtent.width + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t groupCountY = (sceneRenderExtent.height + TILE_SIZE - 1) / TILE_SIZE;
     
     commandBuffer.dispatch(groupCountX, groupCountY, 1);
 }
 
-void Renderer::RecordForwardPlusPass(uint32_t imageIndex)
+void Renderer::RecordForwardPlusPass(const vk::raii::CommandBuffer& commandBuffer)
 {
-    auto& commandBuffer = VulkanCommandBuffers[frameIndex];
-
-    // Skip if scene render target not initialized
-    if (sceneRenderTarget.getWidth() == 0 || sceneRenderTarget.getHeight() == 0) {
-        return;
-    }
-
-    // Transition scene color image to COLOR_ATTACHMENT_OPTIMAL
-    {
-        vk::ImageMemoryBarrier2 barrier;
-        barrier.srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe;
-        barrier.srcAccessMask = {};
-        barrier.dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput;
-        barrier.dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite;
-        barrier.oldLayout = vk::ImageLayout::eUndefined;
-        barrier.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = *sceneRenderTarget.getColorImage();
-        barrier.subresourceRange = {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
-
-        vk::DependencyInfo dependency_info;
-        dependency_info.dependencyFlags = {};
-        dependency_info.imageMemoryBarrierCount = 1;
-        dependency_info.pImageMemoryBarriers = &barrier;
-
-        commandBuffer.pipelineBarrier2(dependency_info);
-    }
-
-    // Transition scene depth image to DEPTH_ATTACHMENT_OPTIMAL
-    {
-        vk::ImageMemoryBarrier2 barrier;
-        barrier.srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe;
-        barrier.srcAccessMask = {};
-        barrier.dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests;
-        barrier.dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentWrite;
-        barrier.oldLayout = vk::ImageLayout::eUndefined;
-        barrier.newLayout = vk::ImageLayout::eDepthAttachmentOptimal;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = *sceneRenderTarget.getDepthImage();
-        barrier.subresourceRange = {vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1};
-
-        vk::DependencyInfo dependency_info;
-        dependency_info.dependencyFlags = {};
-        dependency_info.imageMemoryBarrierCount = 1;
-        dependency_info.pImageMemoryBarriers = &barrier;
-
-        commandBuffer.pipelineBarrier2(dependency_info);
-    }
-    
+    // The render graph transitions the color and depth targets before this pass runs
     vk::ClearValue clearColor = vk::ClearColorValue(0.1f, 0.1f, 0.1f, 1.0f);
     vk::ClearValue clearDepth = vk::ClearDepthStencilValue(1.0f, 0);
     
@@ -1576,7 +1888,8 @@ void Renderer::RecordForwardPlusPass(uint32_t imageIndex)
     vk::RenderingInfo renderingInfo;
     vk::Rect2D rect2d;
     rect2d.offset = vk::Offset2D{0, 0};
-    rect2d.extent = vk::Extent2D{sceneRenderTarget.getWidth(), sceneRenderTarget.getHeight()};
+    // Only the dynamic resolution region is cleared and drawn; the rest of the target is never sampled
+    rect2d.extent = sceneRenderExtent;
     
     renderingInfo.renderArea = rect2d;
     renderingInfo.layerCount = 1;
@@ -1584,25 +1897,496 @@ void Renderer::RecordForwardPlusPass(uint32_t imageIndex)
     renderingInfo.pColorAttachments = &colorAttachmentInfo;
     renderingInfo.pDepthAttachment = &depthAttachmentInfo;
     
-    commandBuffer.beginRendering(renderingInfo);
+    lodDrawCounts.fill(0);
+    lodTriangleCounts.fill(0);
+
+    // All submeshes of the model share one object block; a full arena skips the object for this frame
+    std::optional<UniformArena::Allocation> objectUniforms = uniformArena.push(ObjectUniforms{ modelMatrix });
+    bool drawModel = objectUniforms && uploadService.isReady(assetUploadTicket);
+    std::span<const Submesh> drawSubmeshes = drawModel ? modelSubmeshes : std::span<const Submesh>();
+
+    // Small draw lists are recorded inline; larger ones are split into ranges recorded as secondary
+    // command buffers on the workers and executed in order, so the draw order is unchanged
+    uint32_t jobCount = 1;
+    if (parallelRecording)
+    {
+        // Rounded down so every job gets at least the minimum
+        uint32_t ranges = static_cast<uint32_t>(drawSubmeshes.size() / MIN_DRAWS_PER_RECORDING_JOB);
+        jobCount = std::clamp(ranges, 1u, commandRecorder.getThreadCount());
+    }
+
+    std::vector<DrawRecording> recordings(jobCount);
+    if (jobCount == 1)
+    {
+        auto start = std::chrono::steady_clock::now();
+        commandBuffer.beginRendering(renderingInfo);
+        RecordSceneState(commandBuffer, objectUniforms);
+        RecordSubmeshDraws(commandBuffer, drawSubmeshes, recordings[0]);
+        commandBuffer.endRendering();
+        commandRecorder.addRecording(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+            recordings[0].draws);
+    }
+    else
+    {
+        vk::Format colorFormat = sceneRenderTarget.getColorFormat();
+        vk::CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo;
+        inheritanceRenderingInfo.colorAttachmentCount = 1;
+        inheritanceRenderingInfo.pColorAttachmentFormats = &colorFormat;
+        inheritanceRenderingInfo.depthAttachmentFormat = sceneRenderTarget.getDepthFormat();
+        inheritanceRenderingInfo.rasterizationSamples = vk::SampleCountFlagBits::e1;
+        vk::CommandBufferInheritanceInfo inheritanceInfo;
+        inheritanceInfo.pNext = &inheritanceRenderingInfo;
+
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        // Each job only touches its own pool, its own range and its own recording entry
+        std::vector<vk::CommandBuffer> secondaryCommandBuffers(jobCount);
+        jobSystem.parallelFor(jobCount, [&](size_t job)
+        {
+            auto start = std::chrono::steady_clock::now();
+            size_t first = drawSubmeshes.size() * job / jobCount;
+            size_t last = drawSubmeshes.size() * (job + 1) / jobCount;
+
+            vk::raii::CommandBuffer& secondary = commandRecorder.acquire();
+            secondary.begin(beginInfo);
+            RecordSceneState(secondary, objectUniforms);
+            RecordSubmeshDraws(secondary, drawSubmeshes.subspan(first, last - first), recordings[job]);
+            secondary.end();
+            secondaryCommandBuffers[job] = *secondary;
+            commandRecorder.addRecording(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                recordings[job].draws);
+        });
+
+        renderingInfo.flags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+        commandBuffer.beginRendering(renderingInfo);
+        commandBuffer.executeCommands(secondaryCommandBuffers);
+        commandBuffer.endRendering();
+    }
+
+    // Texture requests and statistics are merged on this thread; the streamer is not thread-safe
+    for (const DrawRecording& recording : recordings)
+    {
+        for (uint32_t lodIndex = 0; lodIndex < MAX_MESH_LODS; lodIndex++)
+        {
+            lodDrawCounts[lodIndex] += recording.lodDrawCounts[lodIndex];
+            lodTriangleCounts[lodIndex] += recording.lodTriangleCounts[lodIndex];
+        }
+        for (const auto& [texture, level] : recording.textureRequests)
+        {
+            textureStreamer.requestLevel(texture, level);
+        }
+    }
+}
+
+void Renderer::RecordSceneState(const vk::raii::CommandBuffer& commandBuffer, const std::optional<UniformArena::Allocation>& objectUniforms) const
+{
+    // Secondary command buffers inherit no state, so every recording starts from here
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *forwardPlusPipeline);
-    commandBuffer.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(sceneRenderTarget.getWidth()), static_cast<float>(sceneRenderTarget.getHeight()), 0.0f, 1.0f));
-    commandBuffer.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), vk::Extent2D{sceneRenderTarget.getWidth(), sceneRenderTarget.getHeight()}));
+    commandBuffer.setViewport(0, vk::Viewport(0.0f, 0.0f, static_cast<float>(sceneRenderExtent.width), static_cast<float>(sceneRenderExtent.height), 0.0f, 1.0f));
+    commandBuffer.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), sceneRenderExtent));
     commandBuffer.bindVertexBuffers(0, *VulkanVertexBuffer, {0});
-    commandBuffer.bindIndexBuffer(*VulkanIndexBuffer, 0, vk::IndexType::eUint32);
-    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, forwardPlusPipelineLayout, 0, *forwardPlusDescriptorSets[frameIndex], nullptr);
-    commandBuffer.drawIndexed(indices.size(), 1, 0, 0, 0);
-    commandBuffer.endRendering();
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, forwardPlusPipelineLayout, 0, forwardPlusDescriptorSet, frameUniformOffset);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, forwardPlusPipelineLayout, 2, bindlessTextures.getDescriptorSet(), {});
+    commandBuffer.pushConstants<VertexQuantization>(*forwardPlusPipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, modelQuantization);
+    if (objectUniforms)
+    {
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, forwardPlusPipelineLayout, 1, objectDescriptorSet, objectUniforms->offset);
+    }
+}
+
+void Renderer::RecordSubmeshDraws(const vk::raii::CommandBuffer& commandBuffer, std::span<const Submesh> submeshes, DrawRecording& recording) const
+{
+    // One draw per submesh. The index buffer stays bound at offset 0 and is only rebound when the index
+    // width changes; each submesh's range is aligned to its own index size. Materials switch with a push
+    // constant into the bindless table, so no descriptor set changes between draws.
+    std::optional<vk::IndexType> boundIndexType;
+    std::optional<uint32_t> pushedTextureSlot;
+    for (const Submesh& submesh : submeshes)
+    {
+        if (submesh.lodCount == 0)
+        {
+            continue;
+        }
+        if (boundIndexType != submesh.getIndexType())
+        {
+            boundIndexType = submesh.getIndexType();
+            commandBuffer.bindIndexBuffer(*VulkanIndexBuffer, 0, *boundIndexType);
+        }
+
+        TextureStreamer::Handle texture = materialTextures[submesh.material >= 0 ? submesh.material : 0];
+        uint32_t textureSlot = textureSlots[texture]->index;
+        if (pushedTextureSlot != textureSlot)
+        {
+            pushedTextureSlot = textureSlot;
+            commandBuffer.pushConstants<MaterialConstants>(*forwardPlusPipelineLayout, vk::ShaderStageFlagBits::eFragment, sizeof(VertexQuantization),
+                MaterialConstants{ textureSlot });
+        }
+
+        std::span<const MeshLod> submeshLods = modelLods.subspan(submesh.firstLod, submesh.lodCount);
+        uint32_t lodIndex = SelectLod(submeshLods, submesh.bounds, modelMatrix);
+        const MeshLod& lod = submeshLods[lodIndex];
+        commandBuffer.drawIndexed(lod.indexCount, 1, submesh.getFirstIndex() + lod.firstIndex, static_cast<int32_t>(submesh.vertexOffset), 0);
+        recording.textureRequests.emplace_back(texture, SelectTextureLevel(texture, submesh, modelMatrix));
+        recording.lodDrawCounts[lodIndex]++;
+        recording.lodTriangleCounts[lodIndex] += lod.indexCount / 3;
+        recording.draws++;
+    }
+}
+
+uint32_t Renderer::SelectLod(std::span<const MeshLod> lods, const MeshBounds& bounds, const glm::mat4& model) const
+{
+    if (lods.empty())
+    {
+        return 0;
+    }
+    if (lodOverride >= 0)
+    {
+        return std::min(static_cast<uint32_t>(lodOverride), static_cast<uint32_t>(lods.size() - 1));
+    }
 
-    // Transition scene color image to shader read optimal for ImGui display (done in recordCommandBuffer)
+    // Model-space errors and radius grow with the largest axis scale of the object
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+    glm::vec3 worldCenter = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+    float distance = glm::length(cameraPosition - worldCenter) - bounds.radius * scale;
+
+    float pixelsPerUnit = static_cast<float>(sceneRenderExtent.height) / (2.0f * std::tan(cameraFovY * 0.5f));
+    return selectLod(lods, distance, pixelsPerUnit * scale, lodPixelError);
+}
+
+uint32_t Renderer::SelectTextureLevel(TextureStreamer::Handle handle, const Submesh& submesh, const glm::mat4& model) const
+{
+    TextureStreamer::TextureState texture = textureStreamer.getTextureState(handle);
+
+    // Same projection as LOD selection, taken at the nearest point of the bounds so close-ups get enough detail
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+    glm::vec3 worldCenter = glm::vec3(model * glm::vec4(submesh.bounds.center, 1.0f));
+    float distance = std::max(glm::length(cameraPosition - worldCenter) - submesh.bounds.radius * scale, 1e-4f);
+
+    float pixelsPerUnit = static_cast<float>(sceneRenderExtent.height) / (2.0f * std::tan(cameraFovY * 0.5f));
+    return TextureStreamer::selectMipLevel(submesh.uvDensity, std::max(texture.width, texture.height), pixelsPerUnit * scale / distance, texture.mipLevels);
+}
+
+std::span<const uint32_t> Renderer::GetComputeSharingFamilies() const
+{
+    // Concurrent sharing instead of ownership transfers: the buffers change hands twice every frame
+    if (computeQueueIndex == queueIndex)
+    {
+        return {};
+    }
+    return computeSharingFamilies;
 }
 
-void Renderer::CleanupForwardPlus()
+void Renderer::OnMemoryBudgetEvent(const GpuAllocator::BudgetEvent& event)
 {
-    forwardPlusLightBuffer = nullptr;
-    forwardPlusLightBufferMemory = nullptr;
-    tileLightIndexBuffer = nullptr;
-    tileLightIndexBufferMemory = nullptr;
-    tileCountBuffer = nullptr;
-    tileCountBufferMemory = nullptr;
+    // Texture residency is the only memory that can shrink at runtime: under pressure the streamer keeps
+    // three quarters of what it holds now, and gets its own budget back once every heap recovered
+    uint32_t heapBit = 1u << event.heap;
+    if (event.overThreshold)
+    {
+        memoryPressureHeaps |= heapBit;
+        memoryPressureEvents++;
+        if (!memoryPressureBudget)
+        {
+            memoryPressureBudget = textureStreamer.getSettings().budgetBytes;
+        }
+        textureStreamer.setBudget(std::min(*memoryPressureBudget, textureStreamer.getStatistics().residentBytes * 3 / 4));
+        std::cout << "Heap " << event.heap << " over " << gpuAllocator.getBudgetThreshold() * 100.0f << "% of its budget ("
+            << event.usage / (1024 * 1024) << " of " << event.budget / (1024 * 1024) << " MB), shrinking texture residency" << std::endl;
+    }
+    else
+    {
+        memoryPressureHeaps &= ~heapBit;
+        if (memoryPressureHeaps == 0 && memoryPressureBudget)
+        {
+            textureStreamer.setBudget(*memoryPressureBudget);
+            memoryPressureBudget.reset();
+        }
+    }
+}
+
+void Renderer::DrawStatsPanel()
+{
+    ImGui::Text("Vertex layout: %u bytes", GpuVertex::stride);
+
+    if (ImGui::CollapsingHeader("Frame Pacing", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        int inFlight = static_cast<int>(framesInFlight);
+        if (ImGui::SliderInt("Frames in flight", &inFlight, 1, static_cast<int>(MAX_FRAMES_IN_FLIGHT)))
+        {
+            SetFramesInFlight(static_cast<uint32_t>(inFlight));
+        }
+        FrameTimeline::Statistics pacingStatistics = frameTimeline.getStatistics();
+        ImGui::Text("Frame %llu submitted, %llu completed", static_cast<unsigned long long>(pacingStatistics.submittedFrame),
+            static_cast<unsigned long long>(pacingStatistics.completedFrame));
+        ImGui::Text("CPU waited on the GPU in %llu frames, last wait %.2f ms", static_cast<unsigned long long>(pacingStatistics.cpuWaits),
+            pacingStatistics.lastWaitMilliseconds);
+        DeletionQueue::Statistics deletionStatistics = deletionQueue.getStatistics();
+        ImGui::Text("Swapchain recreated %u times", swapChainRecreations);
+        ImGui::Text("Deferred deletions: %u pending, %llu retired", deletionStatistics.pending,
+            static_cast<unsigned long long>(deletionStatistics.retired));
+    }
+
+    if (ImGui::CollapsingHeader("Dynamic Resolution", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        DynamicResolution::Settings resolutionSettings = dynamicResolution.getSettings();
+        bool changed = ImGui::Checkbox("Scale to GPU frame time", &resolutionSettings.enabled);
+        changed |= ImGui::SliderFloat("Target scene pass ms", &resolutionSettings.targetMilliseconds, 4.0f, 33.3f, "%.1f");
+        changed |= ImGui::SliderFloat("Min scale", &resolutionSettings.minScale, 0.25f, 1.0f, "%.2f");
+        changed |= ImGui::SliderFloat("Max scale", &resolutionSettings.maxScale, 0.25f, 1.0f, "%.2f");
+        if (changed)
+        {
+            dynamicResolution.setSettings(resolutionSettings);
+        }
+        const DynamicResolution::Statistics& resolutionStatistics = dynamicResolution.getStatistics();
+        if (!resolutionStatistics.timestampsSupported)
+        {
+            ImGui::Text("No timestamps on the graphics queue; rendering at max scale");
+        }
+        ImGui::Text("Scene %ux%u of %ux%u (scale %.2f, changed %llu times)", sceneRenderExtent.width, sceneRenderExtent.height,
+            sceneRenderTarget.getWidth(), sceneRenderTarget.getHeight(), resolutionStatistics.scale,
+            static_cast<unsigned long long>(resolutionStatistics.scaleChanges));
+        ImGui::Text("Scene pass %.2f ms on the GPU (average %.2f ms)", resolutionStatistics.lastSceneMilliseconds,
+            resolutionStatistics.averageSceneMilliseconds);
+    }
+
+    if (ImGui::CollapsingHeader("Render Graph", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        const RenderGraph::Statistics& graphStatistics = frameGraph.getStatistics();
+        ImGui::Text("Passes: %u (%u culled, %u reordered)", graphStatistics.passes, graphStatistics.culledPasses, graphStatistics.reorderedPasses);
+        ImGui::Text("Barriers: %u image, %u buffer in %u batches", graphStatistics.imageBarriers, graphStatistics.bufferBarriers,
+            graphStatistics.barrierBatches);
+        if (ImGui::Button("Dump frame graph"))
+        {
+            dumpFrameGraph = true;
+        }
+        ImGui::SameLine();
+        ImGui::TextUnformatted(FRAME_GRAPH_DUMP_PATH.c_str());
+    }
+
+    if (ImGui::CollapsingHeader("Async Compute", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        if (asyncCompute.isAsync())
+        {
+            ImGui::Text("Light culling queue family %u (graphics %u)", asyncCompute.getQueueFamily(), queueIndex);
+            ImGui::Checkbox("Cull lights on the compute queue", &asyncLightCulling);
+        }
+        else
+        {
+            ImGui::Text("No separate compute queue; light culling runs on the graphics queue");
+        }
+        const AsyncComputeQueue::Statistics& computeStatistics = asyncCompute.getStatistics();
+        if (computeStatistics.timestampsSupported && lightCullingAsync)
+        {
+            ImGui::Text("Culling %.3f ms on the compute queue, graphics %.3f ms", computeStatistics.lastComputeMilliseconds,
+                computeStatistics.lastGraphicsMilliseconds);
+            // The queues need not share a timestamp base, so the overlap is only an estimate
+            ImGui::Text("~%.3f ms of the culling alongside graphics (%.0f%% on average, estimated)", computeStatistics.lastOverlapMilliseconds,
+                computeStatistics.averageOverlap * 100.0);
+        }
+        ImGui::Text("Submissions: %llu", static_cast<unsigned long long>(computeStatistics.submissions));
+    }
+
+    if (ImGui::CollapsingHeader("Command Recording", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Checkbox("Record on workers", &parallelRecording);
+        ParallelCommandRecorder::Statistics recordingStatistics = commandRecorder.getStatistics();
+        ImGui::Text("%u secondary command buffers allocated, at least %zu draws per worker", recordingStatistics.allocatedCommandBuffers,
+            MIN_DRAWS_PER_RECORDING_JOB);
+        for (size_t thread = 0; thread < recordingStatistics.threads.size(); thread++)
+        {
+            const ParallelCommandRecorder::ThreadStatistics& threadStatistics = recordingStatistics.threads[thread];
+            if (threadStatistics.draws == 0 && threadStatistics.peakRecordMilliseconds == 0.0)
+            {
+                continue;
+            }
+            ImGui::BulletText("%s %zu: %.3f ms (peak %.3f ms), %u draws in %u secondary buffers", thread == 0 ? "Render thread" : "Worker",
+                thread, threadStatistics.recordMilliseconds, threadStatistics.peakRecordMilliseconds, threadStatistics.draws,
+                threadStatistics.commandBuffers);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Uploads", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        UploadService::Statistics uploadStatistics = uploadService.getStatistics();
+        ImGui::Text("Queue family %u (%s)", uploadService.getTransferQueueFamily(),
+            uploadService.usesDedicatedQueue() ? "dedicated transfer" : "shared with graphics");
+        ImGui::Text("%llu KB in %u batches, %u in flight", static_cast<unsigned long long>(uploadStatistics.bytesUploaded / 1024),
+            uploadStatistics.batchesSubmitted, uploadStatistics.batchesInFlight);
+        ImGui::Text("Mip chains generated: %u, post-copy barriers: %u", uploadStatistics.mipChainsGenerated, uploadStatistics.barriersRecorded);
+        ImGui::Text("Staging ring: %llu KB in use, peak %llu KB of %llu KB",
+            static_cast<unsigned long long>(uploadStatistics.stagingBytesInUse / 1024),
+            static_cast<unsigned long long>(uploadStatistics.stagingPeakBytes / 1024),
+            static_cast<unsigned long long>(uploadStatistics.stagingCapacity / 1024));
+        ImGui::Text("Chunked uploads: %u, early submits: %u, GPU waits: %u", uploadStatistics.chunkedUploads,
+            uploadStatistics.stagingFlushes, uploadStatistics.stagingWaits);
+        ImGui::Text("Scene assets: %s", uploadService.isReady(assetUploadTicket) ? "resident" : "streaming");
+    }
+
+    if (ImGui::CollapsingHeader("GPU Memory", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        GpuAllocator::Statistics memoryStatistics = gpuAllocator.getStatistics();
+        ImGui::Text("%u device memory blocks, %llu KB used of %llu KB allocated", memoryStatistics.blockCount,
+            static_cast<unsigned long long>(memoryStatistics.allocationBytes / 1024),
+            static_cast<unsigned long long>(memoryStatistics.blockBytes / 1024));
+        std::span<const GpuAllocator::HeapBudget> heapBudgets = gpuAllocator.getHeapBudgets();
+        for (uint32_t heap = 0; heap < heapBudgets.size(); heap++)
+        {
+            const GpuAllocator::HeapBudget& heapBudget = heapBudgets[heap];
+            float fraction = heapBudget.budget > 0 ? static_cast<float>(heapBudget.usage) / static_cast<float>(heapBudget.budget) : 0.0f;
+            ImGui::Text("Heap %u (%s): %llu of %llu MB budget, %llu MB heap", heap, heapBudget.deviceLocal ? "device local" : "host",
+                static_cast<unsigned long long>(heapBudget.usage / (1024 * 1024)), static_cast<unsigned long long>(heapBudget.budget / (1024 * 1024)),
+                static_cast<unsigned long long>(heapBudget.size / (1024 * 1024)));
+            ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f));
+        }
+        ImGui::Text("Budget source: %s", gpuAllocator.hasMemoryBudgetExtension() ? "VK_EXT_memory_budget" : "estimated");
+        ImGui::Text("CPU access to VRAM: %s; %u buffers (%llu KB) written in place, %llu KB of geometry unstaged",
+            GpuAllocator::getHostAccessName(gpuAllocator.getHostAccess()), memoryStatistics.directWriteBuffers,
+            static_cast<unsigned long long>(memoryStatistics.directWriteBytes / 1024), static_cast<unsigned long long>(directGeometryBytes / 1024));
+        float budgetThreshold = gpuAllocator.getBudgetThreshold();
+        if (ImGui::SliderFloat("Pressure threshold", &budgetThreshold, 0.5f, 1.0f, "%.2f of budget"))
+        {
+            gpuAllocator.setBudgetThreshold(budgetThreshold);
+        }
+        ImGui::Text("Over threshold: %s, %u times so far", memoryPressureBudget ? "yes" : "no", memoryPressureEvents);
+        TransientAttachmentPool::Statistics transientStatistics = transientAttachments.getStatistics();
+        ImGui::Text("Transient attachments: %u in %u blocks (%u lazily allocated), %llu KB for %llu KB requested",
+            transientStatistics.attachmentCount, transientStatistics.memoryBlockCount, transientStatistics.lazilyAllocatedCount,
+            static_cast<unsigned long long>(transientStatistics.allocatedBytes / 1024),
+            static_cast<unsigned long long>(transientStatistics.requestedBytes / 1024));
+        for (uint32_t category = 0; category < static_cast<uint32_t>(GpuAllocator::Category::Count); category++)
+        {
+            const GpuAllocator::CategoryStatistics& categoryStatistics = memoryStatistics.categories[category];
+            ImGui::Text("%s: %u allocations (%u dedicated), %llu KB", GpuAllocator::getCategoryName(static_cast<GpuAllocator::Category>(category)),
+                categoryStatistics.allocationCount, categoryStatistics.dedicatedCount,
+                static_cast<unsigned long long>(categoryStatistics.bytes / 1024));
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Uniform Arena", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        UniformArena::Statistics arenaStatistics = uniformArena.getStatistics();
+        ImGui::Text("Last frame: %llu of %llu KB, %u allocations (%llu byte alignment)",
+            static_cast<unsigned long long>(arenaStatistics.lastFrameBytes / 1024),
+            static_cast<unsigned long long>(arenaStatistics.frameCapacity / 1024), arenaStatistics.lastFrameAllocations,
+            static_cast<unsigned long long>(arenaStatistics.alignment));
+        ImGui::Text("Peak: %llu KB", static_cast<unsigned long long>(arenaStatistics.peakFrameBytes / 1024));
+        ImGui::Text("Overflows: %llu allocations in %u frames", static_cast<unsigned long long>(arenaStatistics.overflowedAllocations),
+            arenaStatistics.overflowedFrames);
+    }
+
+    if (ImGui::CollapsingHeader("Bindless Textures", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        BindlessTextureTable::Statistics bindlessStatistics = bindlessTextures.getStatistics();
+        ImGui::Text("Slots: %u of %u live (peak %u), %u waiting for frames to retire", bindlessStatistics.liveSlots,
+            bindlessStatistics.capacity, bindlessStatistics.peakLiveSlots, bindlessStatistics.pendingSlots);
+        ImGui::Text("Materials: %zu, descriptor writes: %llu", materialTextures.size(),
+            static_cast<unsigned long long>(bindlessStatistics.descriptorWrites));
+    }
+
+    if (ImGui::CollapsingHeader("Descriptors", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        auto drawAllocator = [](const char* label, const DescriptorAllocator::Statistics& statistics)
+        {
+            ImGui::Text("%s: %u sets in %u pools (%u full), %llu pools created, next pool %u sets", label, statistics.sets,
+                statistics.poolCount, statistics.fullPoolCount, static_cast<unsigned long long>(statistics.poolsCreated), statistics.setsPerNextPool);
+            for (const DescriptorAllocator::LayoutUsage& usage : statistics.layouts)
+            {
+                ImGui::BulletText("%s: %u sets (peak %u, %llu total)", usage.name.c_str(), usage.sets, usage.peakSets,
+                    static_cast<unsigned long long>(usage.totalSets));
+            }
+        };
+        drawAllocator("Persistent", descriptorAllocator.getStatistics());
+        drawAllocator("This frame", frameDescriptorAllocators[frameIndex].getStatistics());
+    }
+
+    if (ImGui::CollapsingHeader("Texture Streaming", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        TextureStreamer::Statistics streamingStatistics = textureStreamer.getStatistics();
+        int budgetMegabytes = static_cast<int>(streamingStatistics.budgetBytes / (1024 * 1024));
+        if (ImGui::SliderInt("Budget", &budgetMegabytes, 1, 4096, "%d MB"))
+        {
+            textureStreamer.setBudget(static_cast<vk::DeviceSize>(budgetMegabytes) * 1024 * 1024);
+        }
+        ImGui::Text("Resident %llu KB, committed %llu KB of %llu KB",
+            static_cast<unsigned long long>(streamingStatistics.residentBytes / 1024),
+            static_cast<unsigned long long>(streamingStatistics.committedBytes / 1024),
+            static_cast<unsigned long long>(streamingStatistics.budgetBytes / 1024));
+        ImGui::Text("Pending uploads: %u, unmet requests: %u", streamingStatistics.pendingUploads, streamingStatistics.unmetRequests);
+        ImGui::Text("Levels streamed in: %llu, evicted: %llu (%llu KB uploaded)",
+            static_cast<unsigned long long>(streamingStatistics.levelsStreamedIn),
+            static_cast<unsigned long long>(streamingStatistics.levelsEvicted),
+            static_cast<unsigned long long>(streamingStatistics.bytesStreamed / 1024));
+
+        for (uint32_t handle = 0; handle < textureStreamer.getTextureCount(); handle++)
+        {
+            TextureStreamer::TextureState texture = textureStreamer.getTextureState(handle);
+            ImGui::Text("#%u %ux%u %s, %u mips (%s)", handle, texture.width, texture.height, vk::to_string(texture.format).c_str(), texture.mipLevels,
+                texture.mipMethod != MipGenerator::Method::None ? MipGenerator::getMethodName(texture.mipMethod) : "from asset");
+            ImGui::Text("    resident from mip %u (%llu KB), requested %u%s", texture.residentLevel,
+                static_cast<unsigned long long>(texture.residentBytes / 1024), texture.requestedLevel,
+                texture.pendingLevel ? (", streaming mip " + std::to_string(*texture.pendingLevel)).c_str() : "");
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Submeshes", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        // Index bytes saved by 16-bit submeshes compared to a uniformly 32-bit index buffer
+        size_t shortIndexSubmeshes = 0;
+        size_t savedIndexBytes = 0;
+        for (const Submesh& submesh : modelSubmeshes)
+        {
+            if (submesh.indexSize == sizeof(uint16_t))
+            {
+                shortIndexSubmeshes++;
+                for (const MeshLod& lod : modelLods.subspan(submesh.firstLod, submesh.lodCount))
+                {
+                    savedIndexBytes += lod.indexCount * (sizeof(uint32_t) - sizeof(uint16_t));
+                }
+            }
+        }
+        ImGui::Text("%zu submeshes, %zu with 16-bit indices", modelSubmeshes.size(), shortIndexSubmeshes);
+        ImGui::Text("Index data: %zu KB (%zu KB saved by 16-bit indices)", modelIndices.size_bytes() / 1024, savedIndexBytes / 1024);
+    }
+
+    if (ImGui::CollapsingHeader("Level of detail", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::SliderFloat("Max pixel error", &lodPixelError, 0.25f, 16.0f, "%.2f px");
+        ImGui::SliderInt("Force LOD", &lodOverride, -1, static_cast<int>(MAX_MESH_LODS) - 1, lodOverride < 0 ? "auto" : "%d");
+
+        // Submeshes simplify independently, so each level sums whichever submeshes reached it
+        std::array<uint32_t, MAX_MESH_LODS> lodTriangles{};
+        uint32_t lodLevels = 0;
+        for (const Submesh& submesh : modelSubmeshes)
+        {
+            for (uint32_t lod = 0; lod < submesh.lodCount; lod++)
+            {
+                lodTriangles[lod] += modelLods[submesh.firstLod + lod].indexCount / 3;
+            }
+            lodLevels = std::max(lodLevels, submesh.lodCount);
+        }
+
+        if (ImGui::BeginTable("LodStats", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("LOD");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("Draws");
+            ImGui::TableSetupColumn("Drawn triangles");
+            ImGui::TableHeadersRow();
+            for (uint32_t lod = 0; lod < lodLevels; lod++)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", lod);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", lodTriangles[lod]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", lodDrawCounts[lod]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", lodTriangleCounts[lod]);
+            }
+            ImGui::EndTable();
+        }
+    }
 }
\ No newline at end of file
@@ -1,8 +1,27 @@
 #pragma once
 #include <memory>
 
+#include "AsyncComputeQueue.h"
+#include "BindlessTextureTable.h"
+#include "DeletionQueue.h"
+#include "DescriptorAllocator.h"
+#include "DynamicResolution.h"
+#include "FrameTimeline.h"
+#include "GpuAllocator.h"
 #include "ImGuiVulkanUtil.h"
+#include "MeshCache.h"
+#include "MeshLod.h"
+#include "MipGenerator.h"
+#include "RenderGraph.h"
+#include "ParallelCommandRecorder.h"
+#include "Runtime/EngineCore/JobSystem.h"
 #include "SceneRenderTarget.h"
+#include "Submesh.h"
+#include "TextureStreamer.h"
+#include "TextureTranscoder.h"
+#include "TransientAttachmentPool.h"
+#include "UniformArena.h"
+#include "UploadService.h"
 
 //TODO: Will move this to precompiled header in the future
 #include <algorithm>
@@ -11,6 +30,9 @@
 #include <memory>
 #include <stdexcept>
 #include <fstream>
+#include <future>
+#include <optional>
+#include <span>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -36,40 +58,17 @@ import vulkan_hpp;
 #include <tiny_gltf.h>
 
 #include <ktx.h>
-struct Vertex
-{
-	glm::vec3 pos;
-	glm::vec3 color;
-	glm::vec2 texCoord;
-
-	static vk::VertexInputBindingDescription getBindingDescription()
-	{
-		return { 0, sizeof(Vertex), vk::VertexInputRate::eVertex };
-	}
 
-	static std::array<vk::VertexInputAttributeDescription, 3> getAttributeDescriptions()
-	{
-		return {
-			vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, pos)),
-			vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color)),
-			vk::VertexInputAttributeDescription(2, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, texCoord)) };
-	}
-
-	bool operator==(const Vertex& other) const {
-		return pos == other.pos && color == other.color && texCoord == other.texCoord;
-	}
+#include "Vertex.h"
+// Passes of a frame in recording order; transient attachments declare the range of passes that use them
+enum class FramePass : uint32_t {
+	LightCulling,
+	Scene,
+	Composite,
 };
 
-template <>
-struct std::hash<Vertex>
-{
-	size_t operator()(Vertex const& vertex) const noexcept
-	{
-		return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
-	}
-};
+// Per-view data, allocated once per frame and pass from the uniform arena
 struct UniformBufferObject {
-	alignas(16) glm::mat4 model;
 	alignas(16) glm::mat4 view;
 	alignas(16) glm::mat4 proj;
 	alignas(16) glm::vec3 viewPos;
@@ -83,6 +82,16 @@ struct UniformBufferObject {
 	alignas(16) float padding3;
 };
 
+// Per-object data, allocated from the uniform arena for every object drawn and bound with its dynamic offset
+struct ObjectUniforms {
+	alignas(16) glm::mat4 model;
+};
+
+// Per-draw material data, pushed to the fragment stage right after VertexQuantization
+struct MaterialConstants {
+	uint32_t baseColorTexture; // slot in the bindless texture table
+};
+
 // Light data for lighting pass
 struct LightData {
 	alignas(16) glm::vec3 lightPos;
@@ -104,6 +113,12 @@ constexpr uint32_t MAX_LIGHTS = 256;
 constexpr uint32_t TILE_SIZE = 16;
 constexpr uint32_t MAX_LIGHTS_PER_TILE = 64;
 
+// Stage the frame's submission waits on the swapchain image at. Only the swapchain image's first barrier uses it,
+// so nothing else in the frame, the scene pass included, waits for presentation to release an image. Waiting at
+// color attachment output would also hold back the scene's color writes. The frame records no clear, fill or
+// update commands, which are the only other users of the clear stage.
+constexpr vk::PipelineStageFlags2 SWAPCHAIN_ACQUIRE_STAGE = vk::PipelineStageFlagBits2::eClear;
+
 
 class Window;
 
@@ -122,7 +137,18 @@ public:
 	vk::raii::Queue& GetGraphicsQueue() { return VulkanGraphicsQueue; }
 	vk::raii::CommandPool& GetCommandPool() { return VulkanCommandPool; }
 	uint32_t GetQueueFamilyIndex() const { return queueIndex; }
+	uint32_t GetTransferQueueFamilyIndex() const { return transferQueueIndex; }
+	UploadService& GetUploadService() { return uploadService; }
+	TextureStreamer& GetTextureStreamer() { return textureStreamer; }
 	uint32_t GetCurrentFrameIndex() const { return frameIndex; }
+	/// Frame numbers and their completion, for subsystems that keep resources alive until a frame finished
+	const FrameTimeline& GetFrameTimeline() const { return frameTimeline; }
+	uint32_t GetFramesInFlight() const { return framesInFlight; }
+	/// Clamped to 1..FrameTimeline::MAX_FRAMES_IN_FLIGHT; applies from the next frame
+	void SetFramesInFlight(uint32_t count);
+	/// Internal resolution control for the scene; the target keeps its full size and the scene renders into part of it
+	void SetDynamicResolution(const DynamicResolution::Settings& settings) { dynamicResolution.setSettings(settings); }
+	vk::Extent2D GetSceneRenderExtent() const { return sceneRenderExtent; }
 	vk::raii::SwapchainKHR& GetSwapChain() { return VulkanSwapChain; }
 	vk::Extent2D GetSwapChainExtent() const { return VulkanSwapChainExtent; }
 	vk::SurfaceFormatKHR GetSwapChainFormat() const { return VulkanSwapChainSurfaceFormat; }
@@ -134,13 +160,27 @@ public:
 	SceneRenderTarget& GetSceneRenderTarget() { return sceneRenderTarget; }
 
 	vk::raii::CommandBuffer& GetCurrentCommandBuffer() { return VulkanCommandBuffers[frameIndex]; }
-	vk::raii::DescriptorSet& GetCurrentDescriptorSet() { return VulkanDescriptorSets[frameIndex]; }
+	vk::DescriptorSet GetCurrentDescriptorSet() const { return VulkanDescriptorSets[frameIndex]; }
 
 	// Model data access
-	const std::vector<Vertex>& GetVertices() const { return vertices; }
-	const std::vector<uint32_t>& GetIndices() const { return indices; }
-	vk::raii::Buffer& GetVertexBuffer() { return VulkanVertexBuffer; }
-	vk::raii::Buffer& GetIndexBuffer() { return VulkanIndexBuffer; }
+	std::span<const GpuVertex::Data> GetVertices() const { return modelVertices; }
+	// Mixed 16/32-bit indices; use the submesh table to interpret them
+	std::span<const std::byte> GetIndices() const { return modelIndices; }
+	std::span<const Submesh> GetSubmeshes() const { return modelSubmeshes; }
+	const VertexQuantization& GetVertexQuantization() const { return modelQuantization; }
+	std::span<const MeshLod> GetLods() const { return modelLods; }
+
+	// LOD selection: the coarsest LOD whose projected error stays under the pixel threshold is drawn.
+	// A non-negative override forces one LOD for every object (debugging)
+	void SetLodPixelError(float pixels) { lodPixelError = pixels; }
+	void SetLodOverride(int lod) { lodOverride = lod; }
+	// VRAM the texture streamer may keep resident; least recently needed mips are dropped above it
+	void SetTextureBudget(vk::DeviceSize bytes) { textureStreamer.setBudget(bytes); }
+	GpuAllocator::Buffer& GetVertexBuffer() { return VulkanVertexBuffer; }
+	GpuAllocator::Buffer& GetIndexBuffer() { return VulkanIndexBuffer; }
+
+	// Memory usage per category and heap budgets; budget callbacks fire when a device-local heap crosses the threshold
+	GpuAllocator& GetGpuAllocator() { return gpuAllocator; }
 
 	// Pipeline access
 	vk::raii::Pipeline& GetGraphicsPipeline() { return VulkanGraphicsPipeline; }
@@ -154,52 +194,73 @@ protected:
 	void CreateSurface();
 	void PickPhysicalDevice();
 	void CreateLogicalDevice();
-	void CreateSwapChain();
-	vk::raii::ImageView CreateImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags);
+	void OnMemoryBudgetEvent(const GpuAllocator::BudgetEvent& event);
+	/// oldSwapChain is retired by the new one; images it already handed out stay valid until it is destroyed
+	void CreateSwapChain(vk::SwapchainKHR oldSwapChain = nullptr);
+	vk::raii::ImageView CreateImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
 	void CreateImageViews();
 	void CreateDescriptorSetLayout();
 	void CreateGraphicsPipeline();
 	void CreateCommandPool();
-	void CreateDepthResources();
 	void CreateTextureImage();
-	void CreateTextureImageWithKTX();
-	void CreateImage(uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling,
+	void CreateTextureImageWithKTX(TextureTranscoder::Texture texture);
+	void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, vk::Format format, vk::ImageTiling tiling,
 		vk::ImageUsageFlags usage,
-		vk::MemoryPropertyFlags properties, vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory);
-	void CreateTextureImageView();
+		vk::MemoryPropertyFlags properties, GpuAllocator::Image& image, GpuAllocator::Category category);
 	void CreateTextureSampler();
+	void CreateMaterials();
 	void LoadModel();
 	void LoadModelWithGLTF();
 	void CreateVertexBuffer();
 	void CreateIndexBuffer();
+	/// Fills a device-local buffer in place when the allocator prefers it, through the upload service otherwise
+	void CreateGeometryBuffer(std::span<const std::byte> data, vk::BufferUsageFlags usage, GpuAllocator::Buffer& buffer,
+		vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
 	void CreateUniformBuffers();
 	void UpdateUniformBuffer(uint32_t currentImage);
-	void CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, vk::raii::Buffer& buffer, vk::raii::DeviceMemory& bufferMemory);
-	void CreateDescriptorPool();
+	/// More than one sharingFamilies makes the buffer concurrently shared between them
+	void CreateBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties, GpuAllocator::Buffer& buffer, GpuAllocator::Category category = GpuAllocator::Category::Buffer,
+		std::span<const uint32_t> sharingFamilies = {});
+	/// Queue families the buffers read by light culling are shared between; empty without async compute
+	std::span<const uint32_t> GetComputeSharingFamilies() const;
+	void CreateDescriptorAllocators();
 	void CreateDescriptorSets();
+	void UpdateBindlessTextures();
 	void CreateCommandBuffers();
 	void CreateSyncObjects();
 	void recordCommandBuffer(uint32_t imageIndex);
+	uint32_t SelectLod(std::span<const MeshLod> lods, const MeshBounds& bounds, const glm::mat4& model) const;
+	uint32_t SelectTextureLevel(TextureStreamer::Handle handle, const Submesh& submesh, const glm::mat4& model) const;
+	void DrawStatsPanel();
 	
 	// Forward+ rendering
 	void CreateForwardPlusLightBuffer();
+	// Sized by the swapchain extent
+	void CreateForwardPlusTileBuffers();
 	void CreateForwardPlusDescriptorSetLayout();
-	void CreateForwardPlusDescriptorPool();
-	void CreateForwardPlusDescriptorSets();
+	void AllocateForwardPlusDescriptorSet();
 	void CreateLightCullingPipeline();
 	void CreateForwardPlusPipeline();
-	void RecordLightCulling(uint32_t imageIndex);
-	void RecordForwardPlusPass(uint32_t imageIndex);
-	void CleanupForwardPlus();
-	void transition_image_layout(vk::Image               image, vk::ImageLayout old_layout, vk::ImageLayout new_layout,
-		vk::AccessFlags2 src_access_mask, vk::AccessFlags2 dst_access_mask,
-		vk::PipelineStageFlags2 src_stage_mask, vk::PipelineStageFlags2 dst_stage_mask, vk::ImageAspectFlags    image_aspect_flags);
-	void transitionImageLayout(const vk::raii::Image& image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout);
+	void RecordLightCulling(const vk::raii::CommandBuffer& commandBuffer);
+	void RecordForwardPlusPass(const vk::raii::CommandBuffer& commandBuffer);
+	// Draws and texture requests of one recorded range of submeshes, merged on the render thread
+	struct DrawRecording
+	{
+		std::array<uint32_t, MAX_MESH_LODS> lodDrawCounts{};
+		std::array<uint32_t, MAX_MESH_LODS> lodTriangleCounts{};
+		std::vector<std::pair<TextureStreamer::Handle, uint32_t>> textureRequests;
+		uint32_t draws = 0;
+	};
+	// Safe to call from workers: they only read renderer state and write the command buffer and recording
+	void RecordSceneState(const vk::raii::CommandBuffer& commandBuffer, const std::optional<UniformArena::Allocation>& objectUniforms) const;
+	void RecordSubmeshDraws(const vk::raii::CommandBuffer& commandBuffer, std::span<const Submesh> submeshes, DrawRecording& recording) const;
+	// Declares this frame's passes and the resources they use; barriers come from the graph
+	void BuildFrameGraph(uint32_t imageIndex);
 
 
 	//helpers function- vulkan
 	vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities);
-	void CleanupSwapChain();
+	void CreateRenderFinishedSemaphores();
 
 	static uint32_t chooseSwapMinImageCount(vk::SurfaceCapabilitiesKHR const& surfaceCapabilities)
 	{
@@ -229,34 +290,6 @@ protected:
 			vk::PresentModeKHR::eFifo;
 	}
 
-	void copyBuffer(vk::raii::Buffer& srcBuffer, vk::raii::Buffer& dstBuffer, vk::DeviceSize size)
-	{
-		vk::CommandBufferAllocateInfo allocInfo;
-		allocInfo.commandPool = VulkanCommandPool;
-		allocInfo.level = vk::CommandBufferLevel::ePrimary;
-		allocInfo.commandBufferCount = 1;
-
-		vk::raii::CommandBuffer       commandCopyBuffer = std::move(VulkanLogicalDevice.allocateCommandBuffers(allocInfo).front());
-
-		vk::CommandBufferBeginInfo CommandBufferBeginInfo;
-		CommandBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-		commandCopyBuffer.begin(CommandBufferBeginInfo);
-
-		vk::BufferCopy copybuffer;
-		copybuffer.size = size;
-
-		commandCopyBuffer.copyBuffer(*srcBuffer, *dstBuffer, copybuffer);
-		commandCopyBuffer.end();
-
-		vk::SubmitInfo SubmitInfo;
-		SubmitInfo.commandBufferCount = 1;
-		SubmitInfo.pCommandBuffers = &*commandCopyBuffer;
-
-		VulkanGraphicsQueue.submit(SubmitInfo, nullptr);
-		VulkanGraphicsQueue.waitIdle();
-	}
-
 	std::vector<char const*> getRequiredExtensions();
 
 	static VKAPI_ATTR vk::Bool32 VKAPI_CALL debugCallback(vk::DebugUtilsMessageSeverityFlagBitsEXT severity, vk::DebugUtilsMessageTypeFlagsEXT type, const vk::DebugUtilsMessengerCallbackDataEXT* pCallbackData, void*)
@@ -296,66 +329,6 @@ protected:
 		return buffer;
 	}
 
-	uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties)
-	{
-		vk::PhysicalDeviceMemoryProperties memProperties = VulkanPhysicalDevice.getMemoryProperties();
-
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-		{
-			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-			{
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type!");
-	}
-
-	//Texture
-	vk::raii::CommandBuffer beginSingleTimeCommands()
-	{
-		vk::CommandBufferAllocateInfo allocInfo;
-		allocInfo.commandPool = VulkanCommandPool;
-		allocInfo.level = vk::CommandBufferLevel::ePrimary;
-		allocInfo.commandBufferCount = 1;
-
-		vk::raii::CommandBuffer commandBuffer = std::move(VulkanLogicalDevice.allocateCommandBuffers(allocInfo).front());
-
-		vk::CommandBufferBeginInfo beginInfo;
-		beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-		commandBuffer.begin(beginInfo);
-
-		return commandBuffer;
-	}
-
-	void endSingleTimeCommands(vk::raii::CommandBuffer& commandBuffer)
-	{
-		commandBuffer.end();
-
-		vk::SubmitInfo submitInfo;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &*commandBuffer;
-
-		VulkanGraphicsQueue.submit(submitInfo, nullptr);
-		VulkanGraphicsQueue.waitIdle();
-	}
-
-	void copyBufferToImage(const vk::raii::Buffer& buffer, vk::raii::Image& image, uint32_t width, uint32_t height) {
-		vk::raii::CommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		vk::BufferImageCopy region;
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-		region.imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
-		region.imageOffset = vk::Offset3D{ 0, 0, 0 };
-		region.imageExtent = vk::Extent3D{ width, height, 1 };
-
-		commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, { region });
-		endSingleTimeCommands(commandBuffer);
-	}
-
 	// Depth Buffering (3D)
 	vk::Format findSupportedFormat(const std::vector<vk::Format>& candidates, vk::ImageTiling tiling, vk::FormatFeatureFlags features)
 	{
@@ -392,6 +365,13 @@ protected:
 	vk::raii::DebugUtilsMessengerEXT VulkanDebugMessenger = nullptr;
 	vk::raii::PhysicalDevice VulkanPhysicalDevice = nullptr;
 	vk::raii::Device VulkanLogicalDevice = nullptr;
+	// Declared right after the device: everything below releases its memory into it before it goes away
+	GpuAllocator gpuAllocator;
+	bool memoryBudgetSupported = false;
+	// Texture budget to restore once memory pressure ends; set while any heap is over its threshold
+	std::optional<vk::DeviceSize> memoryPressureBudget;
+	uint32_t memoryPressureHeaps = 0; // bit per heap currently over its threshold; at most VK_MAX_MEMORY_HEAPS
+	uint32_t memoryPressureEvents = 0;
 	vk::raii::Queue VulkanGraphicsQueue = nullptr;
 	vk::raii::SurfaceKHR VulkanSurface = nullptr;
 	vk::raii::SwapchainKHR           VulkanSwapChain = nullptr;
@@ -400,6 +380,11 @@ protected:
 	vk::Extent2D                     VulkanSwapChainExtent;
 	std::vector<vk::raii::ImageView> VulkanSwapChainImageViews;
 	uint32_t                         queueIndex = ~0;
+	uint32_t                         transferQueueIndex = ~0;
+	// Equal to queueIndex when there is no separate compute queue; computeQueueSlot is the queue within the family
+	uint32_t                         computeQueueIndex = ~0;
+	uint32_t                         computeQueueSlot = 0;
+	std::array<uint32_t, 2>          computeSharingFamilies{};
 	vk::raii::DescriptorSetLayout VulkanDescriptorSetLayout = nullptr;
 	vk::raii::PipelineLayout VulkanPipelineLayout = nullptr;
 	vk::raii::Pipeline       VulkanGraphicsPipeline = nullptr;
@@ -407,39 +392,48 @@ protected:
 	std::vector < vk::raii::CommandBuffer>  VulkanCommandBuffers;
 	std::vector < vk::raii::Semaphore> VulkanPresentCompleteSemaphores;
 	std::vector < vk::raii::Semaphore> VulkanRenderFinishedSemaphores;
-	vk::raii::Fence     VulkanDrawFence = nullptr;
-	vk::raii::Buffer VulkanVertexBuffer = nullptr;
-	vk::raii::DeviceMemory VulkanVertexBufferMemory = nullptr;
-	vk::raii::Buffer VulkanIndexBuffer = nullptr;
-	vk::raii::DeviceMemory VulkanIndexBufferMemory = nullptr;
-	std::vector<vk::raii::Buffer> VulkanUniformBuffers;
-	std::vector<vk::raii::DeviceMemory> VulkanUniformBuffersMemory;
-	std::vector<void*> VulkanUniformBuffersMapped;
-	std::vector<vk::raii::Fence>     inFlightFences;
+	GpuAllocator::Buffer VulkanVertexBuffer = nullptr;
+	GpuAllocator::Buffer VulkanIndexBuffer = nullptr;
+	// Geometry written in place instead of staged, for the stats panel
+	vk::DeviceSize directGeometryBytes = 0;
+	// Per-frame slices for view and object uniforms; frameUniformOffset locates this frame's UniformBufferObject
+	UniformArena uniformArena;
+	uint32_t frameUniformOffset = 0;
+	bool frameUniformsValid = false; // the view block fit into this frame's slice
+	// Frame N signals value N; frameIndex is the slot of the frame being recorded
+	FrameTimeline                    frameTimeline;
+	uint32_t                         framesInFlight = 2; // see SetFramesInFlight
 	uint32_t                         frameIndex = 0;
-	vk::raii::DescriptorPool VulkanDescriptorPool = nullptr;
-	std::vector<vk::raii::DescriptorSet> VulkanDescriptorSets;
+	// Resources replaced while frames in flight may still use them (swapchain, size-dependent targets)
+	DeletionQueue                    deletionQueue;
+	uint32_t                         swapChainRecreations = 0;
+	// Sets that live as long as the renderer; never reset
+	DescriptorAllocator descriptorAllocator;
+	// One per frame slot, reset wholesale once the frame that last used the slot completed
+	std::vector<DescriptorAllocator> frameDescriptorAllocators;
+	std::vector<vk::DescriptorSet> VulkanDescriptorSets;
+	// Set 1 of the scene pipelines: ObjectUniforms at a dynamic offset into the uniform arena, shared by all frames
+	vk::raii::DescriptorSetLayout objectDescriptorSetLayout = nullptr;
+	vk::DescriptorSet objectDescriptorSet;
 
 	std::vector<const char*> VulkanRequiredDeviceExtension = { vk::KHRSwapchainExtensionName,
 		vk::KHRSpirv14ExtensionName,
 		vk::KHRSynchronization2ExtensionName };
 
-	vk::raii::Image depthImage = nullptr;
-	vk::raii::DeviceMemory depthImageMemory = nullptr;
-	vk::raii::ImageView depthImageView = nullptr;
-
 	// Forward+ data
-	vk::raii::Buffer forwardPlusLightBuffer = nullptr;
-	vk::raii::DeviceMemory forwardPlusLightBufferMemory = nullptr;
+	GpuAllocator::Buffer forwardPlusLightBuffer = nullptr;
 	void* forwardPlusLightBufferMapped = nullptr;
-	vk::raii::Buffer tileLightIndexBuffer = nullptr;
-	vk::raii::DeviceMemory tileLightIndexBufferMemory = nullptr;
-	vk::raii::Buffer tileCountBuffer = nullptr;
-	vk::raii::DeviceMemory tileCountBufferMemory = nullptr;
+	// Per frame slot, indexed by frameIndex
+	std::vector<GpuAllocator::Buffer> tileLightIndexBuffers;
+	std::vector<GpuAllocator::Buffer> tileCountBuffers;
+	// Light culling on a separate compute queue, ordered before fragment shading with a timeline semaphore
+	AsyncComputeQueue asyncCompute;
+	bool asyncLightCulling = true;
+	bool lightCullingAsync = false; // the frame being recorded culls on the compute queue
 	
 	vk::raii::DescriptorSetLayout forwardPlusDescriptorSetLayout = nullptr;
-	vk::raii::DescriptorPool forwardPlusDescriptorPool = nullptr;
-	std::vector<vk::raii::DescriptorSet> forwardPlusDescriptorSets;
+	// This frame's set, allocated from its frame descriptor allocator so it always points at the current buffers
+	vk::DescriptorSet forwardPlusDescriptorSet;
 	
 	// Light culling compute pipeline
 	vk::raii::Pipeline lightCullingPipeline = nullptr;
@@ -455,25 +449,79 @@ protected:
 	std::vector<vk::raii::DescriptorSet> lightingPassDescriptorSets;
 	vk::raii::Pipeline lightingPassPipeline = nullptr;
 	vk::raii::PipelineLayout lightingPassPipelineLayout = nullptr;
-	vk::raii::Buffer lightingPassVertexBuffer = nullptr;
-	vk::raii::DeviceMemory lightingPassVertexBufferMemory = nullptr;
-	std::vector<vk::raii::Buffer> lightingPassLightBuffers;
-	std::vector<vk::raii::DeviceMemory> lightingPassLightBuffersMemory;
+	GpuAllocator::Buffer lightingPassVertexBuffer = nullptr;
+	std::vector<GpuAllocator::Buffer> lightingPassLightBuffers;
 	std::vector<void*> lightingPassLightBuffersMapped;
 
 	//Texture
-	vk::raii::Image textureImage = nullptr;
-	vk::raii::DeviceMemory textureImageMemory = nullptr;
-	vk::raii::ImageView textureImageView = nullptr;
 	vk::raii::Sampler textureSampler = nullptr;
+	// The texture's image is owned by the streamer and replaced as its resident mips change
+	TextureStreamer::Handle textureHandle = 0;
+	// Set 2 of the scene pipelines: every streamed texture, indexed by MaterialConstants::baseColorTexture
+	BindlessTextureTable bindlessTextures;
+	struct BindlessSlot
+	{
+		uint64_t viewGeneration = 0; // streamer view the slot was written with
+		BindlessTextureTable::Index index = 0;
+	};
+	std::vector<std::optional<BindlessSlot>> textureSlots; // per streamer handle
+	// Base color texture of each glTF material; primitives without a material use entry 0
+	std::vector<TextureStreamer::Handle> materialTextures;
+	// Formats KTX2/Basis textures are transcoded to on this device, best first
+	std::vector<TextureTranscoder::Target> textureTranscodeTargets;
 
 	//Model
 	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
+	std::vector<GpuVertex::Data> packedVertices;
+	std::vector<std::byte> packedIndices;
+	std::vector<Submesh> submeshes;
+	// Views of the model data handed to the GPU; they point into the mapped mesh cache on a warm start
+	// and into packedVertices/packedIndices/submeshes after a cold import
+	MeshCache modelCache;
+	std::span<const GpuVertex::Data> modelVertices;
+	std::span<const std::byte> modelIndices;
+	VertexQuantization modelQuantization;
+	std::vector<MeshLod> lods;
+	std::span<const MeshLod> modelLods;
+	std::span<const Submesh> modelSubmeshes;
+	glm::mat4 modelMatrix{ 1.0f };
+
+	// Camera
+	glm::vec3 cameraPosition{ 2.0f, 2.0f, 2.0f };
+	float cameraFovY = glm::radians(45.0f);
+
+	// LOD selection and per-frame statistics
+	float lodPixelError = 1.0f;
+	int lodOverride = -1;
+	std::array<uint32_t, MAX_MESH_LODS> lodDrawCounts{};
+	std::array<uint32_t, MAX_MESH_LODS> lodTriangleCounts{};
+
+	// Worker pool for asset decoding and command recording
+	JobSystem jobSystem;
+	// Per-thread command pools for secondary command buffers recorded on jobSystem
+	ParallelCommandRecorder commandRecorder;
+	bool parallelRecording = true;
+
+	// Asset uploads on the transfer queue; the model and its texture are drawn once assetUploadTicket is ready
+	UploadService uploadService;
+	UploadService::Ticket assetUploadTicket = 0;
+	uint64_t frameUploadWaitValue = 0;
+
+	// Mip-level texture residency under a VRAM budget, fed by per-draw texel density
+	TextureStreamer textureStreamer;
 
 	//ImGui
 	ImGuiVulkanUtil imGui;
 	SceneRenderTarget sceneRenderTarget;
+	// The scene renders into the top-left sceneRenderExtent of the target, picked per frame from GPU frame time
+	DynamicResolution dynamicResolution;
+	vk::Extent2D sceneRenderExtent;
+	// Passes and barriers of the frame being recorded; sceneColorState carries the color target's state across frames
+	RenderGraph frameGraph;
+	RenderGraph::State sceneColorState;
+	bool dumpFrameGraph = false;
+	// Frame-lifetime render targets (scene depth); rebuilt whenever their size changes
+	TransientAttachmentPool transientAttachments;
 private:
 
 	Window* RendererWindow = nullptr;
@@ -2,51 +2,41 @@
 
 #include <stdexcept>
 
-void SceneRenderTarget::create(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
-	uint32_t w, uint32_t h, vk::Format colorFmt, vk::Format depthFmt)
+void SceneRenderTarget::create(vk::raii::Device& device, GpuAllocator& allocator, TransientAttachmentPool& pool,
+	uint32_t w, uint32_t h, vk::Format colorFmt, vk::Format depthFmt, uint32_t depthFirstPass, uint32_t depthLastPass)
 {
 	width = w;
 	height = h;
 	colorFormat = colorFmt;
 	depthFormat = depthFmt;
 
-	createImage(device, physicalDevice, width, height, colorFormat, vk::ImageTiling::eOptimal,
+	createImage(allocator, width, height, colorFormat, vk::ImageTiling::eOptimal,
 		vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled,
-		vk::MemoryPropertyFlagBits::eDeviceLocal, colorImage, colorImageMemory);
+		vk::MemoryPropertyFlagBits::eDeviceLocal, colorImage);
 
 	colorImageView = createImageView(colorImage, colorFormat, vk::ImageAspectFlagBits::eColor, device);
 
-	createImage(device, physicalDevice, width, height, depthFormat, vk::ImageTiling::eOptimal,
-		vk::ImageUsageFlagBits::eDepthStencilAttachment,
-		vk::MemoryPropertyFlagBits::eDeviceLocal, depthImage, depthImageMemory);
-
-	depthImageView = createImageView(depthImage, depthFormat, vk::ImageAspectFlagBits::eDepth, device);
+	declareDepth(pool, depthFirstPass, depthLastPass);
 }
 
-void SceneRenderTarget::destroy(vk::raii::Device& device)
+void SceneRenderTarget::destroy()
 {
-	device.waitIdle();
-
 	colorImageView = nullptr;
-	depthImageView = nullptr;
 	colorImage = nullptr;
-	depthImage = nullptr;
-	colorImageMemory = nullptr;
-	depthImageMemory = nullptr;
+	transientAttachments = nullptr;
+	freeDescriptorSets.clear();
+	descriptorAllocator = nullptr;
 }
 
-void SceneRenderTarget::resize(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
-	uint32_t w, uint32_t h, vk::Format colorFmt, vk::Format depthFmt)
+void SceneRenderTarget::resize(vk::raii::Device& device, GpuAllocator& allocator, TransientAttachmentPool& pool,
+	DeletionQueue& deletionQueue, uint64_t retireFrame,
+	uint32_t w, uint32_t h, vk::Format colorFmt, vk::Format depthFmt, uint32_t depthFirstPass, uint32_t depthLastPass)
 {
-	device.waitIdle();
-
-	// Destroy old images only
+	// The old image lives on until the frames that render into or sample it completed
+	deletionQueue.push(retireFrame, std::move(colorImageView));
+	deletionQueue.push(retireFrame, std::move(colorImage));
 	colorImageView = nullptr;
-	depthImageView = nullptr;
 	colorImage = nullptr;
-	depthImage = nullptr;
-	colorImageMemory = nullptr;
-	depthImageMemory = nullptr;
 
 	// Recreate images with new size
 	width = w;
@@ -54,38 +44,34 @@ void SceneRenderTarget::resize(vk::raii::Device& device, vk::raii::PhysicalDevic
 	colorFormat = colorFmt;
 	depthFormat = depthFmt;
 
-	createImage(device, physicalDevice, width, height, colorFormat, vk::ImageTiling::eOptimal,
+	createImage(allocator, width, height, colorFormat, vk::ImageTiling::eOptimal,
 		vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled,
-		vk::MemoryPropertyFlagBits::eDeviceLocal, colorImage, colorImageMemory);
+		vk::MemoryPropertyFlagBits::eDeviceLocal, colorImage);
 
 	colorImageView = createImageView(colorImage, colorFormat, vk::ImageAspectFlagBits::eColor, device);
 
-	createImage(device, physicalDevice, width, height, depthFormat, vk::ImageTiling::eOptimal,
-		vk::ImageUsageFlagBits::eDepthStencilAttachment,
-		vk::MemoryPropertyFlagBits::eDeviceLocal, depthImage, depthImageMemory);
-
-	depthImageView = createImageView(depthImage, depthFormat, vk::ImageAspectFlagBits::eDepth, device);
-
-	// Update descriptor set with new image view
-	vk::DescriptorImageInfo imageInfo{};
-	imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-	imageInfo.imageView = *colorImageView;
-	imageInfo.sampler = *sampler;
+	declareDepth(pool, depthFirstPass, depthLastPass);
 
-	vk::WriteDescriptorSet writeSet{};
-	writeSet.dstSet = *descriptorSet;
-	writeSet.descriptorCount = 1;
-	writeSet.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-	writeSet.pImageInfo = &imageInfo;
-	writeSet.dstBinding = 0;
-
-	device.updateDescriptorSets({ writeSet }, {});
+	// A set must not be updated while a pending command buffer uses it, so the new image goes into another one
+	// and the old set becomes free again once the frames that bound it completed
+	vk::DescriptorSet previousSet = descriptorSet;
+	deletionQueue.call(retireFrame, [this, previousSet]() { freeDescriptorSets.push_back(previousSet); });
+	if (!freeDescriptorSets.empty())
+	{
+		descriptorSet = freeDescriptorSets.back();
+		freeDescriptorSets.pop_back();
+	}
+	else
+	{
+		descriptorSet = descriptorAllocator->allocate(*descriptorSetLayout, "Scene target");
+	}
+	writeDescriptorSet(device);
 }
 
-void SceneRenderTarget::createImage(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
+void SceneRenderTarget::createImage(GpuAllocator& allocator,
 	uint32_t w, uint32_t h, vk::Format format, vk::ImageTiling tiling,
 	vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
-	vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory)
+	GpuAllocator::Image& image)
 {
 	vk::ImageCreateInfo imageInfo;
 	imageInfo.imageType = vk::ImageType::e2D;
@@ -99,21 +85,31 @@ void SceneRenderTarget::createImage(vk::raii::Device& device, vk::raii::Physical
 	imageInfo.sharingMode = vk::SharingMode::eExclusive;
 	imageInfo.initialLayout = vk::ImageLayout::eUndefined;
 
-	image = vk::raii::Image(device, imageInfo);
-
-	vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
-	vk::MemoryAllocateInfo allocInfo;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
+	// Render targets get a dedicated allocation, so a resize hands the old memory straight back
+	image = allocator.createImage(imageInfo, properties, GpuAllocator::Category::RenderTarget);
+}
 
-	imageMemory = vk::raii::DeviceMemory(device, allocInfo);
-	image.bindMemory(*imageMemory, 0);
+void SceneRenderTarget::declareDepth(TransientAttachmentPool& pool, uint32_t firstPass, uint32_t lastPass)
+{
+	// Cleared at the start of the scene pass and never stored, so it needs no memory outside the frame
+	TransientAttachmentPool::Description description;
+	description.name = "Scene depth";
+	description.format = depthFormat;
+	description.width = width;
+	description.height = height;
+	description.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+	description.aspect = vk::ImageAspectFlagBits::eDepth;
+	description.firstPass = firstPass;
+	description.lastPass = lastPass;
+
+	transientAttachments = &pool;
+	depthAttachment = pool.add(description);
 }
 
-vk::raii::ImageView SceneRenderTarget::createImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags, vk::raii::Device& device)
+vk::raii::ImageView SceneRenderTarget::createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, vk::raii::Device& device)
 {
     vk::ImageViewCreateInfo viewInfo;
-    viewInfo.image = *image;
+    viewInfo.image = image;
     viewInfo.viewType = vk::ImageViewType::e2D;
     viewInfo.format = format;
     viewInfo.subresourceRange = { aspectFlags, 0, 1, 0, 1 };
@@ -121,21 +117,6 @@ vk::raii::ImageView SceneRenderTarget::createImageView(vk::raii::Image& image, v
     return vk::raii::ImageView(device, viewInfo);
 }
 
-uint32_t SceneRenderTarget::findMemoryType(vk::raii::PhysicalDevice& physicalDevice, uint32_t typeFilter, vk::MemoryPropertyFlags properties)
-{
-	vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
-
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-	{
-		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-		{
-			return i;
-		}
-	}
-
-	throw std::runtime_error("failed to find suitable memory type!");
-}
-
 void SceneRenderTarget::createSampler(vk::raii::Device& device)
 {
 	vk::SamplerCreateInfo samplerInfo{};
@@ -150,7 +131,7 @@ void SceneRenderTarget::createSampler(vk::raii::Device& device)
 	sampler = device.createSampler(samplerInfo);
 }
 
-void SceneRenderTarget::createDescriptorSet(vk::raii::Device& device, vk::raii::DescriptorPool& descriptorPool)
+void SceneRenderTarget::createDescriptorSet(vk::raii::Device& device, DescriptorAllocator& allocator)
 {
 	// Create descriptor set layout
 	vk::DescriptorSetLayoutBinding binding;
@@ -166,22 +147,21 @@ void SceneRenderTarget::createDescriptorSet(vk::raii::Device& device, vk::raii::
 	descriptorSetLayout = vk::raii::DescriptorSetLayout(device, layoutInfo);
 
 	// Allocate descriptor set
-	vk::DescriptorSetAllocateInfo allocInfo{};
-	allocInfo.descriptorPool = descriptorPool;
-	allocInfo.descriptorSetCount = 1;
-	vk::DescriptorSetLayout layouts[] = { *descriptorSetLayout };
-	allocInfo.pSetLayouts = layouts;
-
-	descriptorSet = std::move(device.allocateDescriptorSets(allocInfo).front());
+	descriptorAllocator = &allocator;
+	freeDescriptorSets.clear();
+	descriptorSet = descriptorAllocator->allocate(*descriptorSetLayout, "Scene target");
+	writeDescriptorSet(device);
+}
 
-	// Update descriptor set
+void SceneRenderTarget::writeDescriptorSet(vk::raii::Device& device)
+{
 	vk::DescriptorImageInfo imageInfo{};
 	imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
 	imageInfo.imageView = *colorImageView;
 	imageInfo.sampler = *sampler;
 
 	vk::WriteDescriptorSet writeSet{};
-	writeSet.dstSet = *descriptorSet;
+	writeSet.dstSet = descriptorSet;
 	writeSet.descriptorCount = 1;
 	writeSet.descriptorType = vk::DescriptorType::eCombinedImageSampler;
 	writeSet.pImageInfo = &imageInfo;
@@ -1,60 +1,79 @@
 #pragma once
 
+#include "DeletionQueue.h"
+#include "DescriptorAllocator.h"
+#include "GpuAllocator.h"
+#include "TransientAttachmentPool.h"
+
 #include <vulkan/vulkan_raii.hpp>
 
 #include <cstdint>
 #include <vector>
 
+/// Color target the scene is rendered into and ImGui samples. Depth only lives within the scene passes, so it is
+/// declared in the transient attachment pool; the owner builds the pool once every target was declared.
 class SceneRenderTarget
 {
 public:
 	SceneRenderTarget() = default;
 	~SceneRenderTarget() = default;
 
-	void create(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
-		uint32_t width, uint32_t height, vk::Format colorFormat, vk::Format depthFormat);
-	void destroy(vk::raii::Device& device);
-	void resize(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
-		uint32_t width, uint32_t height, vk::Format colorFormat, vk::Format depthFormat);
+	/// depthFirstPass/depthLastPass are the frame passes that use the depth attachment
+	void create(vk::raii::Device& device, GpuAllocator& allocator, TransientAttachmentPool& transientAttachments,
+		uint32_t width, uint32_t height, vk::Format colorFormat, vk::Format depthFormat, uint32_t depthFirstPass, uint32_t depthLastPass);
+	/// The GPU must be done with the target
+	void destroy();
+	/// transientAttachments must have been reset or retired since the previous create or resize. Frames up to
+	/// retireFrame may still sample the old image and descriptor set, so they go to deletionQueue; the descriptor
+	/// set changes, and the new one has to be handed to ImGui again.
+	void resize(vk::raii::Device& device, GpuAllocator& allocator, TransientAttachmentPool& transientAttachments,
+		DeletionQueue& deletionQueue, uint64_t retireFrame,
+		uint32_t width, uint32_t height, vk::Format colorFormat, vk::Format depthFormat, uint32_t depthFirstPass, uint32_t depthLastPass);
 
-	vk::raii::Image& getColorImage() { return colorImage; }
+	GpuAllocator::Image& getColorImage() { return colorImage; }
 	vk::raii::ImageView& getColorImageView() { return colorImageView; }
-	vk::raii::Image& getDepthImage() { return depthImage; }
-	vk::raii::ImageView& getDepthImageView() { return depthImageView; }
+	vk::Image getDepthImage() const { return transientAttachments->getImage(depthAttachment); }
+	vk::ImageView getDepthImageView() const { return transientAttachments->getImageView(depthAttachment); }
 	uint32_t getWidth() const { return width; }
 	uint32_t getHeight() const { return height; }
+	vk::Format getColorFormat() const { return colorFormat; }
+	vk::Format getDepthFormat() const { return depthFormat; }
 
 	vk::raii::Sampler sampler{ nullptr };
 	vk::raii::DescriptorSetLayout descriptorSetLayout{ nullptr };
-	vk::raii::DescriptorSet descriptorSet{ nullptr };
+	vk::DescriptorSet descriptorSet;
 
 	void createSampler(vk::raii::Device& device);
-	void createDescriptorSet(vk::raii::Device& device, vk::raii::DescriptorPool& descriptorPool);
+	/// Sets come from a long-lived allocator. A resize switches to another set, since the current one may still be
+	/// bound by frames in flight; sets those frames released are reused.
+	void createDescriptorSet(vk::raii::Device& device, DescriptorAllocator& descriptorAllocator);
 
-	vk::raii::DescriptorSet& getDescriptorSet() { return descriptorSet; }
-	VkDescriptorSet getVkDescriptorSet() { return *descriptorSet; }
+	vk::DescriptorSet getDescriptorSet() const { return descriptorSet; }
+	VkDescriptorSet getVkDescriptorSet() const { return descriptorSet; }
 	vk::raii::Sampler& getSampler() { return sampler; }
 
 private:
-	void createImage(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice,
+	void createImage(GpuAllocator& allocator,
 		uint32_t w, uint32_t h, vk::Format format, vk::ImageTiling tiling,
 		vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
-		vk::raii::Image& image, vk::raii::DeviceMemory& imageMemory);
-
-    vk::raii::ImageView createImageView(vk::raii::Image& image, vk::Format format, vk::ImageAspectFlags aspectFlags, vk::raii::Device& device);
+		GpuAllocator::Image& image);
+	void declareDepth(TransientAttachmentPool& pool, uint32_t firstPass, uint32_t lastPass);
+	void writeDescriptorSet(vk::raii::Device& device);
 
-	uint32_t findMemoryType(vk::raii::PhysicalDevice& physicalDevice, uint32_t typeFilter, vk::MemoryPropertyFlags properties);
+    vk::raii::ImageView createImageView(vk::Image image, vk::Format format, vk::ImageAspectFlags aspectFlags, vk::raii::Device& device);
 
 	uint32_t width = 0;
 	uint32_t height = 0;
 	vk::Format colorFormat = vk::Format::eB8G8R8A8Unorm;
 	vk::Format depthFormat = vk::Format::eD32Sfloat;
 
-	vk::raii::Image colorImage{ nullptr };
-	vk::raii::DeviceMemory colorImageMemory{ nullptr };
+	GpuAllocator::Image colorImage{ nullptr };
 	vk::raii::ImageView colorImageView{ nullptr };
 
-	vk::raii::Image depthImage{ nullptr };
-	vk::raii::DeviceMemory depthImageMemory{ nullptr };
-	vk::raii::ImageView depthImageView{ nullptr };
+	TransientAttachmentPool* transientAttachments = nullptr;
+	TransientAttachmentPool::Handle depthAttachment = 0;
+
+	DescriptorAllocator* descriptorAllocator = nullptr;
+	// Sets of earlier sizes that no frame in flight uses any more
+	std::vector<vk::DescriptorSet> freeDescriptorSets;
 };
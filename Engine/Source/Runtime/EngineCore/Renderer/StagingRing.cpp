@@ -0,0 +1,120 @@
+#include "StagingRing.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void StagingRing::init(vk::raii::Device& inDevice, GpuAllocator& allocator, vk::Semaphore inTimeline, vk::DeviceSize inCapacity)
+{
+	device = &inDevice;
+	timeline = inTimeline;
+	capacity = inCapacity;
+
+	vk::BufferCreateInfo bufferInfo;
+	bufferInfo.size = capacity;
+	bufferInfo.usage = vk::BufferUsageFlagBits::eTransferSrc;
+	bufferInfo.sharingMode = vk::SharingMode::eExclusive;
+	buffer = allocator.createBuffer(bufferInfo, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+		GpuAllocator::Category::Staging);
+	mapped = static_cast<std::byte*>(buffer.getMappedData());
+
+	head = 0;
+	tail = 0;
+	regions.clear();
+	sealedCount = 0;
+	statistics = {};
+	statistics.capacity = capacity;
+}
+
+void StagingRing::destroy()
+{
+	regions.clear();
+	sealedCount = 0;
+	head = 0;
+	tail = 0;
+	mapped = nullptr;
+	buffer = nullptr;
+	timeline = nullptr;
+}
+
+std::optional<StagingRing::Allocation> StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment, bool wait)
+{
+	if (size > capacity)
+	{
+		throw std::runtime_error("staging allocation is larger than the staging ring!");
+	}
+
+	bool waited = false;
+	while (true)
+	{
+		reclaim(device->getSemaphoreCounterValue(timeline));
+
+		// An allocation never straddles the end of the buffer; the rest of the lap is padding instead
+		vk::DeviceSize position = head % capacity;
+		vk::DeviceSize offset = (position + alignment - 1) / alignment * alignment;
+		if (offset + size > capacity)
+		{
+			offset = 0;
+		}
+		vk::DeviceSize needed = (offset >= position ? offset - position : capacity - position) + size;
+
+		if (capacity - (head - tail) >= needed)
+		{
+			head += needed;
+			regions.push_back({ head, 0 });
+
+			statistics.allocations++;
+			statistics.peakBytesInUse = std::max<vk::DeviceSize>(statistics.peakBytesInUse, head - tail);
+			if (waited)
+			{
+				statistics.gpuWaits++;
+			}
+			return Allocation{ *buffer, offset, mapped + offset, size };
+		}
+
+		// Whatever is left belongs to the batch still being recorded
+		if (sealedCount == 0 || !wait)
+		{
+			return std::nullopt;
+		}
+
+		vk::SemaphoreWaitInfo waitInfo;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &timeline;
+		waitInfo.pValues = &regions.front().releaseValue;
+		(void)device->waitSemaphores(waitInfo, UINT64_MAX);
+		waited = true;
+	}
+}
+
+void StagingRing::seal(uint64_t timelineValue)
+{
+	for (size_t index = sealedCount; index < regions.size(); index++)
+	{
+		regions[index].releaseValue = timelineValue;
+	}
+	sealedCount = regions.size();
+}
+
+void StagingRing::reclaim(uint64_t completedValue)
+{
+	while (sealedCount > 0 && regions.front().releaseValue <= completedValue)
+	{
+		tail = regions.front().end;
+		regions.pop_front();
+		sealedCount--;
+	}
+
+	// An idle ring starts over at offset 0, so the next allocations need no wrap padding
+	if (regions.empty())
+	{
+		head = 0;
+		tail = 0;
+	}
+}
+
+StagingRing::Statistics StagingRing::getStatistics() const
+{
+	Statistics result = statistics;
+	result.bytesInUse = head - tail;
+	return result;
+}
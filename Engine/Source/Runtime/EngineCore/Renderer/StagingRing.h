@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GpuAllocator.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+/// One persistently mapped host-visible buffer that all uploads stage through, used as a FIFO ring.
+/// Allocating is a bump of the head; space is reclaimed from the tail once the timeline semaphore
+/// passes the value of the batch that read it. Allocations made since the last seal() belong to the
+/// batch being recorded and cannot be reclaimed before that batch is sealed with its timeline value.
+/// Not thread safe; the owner serializes access.
+class StagingRing
+{
+public:
+	struct Allocation
+	{
+		vk::Buffer buffer;
+		vk::DeviceSize offset = 0;
+		std::byte* data = nullptr;
+		vk::DeviceSize size = 0;
+	};
+
+	struct Statistics
+	{
+		vk::DeviceSize capacity = 0;
+		vk::DeviceSize bytesInUse = 0; // allocated and not yet reclaimed, including wrap padding
+		vk::DeviceSize peakBytesInUse = 0;
+		uint64_t allocations = 0;
+		uint32_t gpuWaits = 0; // allocations that had to wait for the GPU to free space
+	};
+
+	StagingRing() = default;
+	~StagingRing() = default;
+
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	/// timeline is the semaphore the values passed to seal() are signaled on
+	void init(vk::raii::Device& device, GpuAllocator& allocator, vk::Semaphore timeline, vk::DeviceSize capacity);
+	void destroy();
+
+	/// size bytes at offset alignment. Returns nullopt when the space is held by allocations that were not
+	/// sealed yet, which only submitting the open batch can free. With wait, blocks on the timeline until
+	/// sealed allocations retire; otherwise also returns nullopt when sealed ones still hold the space.
+	/// size must not exceed getCapacity().
+	std::optional<Allocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment, bool wait);
+
+	/// Every allocation since the previous seal is released once the timeline reaches timelineValue
+	void seal(uint64_t timelineValue);
+
+	vk::DeviceSize getCapacity() const { return capacity; }
+	Statistics getStatistics() const;
+
+private:
+	struct Region
+	{
+		uint64_t end = 0; // head position after the allocation, including its padding
+		uint64_t releaseValue = 0; // 0 until sealed
+	};
+
+	void reclaim(uint64_t completedValue);
+
+	vk::raii::Device* device = nullptr;
+	vk::Semaphore timeline;
+	GpuAllocator::Buffer buffer{ nullptr };
+	std::byte* mapped = nullptr;
+	vk::DeviceSize capacity = 0;
+
+	// Monotonic byte positions; the ring offset is position % capacity
+	uint64_t head = 0;
+	uint64_t tail = 0;
+	std::deque<Region> regions;
+	size_t sealedCount = 0; // regions at the front of the deque that have a release value
+
+	Statistics statistics;
+};
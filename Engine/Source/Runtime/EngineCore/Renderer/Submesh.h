@@ -0,0 +1,27 @@
+#pragma once
+
+#include "MeshLod.h"
+
+#include <cstdint>
+
+/// One glTF primitive after import: a range of the shared vertex buffer and its own indices, LOD chain
+/// and bounds. Submeshes under 65536 vertices keep 16-bit indices; the index buffer mixes both widths,
+/// each submesh's range aligned to its index size.
+struct Submesh
+{
+	uint32_t vertexOffset = 0; // first vertex in the shared vertex buffer, passed as drawIndexed's vertexOffset
+	uint32_t vertexCount = 0;
+	uint32_t indexByteOffset = 0; // start of the submesh's indices in the index buffer
+	uint32_t indexCount = 0; // LOD 0
+	uint32_t indexSize = 4; // 2 or 4 bytes
+	uint32_t firstLod = 0; // into the model's LOD table; LOD firstIndex values are relative to this submesh
+	uint32_t lodCount = 0;
+	int32_t material = -1; // glTF material index, -1 when the primitive has none
+	MeshBounds bounds;
+	float uvDensity = 0.0f; // UV units per model unit, drives texture streaming requests
+
+	vk::IndexType getIndexType() const { return indexSize == 2 ? vk::IndexType::eUint16 : vk::IndexType::eUint32; }
+
+	/// First index of the submesh when the whole index buffer is bound at offset 0 with its index type
+	uint32_t getFirstIndex() const { return indexByteOffset / indexSize; }
+};
@@ -0,0 +1,428 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	constexpr uint32_t RGBA8_TEXEL_SIZE = 4;
+
+	/// Appends the 2x2 box-filtered chain below level 0 to an RGBA8 image; odd edges are clamped like the GPU downsample
+	std::vector<size_t> appendRgba8MipChain(std::vector<std::byte>& pixels, uint32_t width, uint32_t height)
+	{
+		std::vector<size_t> offsets{ 0 };
+		uint32_t levelWidth = width;
+		uint32_t levelHeight = height;
+		while (levelWidth > 1 || levelHeight > 1)
+		{
+			uint32_t nextWidth = std::max(levelWidth / 2, 1u);
+			uint32_t nextHeight = std::max(levelHeight / 2, 1u);
+			size_t sourceOffset = offsets.back();
+			size_t destinationOffset = pixels.size();
+			pixels.resize(destinationOffset + static_cast<size_t>(nextWidth) * nextHeight * RGBA8_TEXEL_SIZE);
+
+			auto sourceTexel = [&](uint32_t x, uint32_t y)
+			{
+				x = std::min(x, levelWidth - 1);
+				y = std::min(y, levelHeight - 1);
+				return reinterpret_cast<const uint8_t*>(pixels.data() + sourceOffset + (static_cast<size_t>(y) * levelWidth + x) * RGBA8_TEXEL_SIZE);
+			};
+
+			uint8_t* destination = reinterpret_cast<uint8_t*>(pixels.data() + destinationOffset);
+			for (uint32_t y = 0; y < nextHeight; y++)
+			{
+				for (uint32_t x = 0; x < nextWidth; x++)
+				{
+					const uint8_t* texels[4] = { sourceTexel(x * 2, y * 2), sourceTexel(x * 2 + 1, y * 2), sourceTexel(x * 2, y * 2 + 1), sourceTexel(x * 2 + 1, y * 2 + 1) };
+					for (uint32_t channel = 0; channel < RGBA8_TEXEL_SIZE; channel++)
+					{
+						uint32_t sum = texels[0][channel] + texels[1][channel] + texels[2][channel] + texels[3][channel];
+						*destination++ = static_cast<uint8_t>((sum + 2) / 4);
+					}
+				}
+			}
+
+			offsets.push_back(destinationOffset);
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+		return offsets;
+	}
+}
+
+TextureStreamer::Source TextureStreamer::makeSource(TextureTranscoder::Texture&& texture)
+{
+	const bool rgba8 = texture.format == vk::Format::eR8G8B8A8Unorm || texture.format == vk::Format::eR8G8B8A8Srgb;
+	if (texture.mipLevels == 1 && rgba8)
+	{
+		std::span<const std::byte> data = texture.getData();
+		return makeSource(std::vector<std::byte>(data.begin(), data.end()), texture.format, texture.width, texture.height);
+	}
+
+	Source source;
+	source.format = texture.format;
+	source.width = texture.width;
+	source.height = texture.height;
+	for (uint32_t level = 0; level < texture.mipLevels; level++)
+	{
+		ktx_size_t offset = 0;
+		ktxTexture_GetImageOffset(ktxTexture(texture.ktx.get()), level, 0, 0, &offset);
+		ktx_size_t size = ktxTexture_GetImageSize(ktxTexture(texture.ktx.get()), level);
+		source.levels.push_back(texture.getData().subspan(offset, size));
+	}
+	source.storage = std::shared_ptr<ktxTexture2>(std::move(texture.ktx));
+	return source;
+}
+
+TextureStreamer::Source TextureStreamer::makeSource(std::vector<std::byte>&& pixels, vk::Format format, uint32_t width, uint32_t height)
+{
+	if (pixels.size() != static_cast<size_t>(width) * height * RGBA8_TEXEL_SIZE)
+	{
+		throw std::runtime_error("texture source size does not match its RGBA8 extent");
+	}
+
+	auto storage = std::make_shared<std::vector<std::byte>>(std::move(pixels));
+	std::vector<size_t> offsets = appendRgba8MipChain(*storage, width, height);
+
+	Source source;
+	source.format = format;
+	source.width = width;
+	source.height = height;
+	source.generatedMips = offsets.size() > 1;
+	for (uint32_t level = 0; level < offsets.size(); level++)
+	{
+		size_t size = static_cast<size_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * RGBA8_TEXEL_SIZE;
+		source.levels.push_back(std::span<const std::byte>(*storage).subspan(offsets[level], size));
+	}
+	source.storage = std::move(storage);
+	return source;
+}
+
+float TextureStreamer::computeUvDensity(std::span<const uint32_t> indices, std::span<const Vertex> vertices)
+{
+	double surfaceArea = 0.0;
+	double uvArea = 0.0;
+	for (size_t index = 0; index + 2 < indices.size(); index += 3)
+	{
+		const Vertex& a = vertices[indices[index]];
+		const Vertex& b = vertices[indices[index + 1]];
+		const Vertex& c = vertices[indices[index + 2]];
+		surfaceArea += glm::length(glm::cross(b.pos - a.pos, c.pos - a.pos));
+		glm::vec2 uvB = b.texCoord - a.texCoord;
+		glm::vec2 uvC = c.texCoord - a.texCoord;
+		uvArea += std::abs(uvB.x * uvC.y - uvB.y * uvC.x);
+	}
+	return surfaceArea > 0.0 ? static_cast<float>(std::sqrt(uvArea / surfaceArea)) : 0.0f;
+}
+
+uint32_t TextureStreamer::selectMipLevel(float uvDensity, uint32_t textureSize, float pixelsPerUnit, uint32_t mipLevels)
+{
+	if (mipLevels == 0)
+	{
+		return 0;
+	}
+	// Degenerate UVs (computeUvDensity found no area) give no density to go by; the coarsest level is enough
+	if (uvDensity <= 0.0f)
+	{
+		return mipLevels - 1;
+	}
+
+	// Every mip level halves the texels a screen pixel covers; level 0 is needed once there is one texel per pixel or less
+	float texelsPerPixel = uvDensity * static_cast<float>(textureSize) / std::max(pixelsPerUnit, 1e-6f);
+	if (texelsPerPixel <= 1.0f)
+	{
+		return 0;
+	}
+	return std::min(static_cast<uint32_t>(std::log2(texelsPerPixel)), mipLevels - 1);
+}
+
+void TextureStreamer::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& inPhysicalDevice, GpuAllocator& inAllocator, UploadService& inUploadService, uint32_t inFramesInFlight, const Settings& inSettings)
+{
+	device = &inDevice;
+	physicalDevice = &inPhysicalDevice;
+	allocator = &inAllocator;
+	uploadService = &inUploadService;
+	framesInFlight = inFramesInFlight;
+	settings = inSettings;
+}
+
+void TextureStreamer::destroy()
+{
+	retired.clear();
+	textures.clear();
+}
+
+TextureStreamer::Handle TextureStreamer::add(Source source)
+{
+	if (source.levels.empty())
+	{
+		throw std::runtime_error("texture source has no mip levels");
+	}
+
+	StreamedTexture texture;
+	texture.source = std::move(source);
+	texture.mipMethod = texture.source.generatedMips ? uploadService->getMipGenerator().getMethod(texture.source.format) : MipGenerator::Method::None;
+	texture.lastNeededFrame.assign(texture.source.getMipLevels(), 0);
+
+	// Low mips first: the tail is tiny and lets the texture be drawn right away
+	uint32_t level = 0;
+	while (level + 1 < texture.source.getMipLevels() &&
+		std::max(texture.source.width >> level, texture.source.height >> level) > settings.initialMaxDimension)
+	{
+		level++;
+	}
+	texture.resident = createResidency(texture, level);
+	texture.lastRequest = level;
+
+	textures.push_back(std::move(texture));
+	return static_cast<Handle>(textures.size() - 1);
+}
+
+vk::ImageCreateInfo TextureStreamer::getImageInfo(const StreamedTexture& texture, uint32_t level) const
+{
+	vk::ImageCreateInfo imageInfo;
+	imageInfo.imageType = vk::ImageType::e2D;
+	imageInfo.format = texture.source.format;
+	imageInfo.extent = vk::Extent3D{ std::max(texture.source.width >> level, 1u), std::max(texture.source.height >> level, 1u), 1 };
+	imageInfo.mipLevels = texture.source.getMipLevels() - level;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = vk::SampleCountFlagBits::e1;
+	imageInfo.tiling = vk::ImageTiling::eOptimal;
+	imageInfo.usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled | MipGenerator::getRequiredUsage(texture.mipMethod);
+	imageInfo.sharingMode = vk::SharingMode::eExclusive;
+	imageInfo.initialLayout = vk::ImageLayout::eUndefined;
+	return imageInfo;
+}
+
+vk::DeviceSize TextureStreamer::getResidencyBytes(const StreamedTexture& texture, uint32_t level) const
+{
+	vk::ImageCreateInfo imageInfo = getImageInfo(texture, level);
+	vk::DeviceImageMemoryRequirements requirementsInfo;
+	requirementsInfo.pCreateInfo = &imageInfo;
+	return device->getImageMemoryRequirements(requirementsInfo).memoryRequirements.size;
+}
+
+TextureStreamer::Residency TextureStreamer::createResidency(const StreamedTexture& texture, uint32_t level)
+{
+	const Source& source = texture.source;
+	vk::ImageCreateInfo imageInfo = getImageInfo(texture, level);
+
+	Residency residency;
+	residency.level = level;
+	residency.image = allocator->createImage(imageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, GpuAllocator::Category::Texture);
+	residency.bytes = residency.image.getSize();
+
+	vk::ImageViewCreateInfo viewInfo;
+	viewInfo.image = *residency.image;
+	viewInfo.viewType = vk::ImageViewType::e2D;
+	viewInfo.format = source.format;
+	viewInfo.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, imageInfo.mipLevels, 0, 1 };
+	residency.view = vk::raii::ImageView(*device, viewInfo);
+
+	if (texture.mipMethod != MipGenerator::Method::None)
+	{
+		// Only the finest level crosses the bus; the GPU rebuilds the tail from it
+		uploadService->uploadImageGenerateMips(source.levels[level], *residency.image, source.format, imageInfo.extent.width, imageInfo.extent.height,
+			imageInfo.mipLevels, vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead);
+		statistics.bytesStreamed += source.levels[level].size();
+		return residency;
+	}
+
+	std::vector<std::byte> packed;
+	std::vector<vk::BufferImageCopy> regions;
+	for (uint32_t sourceLevel = level; sourceLevel < source.getMipLevels(); sourceLevel++)
+	{
+		vk::BufferImageCopy region;
+		region.bufferOffset = packed.size();
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource = { vk::ImageAspectFlagBits::eColor, sourceLevel - level, 0, 1 };
+		region.imageOffset = vk::Offset3D{ 0, 0, 0 };
+		region.imageExtent = vk::Extent3D{ std::max(source.width >> sourceLevel, 1u), std::max(source.height >> sourceLevel, 1u), 1 };
+		regions.push_back(region);
+
+		// Copy offsets must stay texel block aligned; every supported format has blocks of at most 16 bytes
+		packed.insert(packed.end(), source.levels[sourceLevel].begin(), source.levels[sourceLevel].end());
+		packed.resize((packed.size() + 15) & ~size_t(15));
+	}
+
+	uploadService->uploadImage(packed, *residency.image, source.format, imageInfo.mipLevels, regions, vk::ImageLayout::eShaderReadOnlyOptimal,
+		vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead);
+	statistics.bytesStreamed += packed.size();
+	return residency;
+}
+
+void TextureStreamer::beginFrame()
+{
+	frameNumber++;
+
+	while (!retired.empty() && retired.front().releaseFrame <= frameNumber)
+	{
+		retired.pop_front();
+	}
+
+	for (StreamedTexture& texture : textures)
+	{
+		if (texture.pending && uploadService->isReady(texture.pending->ticket))
+		{
+			// Frames still in flight may sample the old image through their own descriptor sets
+			retired.push_back({ frameNumber + framesInFlight, std::move(texture.resident) });
+			texture.resident = std::move(*texture.pending);
+			texture.pending.reset();
+			texture.viewGeneration++;
+		}
+	}
+}
+
+void TextureStreamer::requestLevel(Handle handle, uint32_t level)
+{
+	StreamedTexture& texture = textures[handle];
+	texture.frameRequest = std::min(texture.frameRequest, level);
+}
+
+void TextureStreamer::endFrame()
+{
+	for (StreamedTexture& texture : textures)
+	{
+		if (texture.frameRequest == UINT32_MAX)
+		{
+			continue;
+		}
+		texture.lastRequest = std::min(texture.frameRequest, texture.source.getMipLevels() - 1);
+		for (uint32_t level = texture.lastRequest; level < texture.source.getMipLevels(); level++)
+		{
+			texture.lastNeededFrame[level] = frameNumber;
+		}
+		texture.frameRequest = UINT32_MAX;
+	}
+
+	// A lowered budget is honored even when nothing new is requested
+	while (getCommittedBytes() > settings.budgetBytes && evictLeastRecentlyNeeded(std::nullopt))
+	{
+	}
+
+	for (Handle handle = 0; handle < textures.size(); handle++)
+	{
+		StreamedTexture& texture = textures[handle];
+		if (texture.pending || texture.lastRequest >= texture.resident.level)
+		{
+			continue;
+		}
+
+		// Make room by shrinking what was needed least recently; settle for a coarser level if that is not enough
+		uint32_t level = texture.lastRequest;
+		while (level < texture.resident.level &&
+			getCommittedBytes() - texture.resident.bytes + getResidencyBytes(texture, level) > settings.budgetBytes)
+		{
+			if (!evictLeastRecentlyNeeded(handle))
+			{
+				level++;
+			}
+		}
+		if (level >= texture.resident.level)
+		{
+			continue;
+		}
+
+		statistics.levelsStreamedIn += texture.resident.level - level;
+		texture.pending = createResidency(texture, level);
+	}
+
+	// Stream-ins and evictions recorded this frame go out as one batch
+	bool recorded = std::ranges::any_of(textures, [](const StreamedTexture& texture) { return texture.pending && texture.pending->ticket == 0; });
+	if (recorded)
+	{
+		UploadService::Ticket ticket = uploadService->submit();
+		for (StreamedTexture& texture : textures)
+		{
+			if (texture.pending && texture.pending->ticket == 0)
+			{
+				texture.pending->ticket = ticket;
+			}
+		}
+	}
+}
+
+bool TextureStreamer::evictLeastRecentlyNeeded(std::optional<Handle> except)
+{
+	std::optional<Handle> victim;
+	for (Handle handle = 0; handle < textures.size(); handle++)
+	{
+		const StreamedTexture& texture = textures[handle];
+		if (handle == except || texture.pending || texture.resident.level + 1 >= texture.source.getMipLevels())
+		{
+			continue;
+		}
+		// Levels the current frame asked for are never evicted
+		uint64_t lastNeeded = texture.lastNeededFrame[texture.resident.level];
+		if (lastNeeded >= frameNumber)
+		{
+			continue;
+		}
+		if (!victim || lastNeeded < textures[*victim].lastNeededFrame[textures[*victim].resident.level])
+		{
+			victim = handle;
+		}
+	}
+
+	if (!victim)
+	{
+		return false;
+	}
+
+	StreamedTexture& texture = textures[*victim];
+	texture.pending = createResidency(texture, texture.resident.level + 1);
+	statistics.levelsEvicted++;
+	return true;
+}
+
+vk::DeviceSize TextureStreamer::getCommittedBytes() const
+{
+	vk::DeviceSize bytes = 0;
+	for (const StreamedTexture& texture : textures)
+	{
+		bytes += texture.pending ? texture.pending->bytes : texture.resident.bytes;
+	}
+	return bytes;
+}
+
+TextureStreamer::Statistics TextureStreamer::getStatistics() const
+{
+	Statistics result = statistics;
+	result.committedBytes = getCommittedBytes();
+	result.budgetBytes = settings.budgetBytes;
+	for (const StreamedTexture& texture : textures)
+	{
+		result.residentBytes += texture.resident.bytes;
+		if (texture.pending)
+		{
+			result.pendingUploads++;
+		}
+		if (texture.lastRequest < (texture.pending ? texture.pending->level : texture.resident.level))
+		{
+			result.unmetRequests++;
+		}
+	}
+	return result;
+}
+
+TextureStreamer::TextureState TextureStreamer::getTextureState(Handle handle) const
+{
+	const StreamedTexture& texture = textures[handle];
+
+	TextureState state;
+	state.width = texture.source.width;
+	state.height = texture.source.height;
+	state.mipLevels = texture.source.getMipLevels();
+	state.residentLevel = texture.resident.level;
+	if (texture.pending)
+	{
+		state.pendingLevel = texture.pending->level;
+	}
+	state.requestedLevel = texture.lastRequest;
+	state.residentBytes = texture.resident.bytes;
+	state.format = texture.source.format;
+	state.mipMethod = texture.mipMethod;
+	return state;
+}
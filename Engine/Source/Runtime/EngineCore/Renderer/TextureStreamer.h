@@ -0,0 +1,167 @@
+#pragma once
+
+#include "GpuAllocator.h"
+#include "TextureTranscoder.h"
+#include "UploadService.h"
+#include "Vertex.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// Keeps textures resident only down to the mip level the frame actually needs, within a VRAM budget.
+/// Every texture starts with its small tail mips; draws report the finest level they need from their
+/// screen-space texel density, and the streamer uploads a larger image holding the chain from that level
+/// down. When the budget would be exceeded, textures whose finest level went unneeded the longest are
+/// shrunk by one level (LRU). A residency change replaces the whole image: the tail mips are re-uploaded
+/// with the new level, which costs at most a third on top of the level itself and needs no image-to-image
+/// copy across the transfer and graphics queues. The previous image stays alive until the frames that
+/// sampled it have retired.
+class TextureStreamer
+{
+public:
+	using Handle = uint32_t;
+
+	/// CPU copy of a texture's whole mip chain, the source every residency change is uploaded from
+	struct Source
+	{
+		vk::Format format = vk::Format::eUndefined;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<std::span<const std::byte>> levels; // level 0 first
+		std::shared_ptr<const void> storage; // owns the memory levels point into
+		bool generatedMips = false; // levels past 0 were box-filtered on load rather than authored
+
+		uint32_t getMipLevels() const { return static_cast<uint32_t>(levels.size()); }
+	};
+
+	struct Settings
+	{
+		vk::DeviceSize budgetBytes = 256ull * 1024 * 1024;
+		// Residency starts at the first level whose larger side is at most this many texels
+		uint32_t initialMaxDimension = 128;
+	};
+
+	struct Statistics
+	{
+		vk::DeviceSize residentBytes = 0;
+		vk::DeviceSize committedBytes = 0; // resident plus the images of pending residency changes
+		vk::DeviceSize budgetBytes = 0;
+		uint32_t pendingUploads = 0;
+		uint32_t unmetRequests = 0; // textures whose requested level is finer than what is resident or pending
+		uint64_t levelsStreamedIn = 0;
+		uint64_t levelsEvicted = 0;
+		uint64_t bytesStreamed = 0;
+	};
+
+	/// Per-texture view of the streaming state for the stats panel
+	struct TextureState
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		uint32_t residentLevel = 0; // finest resident level
+		std::optional<uint32_t> pendingLevel;
+		uint32_t requestedLevel = 0; // finest level the last frame asked for
+		vk::DeviceSize residentBytes = 0;
+		vk::Format format = vk::Format::eUndefined;
+		MipGenerator::Method mipMethod = MipGenerator::Method::None; // None when mips are uploaded from the source
+	};
+
+	TextureStreamer() = default;
+	~TextureStreamer() = default;
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	/// Source of a loaded KTX2 texture. Textures authored with a single level get a CPU chain when the format is RGBA8.
+	static Source makeSource(TextureTranscoder::Texture&& texture);
+	/// Source of tightly packed RGBA8 pixels; the mip chain is box-filtered on the CPU
+	static Source makeSource(std::vector<std::byte>&& pixels, vk::Format format, uint32_t width, uint32_t height);
+
+	/// UV units per model unit over a triangle list, the square root of the UV area to surface area ratio.
+	/// Multiplied by the texture size it gives texels per model unit.
+	static float computeUvDensity(std::span<const uint32_t> indices, std::span<const Vertex> vertices);
+	/// Finest mip level a surface needs, from its UV density, the texture's larger side and the screen
+	/// pixels one model unit covers at the surface's distance. Without a UV density it is the coarsest level.
+	static uint32_t selectMipLevel(float uvDensity, uint32_t textureSize, float pixelsPerUnit, uint32_t mipLevels);
+
+	/// framesInFlight bounds how long replaced images are kept. Uploads go through uploadService.
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, GpuAllocator& allocator, UploadService& uploadService, uint32_t framesInFlight, const Settings& settings);
+	void destroy();
+
+	/// Creates the texture with its tail mips and records their upload into the upload service's open batch
+	Handle add(Source source);
+
+	/// Render thread, once per frame after UploadService::recordAcquires: swaps in residency changes that
+	/// finished uploading and frees images no frame can still be sampling
+	void beginFrame();
+	/// Render thread, while recording: a draw sampling the texture needs level and everything coarser
+	void requestLevel(Handle handle, uint32_t level);
+	/// Render thread, after recording: turns this frame's requests into uploads, evicting under budget pressure
+	void endFrame();
+
+	vk::ImageView getImageView(Handle handle) const { return *textures[handle].resident.view; }
+	/// Changes whenever getImageView returns a different view; descriptor sets compare against it
+	uint64_t getViewGeneration(Handle handle) const { return textures[handle].viewGeneration; }
+
+	void setBudget(vk::DeviceSize budgetBytes) { settings.budgetBytes = budgetBytes; }
+	const Settings& getSettings() const { return settings; }
+	Statistics getStatistics() const;
+	TextureState getTextureState(Handle handle) const;
+	uint32_t getTextureCount() const { return static_cast<uint32_t>(textures.size()); }
+
+private:
+	/// One GPU image holding levels [level, mipLevels) of a texture
+	struct Residency
+	{
+		GpuAllocator::Image image{ nullptr };
+		vk::raii::ImageView view{ nullptr };
+		uint32_t level = 0;
+		vk::DeviceSize bytes = 0;
+		UploadService::Ticket ticket = 0; // upload of a pending residency
+	};
+
+	struct StreamedTexture
+	{
+		Source source;
+		MipGenerator::Method mipMethod = MipGenerator::Method::None;
+		Residency resident;
+		std::optional<Residency> pending;
+		std::vector<uint64_t> lastNeededFrame; // per level
+		uint32_t frameRequest = UINT32_MAX; // finest level requested while recording this frame
+		uint32_t lastRequest = 0;
+		uint64_t viewGeneration = 0;
+	};
+
+	struct RetiredResidency
+	{
+		uint64_t releaseFrame = 0;
+		Residency residency;
+	};
+
+	Residency createResidency(const StreamedTexture& texture, uint32_t level);
+	vk::ImageCreateInfo getImageInfo(const StreamedTexture& texture, uint32_t level) const;
+	vk::DeviceSize getResidencyBytes(const StreamedTexture& texture, uint32_t level) const;
+	vk::DeviceSize getCommittedBytes() const;
+	/// Shrinks the least recently needed texture other than except by one level; false when nothing can go
+	bool evictLeastRecentlyNeeded(std::optional<Handle> except);
+
+	vk::raii::Device* device = nullptr;
+	vk::raii::PhysicalDevice* physicalDevice = nullptr;
+	GpuAllocator* allocator = nullptr;
+	UploadService* uploadService = nullptr;
+	uint32_t framesInFlight = 1;
+	Settings settings;
+
+	std::vector<StreamedTexture> textures;
+	std::deque<RetiredResidency> retired;
+	uint64_t frameNumber = 0;
+	Statistics statistics;
+};
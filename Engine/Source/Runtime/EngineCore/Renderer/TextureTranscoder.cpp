@@ -0,0 +1,122 @@
+#include "TextureTranscoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+	// Preference order for Basis transcoding; the device filter in querySupportedTargets drops the rest
+	constexpr TextureTranscoder::Target TRANSCODE_CANDIDATES[] = {
+		{ KTX_TTF_BC7_RGBA, vk::Format::eBc7UnormBlock, vk::Format::eBc7SrgbBlock, true },
+		{ KTX_TTF_ASTC_4x4_RGBA, vk::Format::eAstc4x4UnormBlock, vk::Format::eAstc4x4SrgbBlock, true },
+		{ KTX_TTF_ETC1_RGB, vk::Format::eEtc2R8G8B8UnormBlock, vk::Format::eEtc2R8G8B8SrgbBlock, false },
+		{ KTX_TTF_ETC2_RGBA, vk::Format::eEtc2R8G8B8A8UnormBlock, vk::Format::eEtc2R8G8B8A8SrgbBlock, true },
+		{ KTX_TTF_BC1_RGB, vk::Format::eBc1RgbUnormBlock, vk::Format::eBc1RgbSrgbBlock, false },
+		{ KTX_TTF_BC3_RGBA, vk::Format::eBc3UnormBlock, vk::Format::eBc3SrgbBlock, true },
+	};
+
+	constexpr TextureTranscoder::Target UNCOMPRESSED_TARGET = { KTX_TTF_RGBA32, vk::Format::eR8G8B8A8Unorm, vk::Format::eR8G8B8A8Srgb, true };
+}
+
+namespace TextureTranscoder
+{
+	std::span<const std::byte> Texture::getData() const
+	{
+		ktxTexture* texture = ktxTexture(ktx.get());
+		return { reinterpret_cast<const std::byte*>(ktxTexture_GetData(texture)), ktxTexture_GetDataSize(texture) };
+	}
+
+	std::vector<Target> querySupportedTargets(const vk::raii::PhysicalDevice& physicalDevice)
+	{
+		auto isSampleable = [&physicalDevice](vk::Format format)
+		{
+			vk::FormatFeatureFlags required = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eTransferDst;
+			return (physicalDevice.getFormatProperties(format).optimalTilingFeatures & required) == required;
+		};
+
+		std::vector<Target> targets;
+		for (const Target& candidate : TRANSCODE_CANDIDATES)
+		{
+			if (isSampleable(candidate.unormFormat) && isSampleable(candidate.srgbFormat))
+			{
+				targets.push_back(candidate);
+			}
+		}
+		targets.push_back(UNCOMPRESSED_TARGET);
+		return targets;
+	}
+
+	Texture load(const std::string& path, std::span<const Target> targets)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		ktxTexture2* rawTexture = nullptr;
+		KTX_error_code result = ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &rawTexture);
+		if (result != KTX_SUCCESS)
+		{
+			throw std::runtime_error("failed to load ktx texture image " + path + ": " + ktxErrorString(result));
+		}
+
+		Texture texture;
+		texture.ktx.reset(rawTexture);
+
+		if (rawTexture->numDimensions != 2 || rawTexture->numLayers != 1 || rawTexture->numFaces != 1)
+		{
+			throw std::runtime_error("unsupported ktx texture layout (only single 2D images): " + path);
+		}
+
+		const bool srgb = ktxTexture2_GetOETF(rawTexture) == KHR_DF_TRANSFER_SRGB;
+		if (ktxTexture2_NeedsTranscoding(rawTexture))
+		{
+			const bool hasAlpha = ktxTexture2_GetNumComponents(rawTexture) == 4;
+			auto target = std::ranges::find_if(targets, [hasAlpha](const Target& candidate) { return candidate.hasAlpha || !hasAlpha; });
+			if (target == targets.end())
+			{
+				throw std::runtime_error("no transcode target for ktx texture " + path);
+			}
+
+			result = ktxTexture2_TranscodeBasis(rawTexture, target->transcodeFormat, 0);
+			if (result != KTX_SUCCESS)
+			{
+				throw std::runtime_error("failed to transcode ktx texture " + path + ": " + ktxErrorString(result));
+			}
+			texture.format = srgb ? target->srgbFormat : target->unormFormat;
+		}
+		else
+		{
+			// Already a GPU format; accept it only if the device was found to sample it
+			texture.format = static_cast<vk::Format>(rawTexture->vkFormat);
+			bool supported = std::ranges::any_of(targets, [&texture](const Target& candidate)
+			{
+				return candidate.unormFormat == texture.format || candidate.srgbFormat == texture.format;
+			});
+			if (!supported)
+			{
+				throw std::runtime_error("unsupported ktx texture format " + vk::to_string(texture.format) + ": " + path);
+			}
+		}
+
+		texture.width = rawTexture->baseWidth;
+		texture.height = rawTexture->baseHeight;
+		texture.mipLevels = rawTexture->numLevels;
+		texture.regions.reserve(texture.mipLevels);
+		for (uint32_t level = 0; level < texture.mipLevels; level++)
+		{
+			ktx_size_t offset = 0;
+			ktxTexture_GetImageOffset(ktxTexture(rawTexture), level, 0, 0, &offset);
+
+			vk::BufferImageCopy region;
+			region.bufferOffset = offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource = { vk::ImageAspectFlagBits::eColor, level, 0, 1 };
+			region.imageOffset = vk::Offset3D{ 0, 0, 0 };
+			region.imageExtent = vk::Extent3D{ std::max(1u, texture.width >> level), std::max(1u, texture.height >> level), 1 };
+			texture.regions.push_back(region);
+		}
+
+		texture.transcodeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return texture;
+	}
+}
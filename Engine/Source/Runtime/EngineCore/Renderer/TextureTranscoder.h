@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan_raii.hpp>
+#include <ktx.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// KTX2 texture loading. Basis Universal payloads (ETC1S and UASTC) are transcoded to the best block
+// compressed format the device samples; textures that are already GPU formats are used as stored.
+// load() only touches its own texture and may run on any worker thread.
+namespace TextureTranscoder
+{
+	struct Target
+	{
+		ktx_transcode_fmt_e transcodeFormat;
+		vk::Format unormFormat;
+		vk::Format srgbFormat;
+		bool hasAlpha;
+	};
+
+	struct KtxTextureDeleter
+	{
+		void operator()(ktxTexture2* texture) const { ktxTexture2_Destroy(texture); }
+	};
+
+	struct Texture
+	{
+		std::unique_ptr<ktxTexture2, KtxTextureDeleter> ktx;
+		vk::Format format = vk::Format::eUndefined;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		// One copy per mip level, buffer offsets relative to getData()
+		std::vector<vk::BufferImageCopy> regions;
+		double transcodeMilliseconds = 0.0;
+
+		std::span<const std::byte> getData() const;
+	};
+
+	/// Transcode targets the device can sample from optimal tiling, best first. RGB-only targets precede
+	/// their alpha counterparts so opaque textures take the smaller block. Always ends with RGBA8.
+	std::vector<Target> querySupportedTargets(const vk::raii::PhysicalDevice& physicalDevice);
+
+	/// Loads every mip level of a 2D KTX2 texture and transcodes it to the first suitable target.
+	/// Throws when the file cannot be read or stores a format none of the targets covers.
+	Texture load(const std::string& path, std::span<const Target> targets);
+}
@@ -0,0 +1,162 @@
+#include "TransientAttachmentPool.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+	// Usages that lazily allocated memory can back; anything read outside the render pass needs real memory
+	constexpr vk::ImageUsageFlags TRANSIENT_USAGES = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment |
+		vk::ImageUsageFlagBits::eInputAttachment;
+}
+
+void TransientAttachmentPool::init(vk::raii::Device& inDevice, GpuAllocator& inAllocator)
+{
+	device = &inDevice;
+	allocator = &inAllocator;
+}
+
+void TransientAttachmentPool::destroy()
+{
+	reset();
+	device = nullptr;
+	allocator = nullptr;
+}
+
+TransientAttachmentPool::Handle TransientAttachmentPool::add(const Description& description)
+{
+	Attachment attachment;
+	attachment.description = description;
+	attachments.push_back(std::move(attachment));
+	return static_cast<Handle>(attachments.size() - 1);
+}
+
+bool TransientAttachmentPool::overlaps(const Block& block, const Description& description) const
+{
+	return std::ranges::any_of(block.attachments, [&](uint32_t index)
+	{
+		const Description& other = attachments[index].description;
+		return description.firstPass <= other.lastPass && other.firstPass <= description.lastPass;
+	});
+}
+
+void TransientAttachmentPool::build()
+{
+	blocks.clear();
+	statistics = {};
+	statistics.attachmentCount = static_cast<uint32_t>(attachments.size());
+
+	for (Attachment& attachment : attachments)
+	{
+		const Description& description = attachment.description;
+		vk::ImageCreateInfo imageInfo;
+		imageInfo.imageType = vk::ImageType::e2D;
+		imageInfo.format = description.format;
+		imageInfo.extent = vk::Extent3D{ description.width, description.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = vk::SampleCountFlagBits::e1;
+		imageInfo.tiling = vk::ImageTiling::eOptimal;
+		imageInfo.usage = description.usage;
+		imageInfo.sharingMode = vk::SharingMode::eExclusive;
+		imageInfo.initialLayout = vk::ImageLayout::eUndefined;
+
+		attachment.lazilyAllocated = allocator->getLazilyAllocatedMemoryTypeBits() != 0 && !(description.usage & ~TRANSIENT_USAGES);
+		if (attachment.lazilyAllocated)
+		{
+			imageInfo.usage |= vk::ImageUsageFlagBits::eTransientAttachment;
+		}
+		attachment.image = vk::raii::Image(*device, imageInfo);
+		attachment.requirements = attachment.image.getMemoryRequirements();
+
+		// The driver may still refuse lazily allocated types for this format
+		if (attachment.lazilyAllocated && !(attachment.requirements.memoryTypeBits & allocator->getLazilyAllocatedMemoryTypeBits()))
+		{
+			attachment.lazilyAllocated = false;
+			imageInfo.usage = description.usage;
+			attachment.image = vk::raii::Image(*device, imageInfo);
+			attachment.requirements = attachment.image.getMemoryRequirements();
+		}
+		statistics.requestedBytes += attachment.requirements.size;
+	}
+
+	// Largest first, each into the first block it fits next to without sharing a pass
+	std::vector<uint32_t> order(attachments.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::stable_sort(order, [&](uint32_t a, uint32_t b) { return attachments[a].requirements.size > attachments[b].requirements.size; });
+
+	for (uint32_t index : order)
+	{
+		Attachment& attachment = attachments[index];
+		Block* target = nullptr;
+		if (!attachment.lazilyAllocated)
+		{
+			for (Block& block : blocks)
+			{
+				if (!block.lazilyAllocated && (block.requirements.memoryTypeBits & attachment.requirements.memoryTypeBits) &&
+					!overlaps(block, attachment.description))
+				{
+					target = &block;
+					break;
+				}
+			}
+		}
+
+		if (!target)
+		{
+			target = &blocks.emplace_back();
+			target->requirements = attachment.requirements;
+			target->lazilyAllocated = attachment.lazilyAllocated;
+		}
+		else
+		{
+			target->requirements.size = std::max(target->requirements.size, attachment.requirements.size);
+			target->requirements.alignment = std::max(target->requirements.alignment, attachment.requirements.alignment);
+			target->requirements.memoryTypeBits &= attachment.requirements.memoryTypeBits;
+		}
+		target->attachments.push_back(index);
+	}
+
+	for (Block& block : blocks)
+	{
+		block.memory = allocator->allocateMemory(block.requirements, block.lazilyAllocated, GpuAllocator::Category::RenderTarget);
+		statistics.allocatedBytes += block.memory.getSize();
+		statistics.memoryBlockCount++;
+
+		for (uint32_t index : block.attachments)
+		{
+			Attachment& attachment = attachments[index];
+			allocator->bindImageMemory(block.memory, 0, *attachment.image);
+
+			vk::ImageViewCreateInfo viewInfo;
+			viewInfo.image = *attachment.image;
+			viewInfo.viewType = vk::ImageViewType::e2D;
+			viewInfo.format = attachment.description.format;
+			viewInfo.subresourceRange = { attachment.description.aspect, 0, 1, 0, 1 };
+			attachment.view = vk::raii::ImageView(*device, viewInfo);
+
+			if (attachment.lazilyAllocated)
+			{
+				statistics.lazilyAllocatedCount++;
+			}
+		}
+	}
+}
+
+void TransientAttachmentPool::reset()
+{
+	// Views and images go before the memory they are bound to
+	attachments.clear();
+	blocks.clear();
+	statistics = {};
+}
+
+void TransientAttachmentPool::retire(DeletionQueue& deletionQueue, uint64_t frame)
+{
+	// Views and images go before the memory they are bound to
+	deletionQueue.push(frame, std::move(attachments));
+	deletionQueue.push(frame, std::move(blocks));
+	attachments.clear();
+	blocks.clear();
+	statistics = {};
+}
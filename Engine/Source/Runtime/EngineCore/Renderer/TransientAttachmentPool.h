@@ -0,0 +1,94 @@
+#pragma once
+
+#include "DeletionQueue.h"
+#include "GpuAllocator.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Render targets that only live within a frame (depth, G-buffer, intermediate targets) are declared here with the
+/// range of frame passes that use them and get memory in build(). Attachments whose pass ranges do not overlap share
+/// one allocation (aliasing). Where the device has lazily allocated memory, attachment-only targets are created with
+/// eTransientAttachment instead and never get backing memory outside tile memory.
+/// An aliased attachment has undefined contents at its first pass: its first barrier must come from eUndefined and
+/// wait on the attachment stages of the passes before it, which may have written the same memory.
+class TransientAttachmentPool
+{
+public:
+	using Handle = uint32_t;
+
+	struct Description
+	{
+		std::string name;
+		vk::Format format = vk::Format::eUndefined;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		vk::ImageUsageFlags usage;
+		vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+		// Inclusive range of frame passes that read or write the attachment
+		uint32_t firstPass = 0;
+		uint32_t lastPass = 0;
+	};
+
+	struct Statistics
+	{
+		uint32_t attachmentCount = 0;
+		uint32_t lazilyAllocatedCount = 0;
+		uint32_t memoryBlockCount = 0; // aliased allocations, lazily allocated ones included
+		vk::DeviceSize requestedBytes = 0; // what every attachment would take with its own memory
+		vk::DeviceSize allocatedBytes = 0; // memory actually allocated for them
+	};
+
+	TransientAttachmentPool() = default;
+	~TransientAttachmentPool() = default;
+
+	TransientAttachmentPool(const TransientAttachmentPool&) = delete;
+	TransientAttachmentPool& operator=(const TransientAttachmentPool&) = delete;
+
+	void init(vk::raii::Device& device, GpuAllocator& allocator);
+	void destroy();
+
+	/// Declares an attachment for the next build(); handles stay valid until reset()
+	Handle add(const Description& description);
+	/// Creates every declared attachment and assigns memory to them
+	void build();
+	/// Frees every attachment and its memory; the GPU must be done with them
+	void reset();
+	/// Like reset(), but the attachments and their memory go to deletionQueue until frame completed
+	void retire(DeletionQueue& deletionQueue, uint64_t frame);
+
+	vk::Image getImage(Handle handle) const { return *attachments[handle].image; }
+	vk::ImageView getImageView(Handle handle) const { return *attachments[handle].view; }
+	Statistics getStatistics() const { return statistics; }
+
+private:
+	struct Attachment
+	{
+		Description description;
+		vk::raii::Image image{ nullptr };
+		vk::raii::ImageView view{ nullptr };
+		vk::MemoryRequirements requirements;
+		bool lazilyAllocated = false;
+	};
+
+	/// One allocation and the attachments bound to all of it, whose pass ranges are disjoint
+	struct Block
+	{
+		GpuAllocator::Memory memory{ nullptr };
+		vk::MemoryRequirements requirements;
+		std::vector<uint32_t> attachments;
+		bool lazilyAllocated = false;
+	};
+
+	bool overlaps(const Block& block, const Description& description) const;
+
+	vk::raii::Device* device = nullptr;
+	GpuAllocator* allocator = nullptr;
+
+	std::vector<Attachment> attachments;
+	std::vector<Block> blocks;
+	Statistics statistics;
+};
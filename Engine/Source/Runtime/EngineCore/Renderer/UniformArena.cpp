@@ -0,0 +1,98 @@
+#include "UniformArena.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+void UniformArena::init(GpuAllocator& allocator, const vk::PhysicalDeviceLimits& limits, uint32_t framesInFlight, vk::DeviceSize bytesPerFrame,
+	std::span<const uint32_t> sharingFamilies)
+{
+	alignment = std::max<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+	// Every slice starts aligned, so slice sizes are kept multiples of the alignment
+	frameCapacity = (bytesPerFrame + alignment - 1) / alignment * alignment;
+
+	vk::DeviceSize size = frameCapacity * framesInFlight;
+	if (size > UINT32_MAX)
+	{
+		throw std::runtime_error("uniform arena is too large for 32-bit dynamic offsets!");
+	}
+
+	vk::BufferCreateInfo bufferInfo;
+	bufferInfo.size = size;
+	bufferInfo.usage = vk::BufferUsageFlagBits::eUniformBuffer;
+	// Read from every queue family in sharingFamilies without ownership transfers
+	bufferInfo.sharingMode = sharingFamilies.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+	bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharingFamilies.size() > 1 ? sharingFamilies.size() : 0);
+	bufferInfo.pQueueFamilyIndices = sharingFamilies.data();
+	// Read by every draw, so it goes to VRAM when the CPU can write there
+	buffer = allocator.createBuffer(bufferInfo, allocator.getHostWriteProperties(size, GpuAllocator::WritePattern::PerFrame),
+		GpuAllocator::Category::Uniforms);
+	mapped = static_cast<std::byte*>(buffer.getMappedData());
+
+	frameBase = 0;
+	frameOffset = 0;
+	frameAllocations = 0;
+	overflowedAllocations = 0;
+	overflowsAtFrameStart = 0;
+	statistics = {};
+	statistics.frameCapacity = frameCapacity;
+	statistics.alignment = alignment;
+}
+
+void UniformArena::destroy()
+{
+	mapped = nullptr;
+	buffer = nullptr;
+}
+
+void UniformArena::beginFrame(uint32_t frameIndex)
+{
+	vk::DeviceSize usedBytes = frameOffset.exchange(0);
+	statistics.lastFrameBytes = std::min(usedBytes, frameCapacity);
+	statistics.lastFrameAllocations = frameAllocations.exchange(0);
+	statistics.peakFrameBytes = std::max(statistics.peakFrameBytes, usedBytes);
+
+	uint64_t overflows = overflowedAllocations;
+	if (overflows != overflowsAtFrameStart)
+	{
+		if (statistics.overflowedFrames == 0)
+		{
+			std::cout << "Uniform arena overflow: a frame needed " << usedBytes / 1024 << " KB of " << frameCapacity / 1024
+				<< " KB, " << overflows - overflowsAtFrameStart << " allocations dropped" << std::endl;
+		}
+		statistics.overflowedFrames++;
+		overflowsAtFrameStart = overflows;
+	}
+
+	frameBase = frameCapacity * frameIndex;
+}
+
+std::optional<UniformArena::Allocation> UniformArena::allocate(vk::DeviceSize size)
+{
+	vk::DeviceSize alignedSize = (size + alignment - 1) / alignment * alignment;
+	vk::DeviceSize offset = frameOffset.fetch_add(alignedSize);
+	if (offset + alignedSize > frameCapacity)
+	{
+		overflowedAllocations++;
+		return std::nullopt;
+	}
+
+	frameAllocations++;
+	return Allocation{ static_cast<uint32_t>(frameBase + offset), mapped + frameBase + offset };
+}
+
+vk::DescriptorBufferInfo UniformArena::getDescriptorInfo(vk::DeviceSize range) const
+{
+	vk::DescriptorBufferInfo bufferInfo;
+	bufferInfo.buffer = *buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = range;
+	return bufferInfo;
+}
+
+UniformArena::Statistics UniformArena::getStatistics() const
+{
+	Statistics result = statistics;
+	result.overflowedAllocations = overflowedAllocations;
+	return result;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "GpuAllocator.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+/// Per-frame linear allocator for uniform data, read through eUniformBufferDynamic descriptors.
+/// One persistently mapped buffer is split into a slice per frame in flight; every view, pass and object
+/// bump-allocates its block from the current frame's slice and binds it with the returned dynamic offset,
+/// so any number of objects share one descriptor set. Offsets are aligned to minUniformBufferOffsetAlignment.
+/// A slice is reused once its frame completed. Allocation is lock-free.
+class UniformArena
+{
+public:
+	struct Allocation
+	{
+		uint32_t offset = 0; // dynamic offset from the start of the buffer
+		void* data = nullptr;
+	};
+
+	struct Statistics
+	{
+		vk::DeviceSize frameCapacity = 0;
+		vk::DeviceSize alignment = 0;
+		vk::DeviceSize lastFrameBytes = 0; // used by the last completed frame, including alignment padding
+		uint32_t lastFrameAllocations = 0;
+		vk::DeviceSize peakFrameBytes = 0; // includes requests that overflowed
+		uint64_t overflowedAllocations = 0;
+		uint32_t overflowedFrames = 0;
+	};
+
+	UniformArena() = default;
+	~UniformArena() = default;
+
+	UniformArena(const UniformArena&) = delete;
+	UniformArena& operator=(const UniformArena&) = delete;
+
+	void init(GpuAllocator& allocator, const vk::PhysicalDeviceLimits& limits, uint32_t framesInFlight, vk::DeviceSize bytesPerFrame,
+		std::span<const uint32_t> sharingFamilies = {});
+	void destroy();
+
+	/// Render thread, once the frame that last used the slot completed and before anything allocates for it
+	void beginFrame(uint32_t frameIndex);
+
+	/// Space for size bytes in the current frame, or nullopt when the frame's slice is full (counted as an overflow)
+	std::optional<Allocation> allocate(vk::DeviceSize size);
+
+	template <typename T>
+	std::optional<Allocation> push(const T& value)
+	{
+		std::optional<Allocation> allocation = allocate(sizeof(T));
+		if (allocation)
+		{
+			memcpy(allocation->data, &value, sizeof(T));
+		}
+		return allocation;
+	}
+
+	vk::Buffer getBuffer() const { return *buffer; }
+	/// Buffer info of a dynamic uniform binding that reads range bytes at each dynamic offset
+	vk::DescriptorBufferInfo getDescriptorInfo(vk::DeviceSize range) const;
+	Statistics getStatistics() const;
+
+private:
+	GpuAllocator::Buffer buffer{ nullptr };
+	std::byte* mapped = nullptr;
+	vk::DeviceSize alignment = 1;
+	vk::DeviceSize frameCapacity = 0;
+	vk::DeviceSize frameBase = 0;
+
+	std::atomic<vk::DeviceSize> frameOffset = 0;
+	std::atomic<uint32_t> frameAllocations = 0;
+	std::atomic<uint64_t> overflowedAllocations = 0;
+	uint64_t overflowsAtFrameStart = 0;
+	Statistics statistics;
+};
@@ -0,0 +1,482 @@
+#include "UploadService.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	// Chunks stay well below the ring size so the next chunk can be staged while earlier ones are copied
+	constexpr vk::DeviceSize STAGING_CHUNKS_PER_RING = 4;
+	constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+}
+
+uint32_t UploadService::findTransferQueueFamily(const std::vector<vk::QueueFamilyProperties>& families, uint32_t graphicsFamily)
+{
+	auto supportsWholeImageCopies = [](const vk::QueueFamilyProperties& family)
+	{
+		const vk::Extent3D& granularity = family.minImageTransferGranularity;
+		return granularity.width == 1 && granularity.height == 1 && granularity.depth == 1;
+	};
+
+	// Transfer-only families map to the copy engines and run next to graphics and compute work
+	for (uint32_t index = 0; index < families.size(); index++)
+	{
+		vk::QueueFlags flags = families[index].queueFlags;
+		if ((flags & vk::QueueFlagBits::eTransfer) && !(flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)) &&
+			supportsWholeImageCopies(families[index]))
+		{
+			return index;
+		}
+	}
+
+	// Async compute families can still copy without competing with the graphics queue
+	for (uint32_t index = 0; index < families.size(); index++)
+	{
+		vk::QueueFlags flags = families[index].queueFlags;
+		if (index != graphicsFamily && (flags & (vk::QueueFlagBits::eTransfer | vk::QueueFlagBits::eCompute)) && !(flags & vk::QueueFlagBits::eGraphics) &&
+			supportsWholeImageCopies(families[index]))
+		{
+			return index;
+		}
+	}
+
+	return graphicsFamily;
+}
+
+void UploadService::init(vk::raii::Device& inDevice, vk::raii::PhysicalDevice& inPhysicalDevice, GpuAllocator& inAllocator, uint32_t inTransferFamily, uint32_t inGraphicsFamily,
+	uint32_t inFramesInFlight, const std::vector<char>& mipShaderCode, vk::DeviceSize stagingRingSize)
+{
+	device = &inDevice;
+	physicalDevice = &inPhysicalDevice;
+	allocator = &inAllocator;
+	transferFamily = inTransferFamily;
+	graphicsFamily = inGraphicsFamily;
+	framesInFlight = inFramesInFlight;
+
+	mipGenerator.init(*device, *physicalDevice, mipShaderCode);
+
+	transferQueue = vk::raii::Queue(*device, transferFamily, 0);
+
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+	poolInfo.queueFamilyIndex = transferFamily;
+	commandPool = vk::raii::CommandPool(*device, poolInfo);
+
+	vk::SemaphoreTypeCreateInfo timelineInfo;
+	timelineInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	timelineInfo.initialValue = 0;
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.pNext = &timelineInfo;
+	timeline = vk::raii::Semaphore(*device, semaphoreInfo);
+
+	stagingRing.init(*device, *allocator, *timeline, stagingRingSize);
+}
+
+void UploadService::destroy()
+{
+	std::lock_guard lock(mutex);
+
+	// Staging memory may still be read by the transfer queue
+	if (lastSubmittedValue > 0)
+	{
+		vk::SemaphoreWaitInfo waitInfo;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &*timeline;
+		waitInfo.pValues = &lastSubmittedValue;
+		(void)device->waitSemaphores(waitInfo, UINT64_MAX);
+	}
+
+	recording.reset();
+	inFlight.clear();
+	retiredMipResources.clear();
+	stagingRing.destroy();
+	mipGenerator.destroy();
+	timeline = nullptr;
+	commandPool = nullptr;
+	transferQueue = nullptr;
+}
+
+UploadService::Batch& UploadService::openBatch()
+{
+	if (!recording)
+	{
+		vk::CommandBufferAllocateInfo allocInfo;
+		allocInfo.commandPool = *commandPool;
+		allocInfo.level = vk::CommandBufferLevel::ePrimary;
+		allocInfo.commandBufferCount = 1;
+
+		recording.emplace();
+		recording->commandBuffer = std::move(device->allocateCommandBuffers(allocInfo).front());
+
+		vk::CommandBufferBeginInfo beginInfo;
+		beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		recording->commandBuffer.begin(beginInfo);
+	}
+	return *recording;
+}
+
+StagingRing::Allocation UploadService::allocateStaging(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	std::optional<StagingRing::Allocation> allocation = stagingRing.allocate(size, alignment, true);
+	if (!allocation)
+	{
+		// The open batch holds the rest of the ring; its space only comes back once it was submitted
+		submitLocked();
+		statistics.stagingFlushes++;
+		allocation = stagingRing.allocate(size, alignment, true);
+	}
+	return *allocation;
+}
+
+vk::DeviceSize UploadService::getChunkSize() const
+{
+	return std::max<vk::DeviceSize>(stagingRing.getCapacity() / STAGING_CHUNKS_PER_RING, STAGING_ALIGNMENT);
+}
+
+UploadService::Ticket UploadService::uploadBuffer(std::span<const std::byte> data, vk::Buffer dstBuffer, vk::DeviceSize dstOffset,
+	vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	if (data.empty())
+	{
+		return 0;
+	}
+
+	std::lock_guard lock(mutex);
+
+	vk::DeviceSize chunkSize = getChunkSize();
+	for (vk::DeviceSize copied = 0; copied < data.size(); copied += chunkSize)
+	{
+		vk::DeviceSize size = std::min(chunkSize, data.size() - copied);
+		StagingRing::Allocation staging = allocateStaging(size, STAGING_ALIGNMENT);
+		memcpy(staging.data, data.data() + copied, size);
+
+		// Allocating may have submitted the batch, so it is looked up again for every chunk
+		vk::BufferCopy region;
+		region.srcOffset = staging.offset;
+		region.dstOffset = dstOffset + copied;
+		region.size = size;
+		openBatch().commandBuffer.copyBuffer(staging.buffer, dstBuffer, region);
+	}
+	if (data.size() > chunkSize)
+	{
+		statistics.chunkedUploads++;
+	}
+
+	// Barriers cover copies of earlier batches too; those were submitted to the same queue before this one
+	Batch& batch = openBatch();
+
+	vk::BufferMemoryBarrier2 barrier;
+	barrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+	barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+	barrier.buffer = dstBuffer;
+	barrier.offset = dstOffset;
+	barrier.size = data.size();
+
+	if (usesDedicatedQueue())
+	{
+		// Release half; the matching acquire runs on the graphics queue once the batch finished
+		barrier.srcQueueFamilyIndex = transferFamily;
+		barrier.dstQueueFamilyIndex = graphicsFamily;
+
+		vk::BufferMemoryBarrier2 acquire = barrier;
+		acquire.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		acquire.srcAccessMask = {};
+		acquire.dstStageMask = dstStage;
+		acquire.dstAccessMask = dstAccess;
+		batch.bufferAcquires.push_back(acquire);
+	}
+	else
+	{
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+	}
+	batch.bufferReleases.push_back(barrier);
+
+	statistics.bytesUploaded += data.size();
+	return getOpenTicket();
+}
+
+UploadService::Ticket UploadService::uploadImage(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t width, uint32_t height,
+	vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	vk::BufferImageCopy region;
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+	region.imageOffset = vk::Offset3D{ 0, 0, 0 };
+	region.imageExtent = vk::Extent3D{ width, height, 1 };
+	return uploadImage(data, dstImage, format, 1, std::span(&region, 1), finalLayout, dstStage, dstAccess);
+}
+
+void UploadService::recordImageCopy(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t mipLevels, std::span<const vk::BufferImageCopy> regions)
+{
+	vk::ImageMemoryBarrier2 toTransfer;
+	toTransfer.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+	toTransfer.srcAccessMask = {};
+	toTransfer.dstStageMask = vk::PipelineStageFlagBits2::eTransfer;
+	toTransfer.dstAccessMask = vk::AccessFlagBits2::eTransferWrite;
+	toTransfer.oldLayout = vk::ImageLayout::eUndefined;
+	toTransfer.newLayout = vk::ImageLayout::eTransferDstOptimal;
+	toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toTransfer.image = dstImage;
+	toTransfer.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1 };
+
+	vk::DependencyInfo toTransferDependency;
+	toTransferDependency.imageMemoryBarrierCount = 1;
+	toTransferDependency.pImageMemoryBarriers = &toTransfer;
+	openBatch().commandBuffer.pipelineBarrier2(toTransferDependency);
+
+	// Buffer offsets of image copies have to be multiples of the texel block size
+	vk::DeviceSize blockSize = vk::blockSize(format);
+	vk::DeviceSize alignment = std::lcm(blockSize, STAGING_ALIGNMENT);
+	std::array<uint8_t, 3> blockExtent = vk::blockExtent(format);
+	vk::DeviceSize chunkSize = getChunkSize();
+	bool chunked = false;
+
+	for (const vk::BufferImageCopy& region : regions)
+	{
+		uint32_t blockRows = (region.imageExtent.height + blockExtent[1] - 1) / blockExtent[1];
+		vk::DeviceSize rowBytes = (region.imageExtent.width + blockExtent[0] - 1) / blockExtent[0] * blockSize;
+
+		// A region larger than a chunk is copied in bands of whole block rows
+		uint32_t rowsPerChunk = static_cast<uint32_t>(std::clamp<vk::DeviceSize>(chunkSize / rowBytes, 1, blockRows));
+		chunked |= rowsPerChunk < blockRows;
+		for (uint32_t row = 0; row < blockRows; row += rowsPerChunk)
+		{
+			uint32_t rows = std::min(rowsPerChunk, blockRows - row);
+			StagingRing::Allocation staging = allocateStaging(rows * rowBytes, alignment);
+			memcpy(staging.data, data.data() + region.bufferOffset + row * rowBytes, staging.size);
+
+			vk::BufferImageCopy band = region;
+			band.bufferOffset = staging.offset;
+			band.bufferRowLength = 0;
+			band.bufferImageHeight = 0;
+			band.imageOffset.y += static_cast<int32_t>(row * blockExtent[1]);
+			band.imageExtent.height = std::min(rows * blockExtent[1], region.imageExtent.height - row * blockExtent[1]);
+			openBatch().commandBuffer.copyBufferToImage(staging.buffer, dstImage, vk::ImageLayout::eTransferDstOptimal, band);
+		}
+	}
+	if (chunked)
+	{
+		statistics.chunkedUploads++;
+	}
+}
+
+UploadService::Ticket UploadService::uploadImage(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t mipLevels, std::span<const vk::BufferImageCopy> regions,
+	vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	std::lock_guard lock(mutex);
+
+	recordImageCopy(data, dstImage, format, mipLevels, regions);
+	Batch& batch = openBatch();
+
+	// The layout transition is part of the ownership transfer and has to be identical in both halves
+	vk::ImageMemoryBarrier2 barrier;
+	barrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+	barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+	barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+	barrier.newLayout = finalLayout;
+	barrier.image = dstImage;
+	barrier.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1 };
+
+	if (usesDedicatedQueue())
+	{
+		barrier.srcQueueFamilyIndex = transferFamily;
+		barrier.dstQueueFamilyIndex = graphicsFamily;
+
+		vk::ImageMemoryBarrier2 acquire = barrier;
+		acquire.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		acquire.srcAccessMask = {};
+		acquire.dstStageMask = dstStage;
+		acquire.dstAccessMask = dstAccess;
+		batch.imageAcquires.push_back(acquire);
+	}
+	else
+	{
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+	}
+	batch.imageReleases.push_back(barrier);
+
+	statistics.bytesUploaded += data.size();
+	return getOpenTicket();
+}
+
+UploadService::Ticket UploadService::uploadImageGenerateMips(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t width, uint32_t height,
+	uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess)
+{
+	std::lock_guard lock(mutex);
+
+	vk::BufferImageCopy region;
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+	region.imageOffset = vk::Offset3D{ 0, 0, 0 };
+	region.imageExtent = vk::Extent3D{ width, height, 1 };
+	recordImageCopy(data, dstImage, format, mipLevels, std::span(&region, 1));
+	Batch& batch = openBatch();
+
+	if (usesDedicatedQueue())
+	{
+		// Ownership moves without a layout change; the graphics queue builds the chain and transitions afterwards
+		vk::ImageMemoryBarrier2 release;
+		release.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+		release.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+		release.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		release.newLayout = vk::ImageLayout::eTransferDstOptimal;
+		release.srcQueueFamilyIndex = transferFamily;
+		release.dstQueueFamilyIndex = graphicsFamily;
+		release.image = dstImage;
+		release.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1 };
+		batch.imageReleases.push_back(release);
+
+		vk::ImageMemoryBarrier2 acquire = release;
+		acquire.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		acquire.srcAccessMask = {};
+		acquire.dstStageMask = vk::PipelineStageFlagBits2::eTransfer | vk::PipelineStageFlagBits2::eComputeShader;
+		acquire.dstAccessMask = vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite |
+			vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageWrite;
+		batch.imageAcquires.push_back(acquire);
+
+		batch.mipGenerations.push_back({ dstImage, format, width, height, mipLevels, finalLayout, dstStage, dstAccess });
+	}
+	else
+	{
+		// Same queue as the frames: the chain is built in the upload submission itself
+		batch.mipResources.push_back(mipGenerator.record(batch.commandBuffer, dstImage, format, width, height, mipLevels, finalLayout, dstStage, dstAccess));
+	}
+
+	statistics.bytesUploaded += data.size();
+	statistics.mipChainsGenerated++;
+	return getOpenTicket();
+}
+
+UploadService::Ticket UploadService::submit()
+{
+	std::lock_guard lock(mutex);
+	return submitLocked();
+}
+
+UploadService::Ticket UploadService::submitLocked()
+{
+	if (!recording)
+	{
+		return 0;
+	}
+
+	Batch batch = std::move(*recording);
+	recording.reset();
+
+	// Nothing in the batch reads the destinations after their copies, so one barrier at the end covers every upload
+	if (!batch.bufferReleases.empty() || !batch.imageReleases.empty())
+	{
+		vk::DependencyInfo dependencyInfo;
+		dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(batch.bufferReleases.size());
+		dependencyInfo.pBufferMemoryBarriers = batch.bufferReleases.data();
+		dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(batch.imageReleases.size());
+		dependencyInfo.pImageMemoryBarriers = batch.imageReleases.data();
+		batch.commandBuffer.pipelineBarrier2(dependencyInfo);
+		statistics.barriersRecorded += static_cast<uint32_t>(batch.bufferReleases.size() + batch.imageReleases.size());
+	}
+	batch.commandBuffer.end();
+	batch.timelineValue = ++lastSubmittedValue;
+	stagingRing.seal(batch.timelineValue);
+
+	vk::CommandBufferSubmitInfo commandBufferInfo;
+	commandBufferInfo.commandBuffer = *batch.commandBuffer;
+
+	vk::SemaphoreSubmitInfo signalInfo;
+	signalInfo.semaphore = *timeline;
+	signalInfo.value = batch.timelineValue;
+	signalInfo.stageMask = vk::PipelineStageFlagBits2::eAllCommands;
+
+	vk::SubmitInfo2 submitInfo;
+	submitInfo.commandBufferInfoCount = 1;
+	submitInfo.pCommandBufferInfos = &commandBufferInfo;
+	submitInfo.signalSemaphoreInfoCount = 1;
+	submitInfo.pSignalSemaphoreInfos = &signalInfo;
+	transferQueue.submit2(submitInfo, nullptr);
+
+	statistics.batchesSubmitted++;
+	inFlight.push_back(std::move(batch));
+	return inFlight.back().timelineValue;
+}
+
+uint64_t UploadService::recordAcquires(vk::raii::CommandBuffer& commandBuffer)
+{
+	std::lock_guard lock(mutex);
+
+	// A frame slot is only re-recorded after its previous submission finished
+	acquireFrame++;
+	while (!retiredMipResources.empty() && retiredMipResources.front().releaseFrame <= acquireFrame)
+	{
+		retiredMipResources.pop_front();
+	}
+
+	if (inFlight.empty())
+	{
+		return 0;
+	}
+
+	// Only batches that already finished are acquired, so the frame never waits on the copy engine
+	uint64_t completedValue = timeline.getCounterValue();
+	std::vector<vk::BufferMemoryBarrier2> bufferAcquires;
+	std::vector<vk::ImageMemoryBarrier2> imageAcquires;
+	std::vector<MipGeneration> mipGenerations;
+	uint64_t waitValue = 0;
+
+	while (!inFlight.empty() && inFlight.front().timelineValue <= completedValue)
+	{
+		Batch& batch = inFlight.front();
+		bufferAcquires.insert(bufferAcquires.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+		imageAcquires.insert(imageAcquires.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+		mipGenerations.insert(mipGenerations.end(), batch.mipGenerations.begin(), batch.mipGenerations.end());
+		waitValue = batch.timelineValue;
+		inFlight.pop_front();
+	}
+
+	if (!bufferAcquires.empty() || !imageAcquires.empty())
+	{
+		vk::DependencyInfo dependencyInfo;
+		dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferAcquires.size());
+		dependencyInfo.pBufferMemoryBarriers = bufferAcquires.data();
+		dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageAcquires.size());
+		dependencyInfo.pImageMemoryBarriers = imageAcquires.data();
+		commandBuffer.pipelineBarrier2(dependencyInfo);
+	}
+
+	for (const MipGeneration& generation : mipGenerations)
+	{
+		retiredMipResources.push_back({ acquireFrame + framesInFlight, mipGenerator.record(commandBuffer, generation.image, generation.format,
+			generation.width, generation.height, generation.mipLevels, generation.finalLayout, generation.dstStage, generation.dstAccess) });
+	}
+
+	if (waitValue > 0)
+	{
+		acquiredValue = waitValue;
+	}
+	return waitValue;
+}
+
+UploadService::Statistics UploadService::getStatistics()
+{
+	std::lock_guard lock(mutex);
+	Statistics result = statistics;
+	result.batchesInFlight = static_cast<uint32_t>(inFlight.size());
+
+	StagingRing::Statistics stagingStatistics = stagingRing.getStatistics();
+	result.stagingCapacity = stagingStatistics.capacity;
+	result.stagingBytesInUse = stagingStatistics.bytesInUse;
+	result.stagingPeakBytes = stagingStatistics.peakBytesInUse;
+	result.stagingWaits = stagingStatistics.gpuWaits;
+	return result;
+}
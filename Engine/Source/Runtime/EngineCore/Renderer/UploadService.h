@@ -0,0 +1,172 @@
+#pragma once
+
+#include "GpuAllocator.h"
+#include "MipGenerator.h"
+#include "StagingRing.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+/// Streams buffer and image data to the GPU without stalling the CPU or the graphics queue.
+/// Copies from every loader are recorded into one open batch that submit() hands to the transfer queue as a
+/// single command buffer; the batch signals a timeline semaphore instead of being waited on. The barriers that
+/// follow the copies are collected and recorded as one sync2 barrier when the batch is submitted. When uploads run on their own queue family, every
+/// resource is released by the transfer queue and acquired by the first graphics frame recorded after
+/// the batch finished (queue family ownership transfer), so a resource is only usable once isReady().
+/// Data is staged through one persistently mapped ring; uploads larger than a quarter of it are split into
+/// chunks, and when the ring fills up the open batch is submitted early so its space can be recycled.
+class UploadService
+{
+public:
+	/// Timeline value of a submitted batch; 0 is never signaled and always ready.
+	using Ticket = uint64_t;
+
+	static constexpr vk::DeviceSize DEFAULT_STAGING_RING_SIZE = 64ull * 1024 * 1024;
+
+	struct Statistics
+	{
+		uint64_t bytesUploaded = 0;
+		uint32_t batchesSubmitted = 0;
+		uint32_t batchesInFlight = 0;
+		uint32_t mipChainsGenerated = 0;
+		vk::DeviceSize stagingCapacity = 0;
+		vk::DeviceSize stagingBytesInUse = 0;
+		vk::DeviceSize stagingPeakBytes = 0;
+		uint32_t stagingWaits = 0; // uploads that waited for the GPU to free ring space
+		uint32_t stagingFlushes = 0; // batches submitted early because the open batch filled the ring
+		uint32_t chunkedUploads = 0; // uploads split because they exceeded the chunk size
+		uint32_t barriersRecorded = 0; // post-copy barriers, merged into one pipeline barrier per batch
+	};
+
+	UploadService() = default;
+	~UploadService() = default;
+
+	UploadService(const UploadService&) = delete;
+	UploadService& operator=(const UploadService&) = delete;
+
+	/// Queue family uploads should run on: a transfer-only family (the copy engine) when the device has one,
+	/// then any non-graphics family with transfer support, otherwise the graphics family itself.
+	/// Families with a coarse image transfer granularity are skipped so whole-image copies are always legal.
+	static uint32_t findTransferQueueFamily(const std::vector<vk::QueueFamilyProperties>& families, uint32_t graphicsFamily);
+
+	/// The device must have been created with a queue in transferFamily and timelineSemaphore enabled.
+	/// framesInFlight bounds how long mip generation resources recorded into frame command buffers are kept;
+	/// mipShaderCode is the SPIR-V of the compute downsample fallback and may be empty.
+	void init(vk::raii::Device& device, vk::raii::PhysicalDevice& physicalDevice, GpuAllocator& allocator, uint32_t transferFamily, uint32_t graphicsFamily,
+		uint32_t framesInFlight, const std::vector<char>& mipShaderCode, vk::DeviceSize stagingRingSize = DEFAULT_STAGING_RING_SIZE);
+	void destroy();
+
+	/// Copies data into staging memory right away and records the transfer into the open batch.
+	/// dstStage/dstAccess describe the first graphics use of the destination. An upload that does not fit
+	/// the ring's free space submits the open batch like submit(), with the same threading rule.
+	/// Every upload returns the ticket of the batch that completes it, which is ready once that batch was submitted and acquired.
+	Ticket uploadBuffer(std::span<const std::byte> data, vk::Buffer dstBuffer, vk::DeviceSize dstOffset,
+		vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+	/// Uploads mip 0 of a single-layer color image created in eUndefined layout and leaves it in finalLayout.
+	Ticket uploadImage(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t width, uint32_t height,
+		vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+	/// Uploads several regions of a single-layer color image (typically one per mip level) whose bufferOffsets
+	/// index into data. Regions must be tightly packed (bufferRowLength 0). Mip levels [0, mipLevels) are transitioned together.
+	Ticket uploadImage(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t mipLevels, std::span<const vk::BufferImageCopy> regions,
+		vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+	/// Uploads mip 0 and fills levels [1, mipLevels) on the GPU with the method getMipGenerator() reports for format.
+	/// The chain is recorded into the upload batch when it runs on the graphics family; with a dedicated transfer
+	/// queue the copy engine cannot blit, so it is recorded by recordAcquires right after the ownership transfer.
+	Ticket uploadImageGenerateMips(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t width, uint32_t height,
+		uint32_t mipLevels, vk::ImageLayout finalLayout, vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess);
+
+	/// Submits the open batch to the transfer queue. Returns its ticket, or 0 when nothing was recorded.
+	/// Without a dedicated family the batch goes to the graphics queue, so it must then be called from the render thread.
+	Ticket submit();
+
+	/// Render thread, once per frame while recording the frame's command buffer and before any uploaded
+	/// resource is used: records the acquire barriers of every batch that finished on the GPU and frees
+	/// their staging memory, then generates the mip chains deferred to the graphics queue. Returns the timeline value the frame's submission must wait on (0 for none).
+	uint64_t recordAcquires(vk::raii::CommandBuffer& commandBuffer);
+
+	/// True once the batch has finished and its resources were handed to the graphics queue.
+	bool isReady(Ticket ticket) const { return ticket <= acquiredValue; }
+
+	bool usesDedicatedQueue() const { return transferFamily != graphicsFamily; }
+	uint32_t getTransferQueueFamily() const { return transferFamily; }
+	vk::Semaphore getTimelineSemaphore() const { return *timeline; }
+	const MipGenerator& getMipGenerator() const { return mipGenerator; }
+	Statistics getStatistics();
+
+private:
+	/// Mip chain left for the graphics queue; the image stays in eTransferDstOptimal until then
+	struct MipGeneration
+	{
+		vk::Image image;
+		vk::Format format = vk::Format::eUndefined;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+		vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags2 dstStage;
+		vk::AccessFlags2 dstAccess;
+	};
+
+	struct Batch
+	{
+		vk::raii::CommandBuffer commandBuffer{ nullptr };
+		// Release or final-use barriers of the copies, recorded together when the batch is submitted
+		std::vector<vk::BufferMemoryBarrier2> bufferReleases;
+		std::vector<vk::ImageMemoryBarrier2> imageReleases;
+		std::vector<vk::BufferMemoryBarrier2> bufferAcquires;
+		std::vector<vk::ImageMemoryBarrier2> imageAcquires;
+		std::vector<MipGeneration> mipGenerations;
+		std::vector<MipGenerator::Resources> mipResources;
+		uint64_t timelineValue = 0;
+	};
+
+	/// Resources of a chain recorded into a frame command buffer, freed once that frame slot came around again
+	struct RetiredMipResources
+	{
+		uint64_t releaseFrame = 0;
+		MipGenerator::Resources resources;
+	};
+
+	Batch& openBatch();
+	/// Ticket of the batch currently being recorded
+	Ticket getOpenTicket() const { return lastSubmittedValue + 1; }
+	Ticket submitLocked();
+	/// Ring space for size bytes; submits the open batch when it holds everything left
+	StagingRing::Allocation allocateStaging(vk::DeviceSize size, vk::DeviceSize alignment);
+	vk::DeviceSize getChunkSize() const;
+	/// Transitions the image for transfer and records the copies of every region, splitting them into row bands when needed
+	void recordImageCopy(std::span<const std::byte> data, vk::Image dstImage, vk::Format format, uint32_t mipLevels, std::span<const vk::BufferImageCopy> regions);
+
+	vk::raii::Device* device = nullptr;
+	vk::raii::PhysicalDevice* physicalDevice = nullptr;
+	GpuAllocator* allocator = nullptr;
+	uint32_t transferFamily = 0;
+	uint32_t graphicsFamily = 0;
+
+	vk::raii::Queue transferQueue{ nullptr };
+	vk::raii::CommandPool commandPool{ nullptr };
+	vk::raii::Semaphore timeline{ nullptr };
+	MipGenerator mipGenerator;
+	uint32_t framesInFlight = 1;
+	StagingRing stagingRing;
+
+	// Guards everything below; uploads may be recorded from loader threads while the render thread acquires
+	std::mutex mutex;
+	std::optional<Batch> recording;
+	std::deque<Batch> inFlight;
+	uint64_t lastSubmittedValue = 0;
+	Statistics statistics;
+	std::deque<RetiredMipResources> retiredMipResources;
+	uint64_t acquireFrame = 0;
+
+	// Written by recordAcquires, read by isReady from any thread
+	std::atomic<uint64_t> acquiredValue = 0;
+};
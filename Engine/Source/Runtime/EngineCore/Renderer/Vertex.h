@@ -0,0 +1,319 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+/// Full-precision vertex produced by the importers. It is what the decode and optimization passes work
+/// on; the GPU only ever sees it after it was packed into the compile-time selected GpuVertex layout.
+struct Vertex
+{
+	glm::vec3 pos;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+
+	bool operator==(const Vertex& other) const {
+		return pos == other.pos && normal == other.normal && texCoord == other.texCoord;
+	}
+};
+
+template <>
+struct std::hash<Vertex>
+{
+	size_t operator()(Vertex const& vertex) const noexcept
+	{
+		return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+	}
+};
+
+/// Per-mesh dequantization constants, pushed to the vertex shader as-is:
+/// pos = positionOffset + positionScale * attribute, uv = texCoordOffsetScale.xy + texCoordOffsetScale.zw * attribute.
+/// Layouts that store full floats use the identity.
+struct VertexQuantization
+{
+	alignas(16) glm::vec4 positionOffset{ 0.0f };
+	alignas(16) glm::vec4 positionScale{ 1.0f };
+	alignas(16) glm::vec4 texCoordOffsetScale{ 0.0f, 0.0f, 1.0f, 1.0f };
+};
+
+// Vertex attributes a layout can be assembled from. Shader locations are fixed per semantic,
+// so every layout works with the same shaders: 0 position, 1 normal, 2 texture coordinate.
+namespace VertexAttributes
+{
+	namespace Detail
+	{
+		inline int16_t packSnorm16(float value)
+		{
+			return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		inline uint16_t packUnorm16(float value)
+		{
+			return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		/// Octahedral mapping of a unit vector onto [-1, 1]^2 (Cigolle et al., "A Survey of Efficient
+		/// Representations for Independent Unit Vectors").
+		inline glm::vec2 encodeOctahedral(glm::vec3 n)
+		{
+			float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+			if (length == 0.0f)
+			{
+				return { 0.0f, 0.0f };
+			}
+			n /= length;
+			if (n.z < 0.0f)
+			{
+				return { (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f) };
+			}
+			return { n.x, n.y };
+		}
+
+		template <typename T, size_t N>
+		void store(std::byte* dst, const std::array<T, N>& values)
+		{
+			memcpy(dst, values.data(), sizeof(T) * N);
+		}
+	}
+
+	enum class Semantic : uint32_t
+	{
+		Position = 0,
+		Normal = 1,
+		TexCoord = 2,
+	};
+
+	struct PositionFloat3
+	{
+		static constexpr Semantic semantic = Semantic::Position;
+		static constexpr vk::Format format = vk::Format::eR32G32B32Sfloat;
+		static constexpr uint32_t size = 12;
+		static constexpr bool quantized = false;
+
+		static void encode(const Vertex& vertex, const VertexQuantization&, std::byte* dst)
+		{
+			Detail::store(dst, std::array{ vertex.pos.x, vertex.pos.y, vertex.pos.z });
+		}
+	};
+
+	/// Position relative to the mesh AABB, mapped to [-1, 1]. The fourth component pads to 8 bytes,
+	/// three-component 16-bit formats are rarely supported for vertex fetch.
+	struct PositionSnorm16
+	{
+		static constexpr Semantic semantic = Semantic::Position;
+		static constexpr vk::Format format = vk::Format::eR16G16B16A16Snorm;
+		static constexpr uint32_t size = 8;
+		static constexpr bool quantized = true;
+
+		static void encode(const Vertex& vertex, const VertexQuantization& quantization, std::byte* dst)
+		{
+			glm::vec3 local = (vertex.pos - glm::vec3(quantization.positionOffset)) / glm::vec3(quantization.positionScale);
+			Detail::store(dst, std::array<int16_t, 4>{ Detail::packSnorm16(local.x), Detail::packSnorm16(local.y), Detail::packSnorm16(local.z), 0 });
+		}
+	};
+
+	/// Same mapping as PositionSnorm16 in half precision: finer near the AABB centre, coarser at the edges.
+	struct PositionHalf
+	{
+		static constexpr Semantic semantic = Semantic::Position;
+		static constexpr vk::Format format = vk::Format::eR16G16B16A16Sfloat;
+		static constexpr uint32_t size = 8;
+		static constexpr bool quantized = true;
+
+		static void encode(const Vertex& vertex, const VertexQuantization& quantization, std::byte* dst)
+		{
+			glm::vec3 local = (vertex.pos - glm::vec3(quantization.positionOffset)) / glm::vec3(quantization.positionScale);
+			Detail::store(dst, std::array<uint16_t, 4>{ glm::packHalf1x16(local.x), glm::packHalf1x16(local.y), glm::packHalf1x16(local.z), 0 });
+		}
+	};
+
+	struct NormalFloat3
+	{
+		static constexpr Semantic semantic = Semantic::Normal;
+		static constexpr vk::Format format = vk::Format::eR32G32B32Sfloat;
+		static constexpr uint32_t size = 12;
+		static constexpr bool quantized = false;
+
+		static void encode(const Vertex& vertex, const VertexQuantization&, std::byte* dst)
+		{
+			Detail::store(dst, std::array{ vertex.normal.x, vertex.normal.y, vertex.normal.z });
+		}
+	};
+
+	/// Octahedral-encoded unit normal; the shader decodes it when OCTAHEDRAL_NORMALS is set.
+	struct NormalOct16
+	{
+		static constexpr Semantic semantic = Semantic::Normal;
+		static constexpr vk::Format format = vk::Format::eR16G16Snorm;
+		static constexpr uint32_t size = 4;
+		static constexpr bool quantized = false;
+
+		static void encode(const Vertex& vertex, const VertexQuantization&, std::byte* dst)
+		{
+			glm::vec2 octahedral = Detail::encodeOctahedral(vertex.normal);
+			Detail::store(dst, std::array{ Detail::packSnorm16(octahedral.x), Detail::packSnorm16(octahedral.y) });
+		}
+	};
+
+	struct TexCoordFloat2
+	{
+		static constexpr Semantic semantic = Semantic::TexCoord;
+		static constexpr vk::Format format = vk::Format::eR32G32Sfloat;
+		static constexpr uint32_t size = 8;
+		static constexpr bool quantized = false;
+
+		static void encode(const Vertex& vertex, const VertexQuantization&, std::byte* dst)
+		{
+			Detail::store(dst, std::array{ vertex.texCoord.x, vertex.texCoord.y });
+		}
+	};
+
+	/// Texture coordinate mapped onto the mesh's UV range, so tiling coordinates outside [0, 1] survive.
+	struct TexCoordUnorm16
+	{
+		static constexpr Semantic semantic = Semantic::TexCoord;
+		static constexpr vk::Format format = vk::Format::eR16G16Unorm;
+		static constexpr uint32_t size = 4;
+		static constexpr bool quantized = true;
+
+		static void encode(const Vertex& vertex, const VertexQuantization& quantization, std::byte* dst)
+		{
+			glm::vec2 local = (vertex.texCoord - glm::vec2(quantization.texCoordOffsetScale.x, quantization.texCoordOffsetScale.y))
+				/ glm::vec2(quantization.texCoordOffsetScale.z, quantization.texCoordOffsetScale.w);
+			Detail::store(dst, std::array{ Detail::packUnorm16(local.x), Detail::packUnorm16(local.y) });
+		}
+	};
+}
+
+/// A GPU vertex layout assembled from VertexAttributes, interleaved in declaration order in binding 0.
+/// Stride, offsets and the Vulkan input descriptions are all computed at compile time.
+template <typename... Attributes>
+struct VertexLayout
+{
+	static constexpr uint32_t stride = (Attributes::size + ...);
+	static_assert(stride % 4 == 0, "Vertex layouts must keep 4-byte aligned strides");
+
+	/// One packed vertex; the layout owns the byte format, so this is just storage of the right size.
+	struct Data
+	{
+		alignas(4) std::byte bytes[stride];
+	};
+
+	template <typename Attribute>
+	static constexpr bool has = (std::is_same_v<Attribute, Attributes> || ...);
+
+	template <VertexAttributes::Semantic semantic>
+	static constexpr bool quantizes = ((Attributes::semantic == semantic && Attributes::quantized) || ...);
+
+	/// Lets the vertex shader pick the octahedral normal decode through a specialization constant.
+	static constexpr bool octahedralNormals = has<VertexAttributes::NormalOct16>;
+
+	template <typename Attribute>
+	static constexpr uint32_t offsetOf()
+	{
+		static_assert(has<Attribute>, "Attribute is not part of this layout");
+		uint32_t offset = 0;
+		bool found = false;
+		((found = found || std::is_same_v<Attribute, Attributes>, offset += found ? 0 : Attributes::size), ...);
+		return offset;
+	}
+
+	/// Identifies the byte format, so cached vertex data is only reused by the layout that wrote it.
+	static constexpr uint32_t layoutId()
+	{
+		uint32_t hash = 2166136261u;
+		auto mix = [&hash](uint32_t value) { hash = (hash ^ value) * 16777619u; };
+		(mix(static_cast<uint32_t>(Attributes::semantic)), ...);
+		(mix(static_cast<uint32_t>(Attributes::format)), ...);
+		return hash;
+	}
+
+	static constexpr vk::VertexInputBindingDescription getBindingDescription()
+	{
+		return { 0, stride, vk::VertexInputRate::eVertex };
+	}
+
+	static constexpr std::array<vk::VertexInputAttributeDescription, sizeof...(Attributes)> getAttributeDescriptions()
+	{
+		return { vk::VertexInputAttributeDescription(static_cast<uint32_t>(Attributes::semantic), 0, Attributes::format, offsetOf<Attributes>())... };
+	}
+
+	/// Bounds the quantized attributes of vertices; non-quantized attributes keep the identity mapping.
+	static VertexQuantization computeQuantization(std::span<const Vertex> vertices)
+	{
+		VertexQuantization quantization;
+		if (vertices.empty())
+		{
+			return quantization;
+		}
+
+		glm::vec3 positionMin(vertices[0].pos), positionMax(vertices[0].pos);
+		glm::vec2 texCoordMin(vertices[0].texCoord), texCoordMax(vertices[0].texCoord);
+		for (const Vertex& vertex : vertices)
+		{
+			positionMin = glm::min(positionMin, vertex.pos);
+			positionMax = glm::max(positionMax, vertex.pos);
+			texCoordMin = glm::min(texCoordMin, vertex.texCoord);
+			texCoordMax = glm::max(texCoordMax, vertex.texCoord);
+		}
+
+		// Flat axes keep a unit scale so the encoders never divide by zero
+		auto nonZero = [](float extent) { return extent > 0.0f ? extent : 1.0f; };
+
+		if constexpr (quantizes<VertexAttributes::Semantic::Position>)
+		{
+			glm::vec3 halfExtent = (positionMax - positionMin) * 0.5f;
+			quantization.positionOffset = glm::vec4((positionMin + positionMax) * 0.5f, 0.0f);
+			quantization.positionScale = glm::vec4(nonZero(halfExtent.x), nonZero(halfExtent.y), nonZero(halfExtent.z), 1.0f);
+		}
+		if constexpr (quantizes<VertexAttributes::Semantic::TexCoord>)
+		{
+			glm::vec2 extent = texCoordMax - texCoordMin;
+			quantization.texCoordOffsetScale = glm::vec4(texCoordMin, nonZero(extent.x), nonZero(extent.y));
+		}
+		return quantization;
+	}
+
+	static void pack(std::span<const Vertex> vertices, const VertexQuantization& quantization, Data* dst)
+	{
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			std::byte* out = dst[i].bytes;
+			((Attributes::encode(vertices[i], quantization, out), out += Attributes::size), ...);
+		}
+	}
+};
+
+namespace VertexLayouts
+{
+	/// 32 bytes: float position, normal and texture coordinate.
+	using Full = VertexLayout<VertexAttributes::PositionFloat3, VertexAttributes::NormalFloat3, VertexAttributes::TexCoordFloat2>;
+	/// 16 bytes: AABB-relative snorm16 position, octahedral normal, unorm16 texture coordinate.
+	using Packed = VertexLayout<VertexAttributes::PositionSnorm16, VertexAttributes::NormalOct16, VertexAttributes::TexCoordUnorm16>;
+	/// 16 bytes: as Packed, with half-precision positions.
+	using PackedHalf = VertexLayout<VertexAttributes::PositionHalf, VertexAttributes::NormalOct16, VertexAttributes::TexCoordUnorm16>;
+}
+
+// The layout every mesh is packed into before upload. Pick another one by defining
+// CAE_VERTEX_LAYOUT_FULL or CAE_VERTEX_LAYOUT_PACKED_HALF for the whole build.
+#if defined(CAE_VERTEX_LAYOUT_FULL)
+using GpuVertex = VertexLayouts::Full;
+#elif defined(CAE_VERTEX_LAYOUT_PACKED_HALF)
+using GpuVertex = VertexLayouts::PackedHalf;
+#else
+using GpuVertex = VertexLayouts::Packed;
+#endif
@@ -34,7 +34,8 @@ includedirs
 	{
 		"ImGui",
 		"GLFW",
-		"vulkan-1"
+		"vulkan-1",
+		"ktx"
 	}
 
 	-- Add Vulkan library directory